@@ -455,6 +455,26 @@ AC_DEFUN([OPAL_SETUP_CC],[
     AC_DEFINE_UNQUOTED([OPAL_C_HAVE_BUILTIN_CLZ], [$have_cc_builtin_clz],
         [Whether C compiler supports __builtin_clz])
 
+    # see if the C compiler can build functions for a given x86 instruction
+    # set (selected at runtime with __builtin_cpu_supports)
+    AC_CACHE_CHECK([if $CC supports the x86 target attribute],
+        [opal_cv_cc_supports_x86_target_attribute],
+        [AC_TRY_LINK([#include <immintrin.h>
+__attribute__((target("ssse3"))) static __m128i shuffle_ssse3(__m128i v, __m128i m) { return _mm_shuffle_epi8(v, m); }
+__attribute__((target("avx2"))) static __m256i shuffle_avx2(__m256i v, __m256i m) { return _mm256_shuffle_epi8(v, m); }],
+            [__builtin_cpu_init();
+             if (__builtin_cpu_supports("avx2")) (void) shuffle_avx2(_mm256_setzero_si256(), _mm256_setzero_si256());
+             if (__builtin_cpu_supports("ssse3")) (void) shuffle_ssse3(_mm_setzero_si128(), _mm_setzero_si128());],
+            [opal_cv_cc_supports_x86_target_attribute="yes"],
+            [opal_cv_cc_supports_x86_target_attribute="no"])])
+    if test "$opal_cv_cc_supports_x86_target_attribute" = "yes" ; then
+        have_cc_x86_target_attribute=1
+    else
+        have_cc_x86_target_attribute=0
+    fi
+    AC_DEFINE_UNQUOTED([OPAL_C_HAVE_X86_TARGET_ATTRIBUTE], [$have_cc_x86_target_attribute],
+        [Whether C compiler supports __attribute__((target)) with the x86 vector intrinsics])
+
     # Preload the optflags for the case where the user didn't specify
     # any.  If we're using GNU compilers, use -O3 (since it GNU
     # doesn't require all compilation units to be compiled with the
@@ -399,6 +399,15 @@ opal_pointer_array_t ompi_datatype_f_to_c_table = {{0}};
         /* transfer the ptypes */                                                    \
         (PDST)->super.ptypes = (PSRC)->super.ptypes;                                 \
         (PSRC)->super.ptypes = NULL;                                                 \
+        /* and the specialized kernel */                                             \
+        (PDST)->super.kernel = (PSRC)->super.kernel;                                 \
+        (PSRC)->super.kernel = NULL;                                                 \
+        (PDST)->super.iov_cache = (PSRC)->super.iov_cache;                           \
+        (PSRC)->super.iov_cache = NULL;                                              \
+        (PDST)->super.checkpoints = (PSRC)->super.checkpoints;                       \
+        (PSRC)->super.checkpoints = NULL;                                            \
+        (PDST)->super.shared = (PSRC)->super.shared;                                 \
+        (PSRC)->super.shared = NULL;                                                 \
     } while(0)
 
 #define DECLARE_MPI2_COMPOSED_STRUCT_DDT( PDATA, MPIDDT, MPIDDTNAME, type1, type2, MPIType1, MPIType2, FLAGS) \
@@ -89,6 +89,13 @@ struct ompi_osc_pt2pt_component_t {
 
     /** Is the progress function enabled? */
     bool progress_enable;
+
+    /** Synchronize fence with notifications to the peers instead of a reduce_scatter */
+    bool fence_notify;
+
+    /** Largest get or accumulate (in bytes) that may be combined with other
+     * operations to the same target. 0 disables aggregation. */
+    unsigned int aggregate_max_size;
 };
 typedef struct ompi_osc_pt2pt_component_t ompi_osc_pt2pt_component_t;
 
@@ -99,6 +106,8 @@ enum {
     OMPI_OSC_PT2PT_PEER_FLAG_EAGER = 2,
     /** peer has been locked (on-demand locking for lock_all) */
     OMPI_OSC_PT2PT_PEER_FLAG_LOCK = 4,
+    /** operations were started to the peer since the last flush_all (lock_all) */
+    OMPI_OSC_PT2PT_PEER_FLAG_DIRTY = 8,
 };
 
 
@@ -210,6 +219,13 @@ struct ompi_osc_pt2pt_module_t {
         peer.  Not in peer data to make fence more manageable. */
     opal_atomic_uint32_t *epoch_outgoing_frag_count;
 
+    /** targets with operations started since the last flush_all in a lock_all
+        epoch. protected by the module lock. */
+    int *dirty_targets;
+
+    /** number of entries in dirty_targets */
+    int dirty_count;
+
     /** cyclic counter for a unique tage for long messages. */
     opal_atomic_uint32_t tag_counter;
 
@@ -219,6 +235,9 @@ struct ompi_osc_pt2pt_module_t {
     /** number of incoming fragments */
     opal_atomic_int32_t active_incoming_frag_count;
 
+    /** number of fence notifications not acknowledged yet */
+    opal_atomic_int32_t fence_pending_acks;
+
     /** Number of targets locked/being locked */
     unsigned int passive_target_access_epoch;
 
@@ -431,6 +450,13 @@ void osc_pt2pt_incoming_post (ompi_osc_pt2pt_module_t *module, int source);
 /* received a complete message */
 void osc_pt2pt_incoming_complete (ompi_osc_pt2pt_module_t *module, int source, int frag_count);
 
+/* acknowledge a fence notification */
+int ompi_osc_pt2pt_process_fence (ompi_osc_pt2pt_module_t *module, int source,
+                                  ompi_osc_pt2pt_header_fence_t *fence_header);
+
+/* received a fence acknowledgement */
+void osc_pt2pt_incoming_fence_ack (ompi_osc_pt2pt_module_t *module, int source);
+
 int ompi_osc_pt2pt_start(struct ompi_group_t *group,
                         int assert,
                         struct ompi_win_t *win);
@@ -928,6 +954,34 @@ static inline ompi_osc_pt2pt_sync_t *ompi_osc_pt2pt_module_sync_lookup (ompi_osc
     return NULL;
 }
 
+/**
+ * @brief add a target to the dirty set of a lock_all epoch
+ *
+ * @param[in] module        osc pt2pt module
+ * @param[in] target        target rank
+ *
+ * Called once space for an operation has been reserved in a fragment to the target.
+ * flush_all and flush_local_all only visit the targets in the set.
+ */
+static inline void ompi_osc_pt2pt_mark_dirty (ompi_osc_pt2pt_module_t *module, int target)
+{
+    ompi_osc_pt2pt_peer_t *peer;
+
+    if (OMPI_OSC_PT2PT_SYNC_TYPE_LOCK != module->all_sync.type) {
+        return;
+    }
+
+    peer = ompi_osc_pt2pt_peer_lookup (module, target);
+    if (peer->flags & OMPI_OSC_PT2PT_PEER_FLAG_DIRTY ||
+        OPAL_THREAD_FETCH_OR32 (&peer->flags, OMPI_OSC_PT2PT_PEER_FLAG_DIRTY) & OMPI_OSC_PT2PT_PEER_FLAG_DIRTY) {
+        return;
+    }
+
+    OPAL_THREAD_LOCK(&module->lock);
+    module->dirty_targets[module->dirty_count++] = target;
+    OPAL_THREAD_UNLOCK(&module->lock);
+}
+
 /**
  * @brief check if an access epoch is active
  *
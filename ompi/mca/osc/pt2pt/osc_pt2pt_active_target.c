@@ -126,6 +126,72 @@ static void ompi_osc_pt2pt_release_peers (ompi_osc_pt2pt_peer_t **peers, int npe
     }
 }
 
+/**
+ * Send each peer this process sent fragments to during the epoch a fence
+ * message with the number of fragments and wait until every process has
+ * recorded the counts it was sent. This replaces a reduce_scatter over the
+ * whole window, whose cost grows with the communicator size, by messages
+ * to the peers actually touched and a barrier.
+ */
+static int ompi_osc_pt2pt_fence_notify (ompi_osc_pt2pt_module_t *module)
+{
+    int my_rank = ompi_comm_rank (module->comm);
+    int comm_size = ompi_comm_size (module->comm);
+    int ret = OMPI_SUCCESS;
+
+    for (int rank = 0 ; rank < comm_size ; ++rank) {
+        ompi_osc_pt2pt_header_fence_t fence_req;
+        uint32_t frag_count = module->epoch_outgoing_frag_count[rank];
+
+        if (0 == frag_count) {
+            continue;
+        }
+
+        if (my_rank == rank) {
+            OPAL_THREAD_ADD_FETCH32(&module->active_incoming_frag_count, -(int32_t) frag_count);
+            continue;
+        }
+
+        fence_req.base.type = OMPI_OSC_PT2PT_HDR_TYPE_FENCE;
+        fence_req.base.flags = OMPI_OSC_PT2PT_HDR_FLAG_VALID;
+        /* all fragments were flushed so the fence message goes in a fragment of its own. it
+         * is counted when sent but the target accounts for it on receipt */
+        fence_req.frag_count = frag_count;
+#if OPAL_ENABLE_HETEROGENEOUS_SUPPORT
+#if OPAL_ENABLE_DEBUG
+        fence_req.padding[0] = 0;
+        fence_req.padding[1] = 0;
+#endif
+        osc_pt2pt_hton(&fence_req, ompi_comm_peer_lookup (module->comm, rank));
+#endif
+
+        OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
+                             "osc pt2pt: fence notifying %d. frag_count: %u", rank, frag_count));
+
+        (void) OPAL_THREAD_ADD_FETCH32(&module->fence_pending_acks, 1);
+
+        ret = ompi_osc_pt2pt_control_send (module, rank, &fence_req, sizeof (fence_req));
+        if (OMPI_SUCCESS != ret) {
+            return ret;
+        }
+
+        ret = ompi_osc_pt2pt_frag_flush_target (module, rank);
+        if (OMPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    /* the targets have recorded the counts once they acknowledged them */
+    OPAL_THREAD_LOCK(&module->lock);
+    while (module->fence_pending_acks) {
+        opal_condition_wait(&module->cond, &module->lock);
+    }
+    OPAL_THREAD_UNLOCK(&module->lock);
+
+    /* and every process knows all it is going to receive after the barrier */
+    return module->comm->c_coll->coll_barrier (module->comm, module->comm->c_coll->coll_barrier_module);
+}
+
 int ompi_osc_pt2pt_fence(int assert, ompi_win_t *win)
 {
     ompi_osc_pt2pt_module_t *module = GET_MODULE(win);
@@ -165,11 +231,17 @@ int ompi_osc_pt2pt_fence(int assert, ompi_win_t *win)
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
                          "osc pt2pt: fence done sending"));
 
-    /* find out how much data everyone is going to send us.  */
-    ret = module->comm->c_coll->coll_reduce_scatter_block ((void *) module->epoch_outgoing_frag_count,
-                                                           &incoming_reqs, 1, MPI_UINT32_T,
-                                                           MPI_SUM, module->comm,
-                                                           module->comm->c_coll->coll_reduce_scatter_block_module);
+    if (mca_osc_pt2pt_component.fence_notify) {
+        /* tell the peers we sent fragments to how many to expect. everyone else expects nothing */
+        ret = ompi_osc_pt2pt_fence_notify (module);
+        incoming_reqs = 0;
+    } else {
+        /* find out how much data everyone is going to send us.  */
+        ret = module->comm->c_coll->coll_reduce_scatter_block ((void *) module->epoch_outgoing_frag_count,
+                                                               &incoming_reqs, 1, MPI_UINT32_T,
+                                                               MPI_SUM, module->comm,
+                                                               module->comm->c_coll->coll_reduce_scatter_block_module);
+    }
     if (OMPI_SUCCESS != ret) {
         return ret;
     }
@@ -588,6 +660,34 @@ void osc_pt2pt_incoming_complete (ompi_osc_pt2pt_module_t *module, int source, i
     }
 }
 
+int ompi_osc_pt2pt_process_fence (ompi_osc_pt2pt_module_t *module, int source,
+                                  ompi_osc_pt2pt_header_fence_t *fence_header)
+{
+    ompi_osc_pt2pt_header_fence_ack_t fence_ack;
+
+    OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
+                         "osc pt2pt: acknowledging fence message from %d", source));
+
+    fence_ack.base.type = OMPI_OSC_PT2PT_HDR_TYPE_FENCE_ACK;
+    fence_ack.base.flags = OMPI_OSC_PT2PT_HDR_FLAG_VALID;
+    OSC_PT2PT_HTON(&fence_ack, module, source);
+
+    return ompi_osc_pt2pt_control_send_unbuffered (module, source, &fence_ack, sizeof (fence_ack));
+}
+
+void osc_pt2pt_incoming_fence_ack (ompi_osc_pt2pt_module_t *module, int source)
+{
+    OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
+                         "osc pt2pt: received fence acknowledgement from %d. pending: %d", source,
+                         module->fence_pending_acks));
+
+    if (0 == OPAL_THREAD_ADD_FETCH32(&module->fence_pending_acks, -1)) {
+        OPAL_THREAD_LOCK(&module->lock);
+        opal_condition_broadcast (&module->cond);
+        OPAL_THREAD_UNLOCK(&module->lock);
+    }
+}
+
 void osc_pt2pt_incoming_post (ompi_osc_pt2pt_module_t *module, int source)
 {
     ompi_osc_pt2pt_sync_t *sync = &module->all_sync;
@@ -428,6 +428,22 @@ ompi_osc_pt2pt_put(const void *origin_addr, int origin_count,
 }
 
 
+/* operations of at most aggregate_max_size bytes may be combined with other operations
+ * to the same target. aggregated headers are never byte swapped so peers with a
+ * different architecture are excluded. */
+static inline bool ompi_osc_pt2pt_aggregate_ok (ompi_osc_pt2pt_module_t *module, int target, size_t len)
+{
+    if (len > mca_osc_pt2pt_component.aggregate_max_size) {
+        return false;
+    }
+
+#if OPAL_ENABLE_HETEROGENEOUS_SUPPORT
+    return ompi_comm_peer_lookup (module->comm, target)->super.proc_arch == ompi_proc_local ()->super.proc_arch;
+#else
+    return true;
+#endif
+}
+
 static int
 ompi_osc_pt2pt_accumulate_w_req (const void *origin_addr, int origin_count,
                                 struct ompi_datatype_t *origin_dt,
@@ -478,10 +494,29 @@ ompi_osc_pt2pt_accumulate_w_req (const void *origin_addr, int origin_count,
                                         op, module, request);
     }
 
+    payload_len = origin_dt->super.size * origin_count;
+
+    if (origin_dt == target_dt && origin_count == target_count && payload_len &&
+        ompi_datatype_is_predefined (target_dt) && ompi_op_is_intrinsic (op) &&
+        ompi_osc_pt2pt_aggregate_ok (module, target, payload_len)) {
+        /* small accumulates with the same predefined datatype and operation are
+         * merged into a single accumulate vector at the target */
+        ret = ompi_osc_pt2pt_frag_alloc_acc_seg (module, target, target_dt, op, target_disp,
+                                                 target_count, &frag, &ptr);
+        if (OPAL_LIKELY(OMPI_SUCCESS == ret)) {
+            osc_pt2pt_copy_for_send (ptr, payload_len, origin_addr, proc, origin_count, origin_dt);
+
+            if (request) {
+                ompi_osc_pt2pt_request_complete (request, MPI_SUCCESS);
+            }
+
+            return ompi_osc_pt2pt_frag_finish (module, frag);
+        }
+    }
+
     /* Compute datatype and payload lengths.  Note that the datatype description
      * must fit in a single frag */
     ddt_len = ompi_datatype_pack_description_length(target_dt);
-    payload_len = origin_dt->super.size * origin_count;
 
     frag_len = sizeof(*header) + ddt_len + payload_len;
     ret = ompi_osc_pt2pt_frag_alloc(module, target, frag_len, &frag, &ptr, false, true);
@@ -743,6 +778,130 @@ int ompi_osc_pt2pt_rput(const void *origin_addr, int origin_count,
     return OMPI_SUCCESS;
 }
 
+/* find the get batch of a fragment and make room for one more get. the module
+ * lock must be held. */
+static ompi_osc_pt2pt_get_batch_t *ompi_osc_pt2pt_get_batch_reserve (ompi_osc_pt2pt_module_t *module,
+                                                                     ompi_osc_pt2pt_frag_t *frag)
+{
+    ompi_osc_pt2pt_get_batch_t *batch = frag->get_batch;
+
+    if (NULL == batch) {
+        batch = calloc (1, sizeof (*batch));
+        if (OPAL_UNLIKELY(NULL == batch)) {
+            return NULL;
+        }
+
+        batch->module = module;
+    }
+
+    if (batch->count == batch->size) {
+        int size = batch->size ? 2 * batch->size : 16;
+        void *tmp = realloc (batch->gets, size * sizeof (batch->gets[0]));
+        if (OPAL_UNLIKELY(NULL == tmp)) {
+            if (NULL == frag->get_batch) {
+                free (batch);
+            }
+            return NULL;
+        }
+
+        batch->gets = (ompi_osc_pt2pt_batch_get_t *) tmp;
+        batch->size = size;
+    }
+
+    if (NULL == frag->get_batch) {
+        batch->tag = get_tag (module);
+        frag->get_batch = batch;
+
+        /* for bookkeeping the reply is "outgoing" */
+        ompi_osc_signal_outgoing (module, frag->target, 1);
+    }
+
+    return batch;
+}
+
+/**
+ * @brief Start a short contiguous get
+ *
+ * The get is added to the batch of the active fragment to the target. The target
+ * answers every get in the batch with a single message which is scattered into
+ * the origin buffers when it arrives. If a request is given it is completed as
+ * soon as its data has been scattered and the fragment is started immediately
+ * so the request does not depend on a later flush.
+ */
+static int ompi_osc_pt2pt_get_short (void *origin_addr, int origin_count, struct ompi_datatype_t *origin_dt,
+                                     int target, ptrdiff_t target_disp, struct ompi_datatype_t *target_dt,
+                                     size_t len, ompi_osc_pt2pt_module_t *module,
+                                     ompi_osc_pt2pt_request_t *request)
+{
+    ompi_osc_pt2pt_header_get_short_t *header;
+    ompi_osc_pt2pt_get_batch_t *batch;
+    ompi_osc_pt2pt_batch_get_t *get;
+    ptrdiff_t true_lb, true_extent;
+    ompi_osc_pt2pt_frag_t *frag, *curr;
+    bool detached = false;
+    char *ptr;
+    int ret;
+
+    ret = ompi_osc_pt2pt_frag_alloc (module, target, sizeof (*header), &frag, &ptr, false, true);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+        return ret;
+    }
+
+    (void) ompi_datatype_get_true_extent (target_dt, &true_lb, &true_extent);
+
+    header = (ompi_osc_pt2pt_header_get_short_t *) ptr;
+    header->base.type = OMPI_OSC_PT2PT_HDR_TYPE_GET_SHORT;
+    header->base.flags = OMPI_OSC_PT2PT_HDR_FLAG_VALID;
+    header->displacement = target_disp;
+    header->offset = true_lb;
+
+    OPAL_THREAD_LOCK(&module->lock);
+    batch = ompi_osc_pt2pt_get_batch_reserve (module, frag);
+    if (OPAL_LIKELY(NULL != batch)) {
+        get = batch->gets + batch->count++;
+        get->origin_addr = origin_addr;
+        get->origin_count = origin_count;
+        get->origin_dt = origin_dt;
+        OMPI_DATATYPE_RETAIN(origin_dt);
+        get->offset = batch->len;
+        get->len = len;
+        get->request = request;
+        get->header = header;
+
+        header->tag = batch->tag;
+        header->len = len;
+        header->reply_offset = batch->len;
+        batch->len += len;
+
+        if (NULL != request) {
+            /* take the fragment off the peer. if another thread got there first that
+             * thread will start it. */
+            curr = frag;
+            detached = opal_atomic_compare_exchange_strong_ptr (&ompi_osc_pt2pt_peer_lookup (module, target)->active_frag,
+                                                                (intptr_t *) &curr, 0);
+        }
+    } else {
+        /* the target skips zero length gets */
+        header->tag = 0;
+        header->len = 0;
+        header->reply_offset = 0;
+        ret = OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    OPAL_THREAD_UNLOCK(&module->lock);
+
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+        (void) ompi_osc_pt2pt_frag_finish (module, frag);
+        return ret;
+    }
+
+    ret = ompi_osc_pt2pt_frag_finish (module, frag);
+    if (detached && OMPI_SUCCESS == ret) {
+        ret = ompi_osc_pt2pt_frag_finish (module, frag);
+    }
+
+    return ret;
+}
+
 static inline int ompi_osc_pt2pt_rget_internal (void *origin_addr, int origin_count,
                                                struct ompi_datatype_t *origin_dt,
                                                int target,
@@ -774,6 +933,35 @@ static inline int ompi_osc_pt2pt_rget_internal (void *origin_addr, int origin_co
         return OMPI_ERR_RMA_SYNC;
     }
 
+    if (ompi_comm_rank (module->comm) != target) {
+        size_t len = target_dt->super.size * target_count;
+
+        /* short contiguous gets are answered with one reply per fragment */
+        if (len && origin_count && ompi_osc_pt2pt_aggregate_ok (module, target, len) &&
+            ompi_datatype_is_contiguous_memory_layout (target_dt, target_count)) {
+            if (release_req) {
+                return ompi_osc_pt2pt_get_short (origin_addr, origin_count, origin_dt, target, target_disp,
+                                                 target_dt, len, module, NULL);
+            }
+
+            OMPI_OSC_PT2PT_REQUEST_ALLOC(win, pt2pt_request);
+            pt2pt_request->type = OMPI_OSC_PT2PT_HDR_TYPE_GET;
+
+            /* wait for epoch to begin before starting rget operation */
+            ompi_osc_pt2pt_sync_wait_expected (pt2pt_sync);
+
+            ret = ompi_osc_pt2pt_get_short (origin_addr, origin_count, origin_dt, target, target_disp,
+                                            target_dt, len, module, pt2pt_request);
+            if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+                OMPI_OSC_PT2PT_REQUEST_RETURN(pt2pt_request);
+                return ret;
+            }
+
+            *request = &pt2pt_request->super;
+            return OMPI_SUCCESS;
+        }
+    }
+
     /* gets are always request based, so that we know where to land the data */
     OMPI_OSC_PT2PT_REQUEST_ALLOC(win, pt2pt_request);
 
@@ -122,6 +122,15 @@ static bool check_config_value_bool(char *key, opal_info_t *info, bool result)
     return result;
 }
 
+static bool check_config_value_equal (char *key, opal_info_t *info, char *value)
+{
+    char value_string[MPI_MAX_INFO_VAL + 1];
+    int flag = 0;
+
+    (void) opal_info_get (info, key, MPI_MAX_INFO_VAL, value_string, &flag);
+    return flag && 0 == strcmp (value_string, value);
+}
+
 static int component_register (void)
 {
     ompi_osc_pt2pt_no_locks = false;
@@ -148,6 +157,22 @@ static int component_register (void)
                                             "(default: 4)", MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0, OPAL_INFO_LVL_4,
                                             MCA_BASE_VAR_SCOPE_READONLY, &mca_osc_pt2pt_component.receive_count);
 
+    mca_osc_pt2pt_component.fence_notify = true;
+    (void) mca_base_component_var_register (&mca_osc_pt2pt_component.super.osc_version, "fence_notify",
+                                            "Complete MPI_Win_fence by notifying the peers a process sent fragments "
+                                            "to followed by a barrier instead of a reduce_scatter over the window. "
+                                            "Must be the same on all processes (default: true)",
+                                            MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_4,
+                                            MCA_BASE_VAR_SCOPE_ALL_EQ, &mca_osc_pt2pt_component.fence_notify);
+
+    mca_osc_pt2pt_component.aggregate_max_size = 256;
+    (void) mca_base_component_var_register (&mca_osc_pt2pt_component.super.osc_version, "aggregate_max_size",
+                                            "Gets and accumulates of at most this many bytes to the same target are "
+                                            "combined into a single reply or a single accumulate vector. 0 disables "
+                                            "aggregation (default: 256)", MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0,
+                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_READONLY,
+                                            &mca_osc_pt2pt_component.aggregate_max_size);
+
     return OMPI_SUCCESS;
 }
 
@@ -187,6 +212,10 @@ static int component_progress (void)
                 ret = ompi_osc_pt2pt_process_unlock (pending->module, pending->source,
                                                      &pending->header.unlock);
                 break;
+            case OMPI_OSC_PT2PT_HDR_TYPE_FENCE:
+                ret = ompi_osc_pt2pt_process_fence (pending->module, pending->source,
+                                                    &pending->header.fence);
+                break;
             default:
                 /* shouldn't happen */
                 assert (0);
@@ -354,12 +383,7 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
     }
 
     /* options */
-    /* FIX ME: should actually check this value... */
-#if 1
-    module->accumulate_ordering = 1;
-#else
-    ompi_osc_base_config_value_equal("accumulate_ordering", info, "none");
-#endif
+    module->accumulate_ordering = !check_config_value_equal ("accumulate_ordering", info, "none");
 
     /* fill in our part */
     if (MPI_WIN_FLAVOR_ALLOCATE == flavor && size) {
@@ -392,6 +416,12 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
         goto cleanup;
     }
 
+    module->dirty_targets = malloc (ompi_comm_size(comm) * sizeof (module->dirty_targets[0]));
+    if (NULL == module->dirty_targets) {
+        ret = OMPI_ERR_TEMP_OUT_OF_RESOURCE;
+        goto cleanup;
+    }
+
     /* the statement below (from Brian) does not seem correct so disable active target on the
      * window. if this end up being incorrect please revert this one change */
 #if 0
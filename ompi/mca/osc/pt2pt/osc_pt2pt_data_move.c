@@ -215,7 +215,7 @@ int ompi_osc_pt2pt_control_send (ompi_osc_pt2pt_module_t *module, int target,
     char *ptr;
     int ret;
 
-    ret = ompi_osc_pt2pt_frag_alloc(module, target, len, &frag, &ptr, false, true);
+    ret = ompi_osc_pt2pt_frag_alloc_control (module, target, len, &frag, &ptr, false, true);
     if (OPAL_LIKELY(OMPI_SUCCESS == ret)) {
         memcpy (ptr, data, len);
 
@@ -443,6 +443,7 @@ static int osc_pt2pt_incoming_req_complete (ompi_request_t *request)
 struct osc_pt2pt_get_post_send_cb_data_t {
     ompi_osc_pt2pt_module_t *module;
     int peer;
+    void *buffer;
 };
 
 static int osc_pt2pt_get_post_send_cb (ompi_request_t *request)
@@ -452,6 +453,7 @@ static int osc_pt2pt_get_post_send_cb (ompi_request_t *request)
     ompi_osc_pt2pt_module_t *module = data->module;
     int rank = data->peer;
 
+    free (data->buffer);
     free (data);
 
     /* mark this as a completed "incoming" request */
@@ -470,13 +472,14 @@ static int osc_pt2pt_get_post_send_cb (ompi_request_t *request)
  * @param[in] datatype - Type of source elements.
  * @param[in] peer     - Remote process that has the receive posted
  * @param[in] tag      - Tag for the send
+ * @param[in] buffer   - Buffer to free when the send completes (may be NULL)
  *
  *  This function posts a send to match the receive posted as part
  *       of a get operation. When this send is complete the get is considered
  *       complete at the target (this process).
  */
 static int osc_pt2pt_get_post_send (ompi_osc_pt2pt_module_t *module, void *source, int count,
-                                   ompi_datatype_t *datatype, int peer, int tag)
+                                   ompi_datatype_t *datatype, int peer, int tag, void *buffer)
 {
     struct osc_pt2pt_get_post_send_cb_data_t *data;
     int ret;
@@ -490,6 +493,7 @@ static int osc_pt2pt_get_post_send (ompi_osc_pt2pt_module_t *module, void *sourc
     /* for incoming completion we need to know the peer (MPI_PROC_NULL if this is
      * in an active target epoch) */
     data->peer = (tag & 0x1) ? peer : MPI_PROC_NULL;
+    data->buffer = buffer;
 
     /* data will be freed by the callback */
     ret = ompi_osc_pt2pt_isend_w_cb (source, count, datatype, peer, tag, module->comm,
@@ -531,13 +535,73 @@ static inline int process_get (ompi_osc_pt2pt_module_t* module, int target,
 
     /* send get data */
     ret = osc_pt2pt_get_post_send (module, source, get_header->count, datatype,
-                                  target, tag_to_origin(get_header->tag));
+                                  target, tag_to_origin(get_header->tag), NULL);
 
     OMPI_DATATYPE_RELEASE(datatype);
 
     return OMPI_SUCCESS == ret ? (int) get_header->len : ret;
 }
 
+/** Reply to the short gets in a fragment */
+struct osc_pt2pt_get_reply_t {
+    char *buffer;
+    uint32_t len;
+    uint32_t size;
+    int tag;
+};
+typedef struct osc_pt2pt_get_reply_t osc_pt2pt_get_reply_t;
+
+/**
+ * process_get_short:
+ *
+ * @brief Copy the data for a short get into the fragment's reply
+ *
+ * @param[in] module     - OSC PT2PT module
+ * @param[in] get_header - Incoming message header
+ * @param[in] reply      - Reply to the short gets in the fragment
+ *
+ * The reply is sent to the origin once the whole fragment has been processed.
+ */
+static inline int process_get_short (ompi_osc_pt2pt_module_t *module,
+                                     ompi_osc_pt2pt_header_get_short_t *get_header,
+                                     osc_pt2pt_get_reply_t *reply)
+{
+    uint32_t reply_len = get_header->reply_offset + get_header->len;
+    void *source = (unsigned char*) module->baseptr +
+        ((unsigned long) get_header->displacement * module->disp_unit) + get_header->offset;
+
+    if (0 == get_header->len) {
+        /* the origin could not add this get to its batch */
+        return sizeof (*get_header);
+    }
+
+    if (reply_len > reply->size) {
+        uint32_t size = reply->size ? reply->size : 256;
+        void *tmp;
+
+        while (size < reply_len) {
+            size <<= 1;
+        }
+
+        tmp = realloc (reply->buffer, size);
+        if (OPAL_UNLIKELY(NULL == tmp)) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+
+        reply->buffer = (char *) tmp;
+        reply->size = size;
+    }
+
+    memcpy (reply->buffer + get_header->reply_offset, source, get_header->len);
+
+    if (reply_len > reply->len) {
+        reply->len = reply_len;
+    }
+    reply->tag = get_header->tag;
+
+    return sizeof (*get_header);
+}
+
 /**
  * osc_pt2pt_accumulate_buffer:
  *
@@ -1180,6 +1244,81 @@ static inline int process_acc (ompi_osc_pt2pt_module_t *module, int source,
     return (OMPI_SUCCESS == ret) ? (int) acc_header->len : ret;
 }
 
+static inline size_t osc_pt2pt_acc_seg_len (ompi_osc_pt2pt_header_acc_seg_t *seg, ompi_datatype_t **datatype)
+{
+    *datatype = (ompi_datatype_t *) opal_pointer_array_get_item (&ompi_datatype_f_to_c_table, seg->datatype);
+    return (*datatype)->super.size * seg->count;
+}
+
+/**
+ * process_acc_vec:
+ *
+ * @brief Apply every segment of an accumulate vector
+ *
+ * @param[in] module - OSC PT2PT module
+ * @param[in] source - Source rank
+ * @param[in] frag   - Fragment containing the vector
+ * @param[in] seg    - First segment of the vector
+ *
+ * The accumulate lock is taken once for the whole vector. If it is not available
+ * each segment is queued as a separate accumulate.
+ */
+static inline int process_acc_vec (ompi_osc_pt2pt_module_t *module, int source,
+                                   ompi_osc_pt2pt_frag_header_t *frag,
+                                   ompi_osc_pt2pt_header_acc_seg_t *seg)
+{
+    bool active_target = !(frag->base.flags & OMPI_OSC_PT2PT_HDR_FLAG_PASSIVE_TARGET);
+    ompi_proc_t *proc = ompi_comm_peer_lookup (module->comm, source);
+    struct ompi_op_t *op = ompi_osc_base_op_create (seg->op);
+    ompi_osc_pt2pt_header_acc_seg_t *curr = seg;
+    ompi_datatype_t *datatype;
+    size_t seg_len, data_len;
+    int ret = OMPI_SUCCESS;
+    bool locked;
+
+    OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
+                         "%d: process_acc_vec: received message from %d",
+                         ompi_comm_rank(module->comm), source));
+
+    seg_len = osc_pt2pt_acc_seg_len (seg, &datatype);
+
+    locked = (0 == ompi_osc_pt2pt_accumulate_trylock (module));
+
+    do {
+        data_len = datatype->super.size * curr->count;
+
+        if (locked) {
+            void *target = (unsigned char*) module->baseptr +
+                ((unsigned long) curr->displacement * module->disp_unit);
+
+            ret = osc_pt2pt_accumulate_buffer (target, (void *) (curr + 1), data_len, proc, curr->count,
+                                               datatype, op);
+        } else {
+            /* couldn't aquire the accumulate lock so queue up the segment as a regular accumulate */
+            ompi_osc_pt2pt_header_acc_t acc_header = {.base = {.type = OMPI_OSC_PT2PT_HDR_TYPE_ACC},
+                                                      .tag = !active_target, .count = curr->count,
+                                                      .len = sizeof (*curr) + data_len,
+                                                      .displacement = curr->displacement,
+                                                      .op = curr->op};
+
+            ret = ompi_osc_pt2pt_acc_op_queue (module, (ompi_osc_pt2pt_header_t *) &acc_header, source,
+                                               (char *) (curr + 1), data_len, datatype, active_target);
+        }
+
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != ret) || 0 == curr->next) {
+            break;
+        }
+
+        curr = (ompi_osc_pt2pt_header_acc_seg_t *) ((uintptr_t) frag + curr->next);
+    } while (1);
+
+    if (locked) {
+        ompi_osc_pt2pt_accumulate_unlock (module);
+    }
+
+    return (OMPI_SUCCESS == ret) ? (int) (sizeof (*seg) + seg_len) : ret;
+}
+
 static inline int process_acc_long (ompi_osc_pt2pt_module_t* module, int source,
                                     ompi_osc_pt2pt_header_acc_t* acc_header)
 {
@@ -1340,6 +1479,35 @@ static inline int process_complete (ompi_osc_pt2pt_module_t *module, int source,
     return sizeof (*complete_header);
 }
 
+/* the acknowledgement of a fence notification is sent from the pt2pt
+ * component's progress function if it can not be sent right away */
+static inline int process_fence (ompi_osc_pt2pt_module_t *module, int source,
+                                 ompi_osc_pt2pt_header_fence_t *fence_header)
+{
+    int ret;
+
+    OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
+                         "process_fence header = {.frag_count = %d}", fence_header->frag_count));
+
+    /* the current fragment is not part of the frag_count so we need to add it here. the
+     * count must be set before the acknowledgement lets the source leave the fence */
+    OPAL_THREAD_ADD_FETCH32(&module->active_incoming_frag_count, -(int32_t) (fence_header->frag_count + 1));
+
+    ret = ompi_osc_pt2pt_process_fence (module, source, fence_header);
+    if (OMPI_SUCCESS != ret) {
+        ompi_osc_pt2pt_pending_t *pending;
+
+        pending = OBJ_NEW(ompi_osc_pt2pt_pending_t);
+        pending->module = module;
+        pending->source = source;
+        pending->header.fence = *fence_header;
+
+        osc_pt2pt_add_pending (pending);
+    }
+
+    return sizeof (*fence_header);
+}
+
 /* flush and unlock headers cannot be processed from the request callback
  * because some btls do not provide re-entrant progress functions. these
  * fragment will be progressed by the pt2pt component's progress function */
@@ -1528,6 +1696,8 @@ static inline int process_frag (ompi_osc_pt2pt_module_t *module,
                                 ompi_osc_pt2pt_frag_header_t *frag)
 {
     ompi_osc_pt2pt_header_t *header;
+    osc_pt2pt_get_reply_t reply;
+    ompi_datatype_t *datatype;
     int ret;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
@@ -1535,6 +1705,9 @@ static inline int process_frag (ompi_osc_pt2pt_module_t *module,
                          (int) frag->source, (int) frag->num_ops));
 
     header = (ompi_osc_pt2pt_header_t *) (frag + 1);
+    reply.buffer = NULL;
+    reply.len = reply.size = 0;
+    reply.tag = 0;
 
     for (int i = 0 ; i < frag->num_ops ; ++i) {
         OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
@@ -1567,6 +1740,18 @@ static inline int process_frag (ompi_osc_pt2pt_module_t *module,
                 ret = process_get (module, frag->source, &header->get);
                 break;
 
+            case OMPI_OSC_PT2PT_HDR_TYPE_GET_SHORT:
+                ret = process_get_short (module, &header->get_short, &reply);
+                break;
+
+            case OMPI_OSC_PT2PT_HDR_TYPE_ACC_VEC:
+                ret = process_acc_vec (module, frag->source, frag, &header->acc_seg);
+                break;
+            case OMPI_OSC_PT2PT_HDR_TYPE_ACC_SEG:
+                /* applied with the first segment of the vector */
+                ret = (int) (sizeof (header->acc_seg) + osc_pt2pt_acc_seg_len (&header->acc_seg, &datatype));
+                break;
+
             case OMPI_OSC_PT2PT_HDR_TYPE_CSWAP:
                 ret = process_cswap (module, frag->source, &header->cswap);
                 break;
@@ -1587,6 +1772,10 @@ static inline int process_frag (ompi_osc_pt2pt_module_t *module,
                 ret = process_complete (module, frag->source, &header->complete);
                 break;
 
+            case OMPI_OSC_PT2PT_HDR_TYPE_FENCE:
+                ret = process_fence (module, frag->source, &header->fence);
+                break;
+
             default:
                 opal_output(0, "Unsupported fragment type 0x%x\n", header->base.type);
                 abort(); /* FIX ME */
@@ -1605,6 +1794,19 @@ static inline int process_frag (ompi_osc_pt2pt_module_t *module,
         header = (ompi_osc_pt2pt_header_t *) OPAL_ALIGN(((uintptr_t) header + ret), 8, uintptr_t);
     }
 
+    if (reply.len) {
+        /* answer all short gets in the fragment at once. the buffer is freed when
+         * the send completes. */
+        ret = osc_pt2pt_get_post_send (module, reply.buffer, reply.len, MPI_BYTE, frag->source,
+                                       tag_to_origin (reply.tag), reply.buffer);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+            free (reply.buffer);
+            return ret;
+        }
+    } else {
+        free (reply.buffer);
+    }
+
     return OMPI_SUCCESS;
 }
 
@@ -1675,6 +1877,9 @@ int ompi_osc_pt2pt_process_receive (ompi_osc_pt2pt_receive_t *recv)
     case OMPI_OSC_PT2PT_HDR_TYPE_UNLOCK_ACK:
         ompi_osc_pt2pt_process_unlock_ack (module, source, (ompi_osc_pt2pt_header_unlock_ack_t *) base_header);
         break;
+    case OMPI_OSC_PT2PT_HDR_TYPE_FENCE_ACK:
+        osc_pt2pt_incoming_fence_ack (module, source);
+        break;
     default:
         OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
                              "received unexpected message of type %x",
@@ -43,9 +43,69 @@ static int frag_send_cb (ompi_request_t *request)
     return 1;
 }
 
+static int get_batch_complete (ompi_request_t *request)
+{
+    ompi_osc_pt2pt_get_batch_t *batch = (ompi_osc_pt2pt_get_batch_t *) request->req_complete_cb_data;
+    ompi_osc_pt2pt_module_t *module = batch->module;
+    ompi_proc_t *proc = ompi_comm_peer_lookup (module->comm, request->req_status.MPI_SOURCE);
+
+    OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
+                         "osc pt2pt: get batch of %d operations (%u bytes) complete",
+                         batch->count, (unsigned) batch->len));
+
+    for (int i = 0 ; i < batch->count ; ++i) {
+        ompi_osc_pt2pt_batch_get_t *get = batch->gets + i;
+
+        osc_pt2pt_copy_on_recv (get->origin_addr, batch->buffer + get->offset, get->len, proc,
+                                get->origin_count, get->origin_dt);
+        OMPI_DATATYPE_RELEASE(get->origin_dt);
+
+        if (NULL != get->request) {
+            ompi_osc_pt2pt_request_complete (get->request, MPI_SUCCESS);
+        }
+    }
+
+    free (batch->buffer);
+    free (batch->gets);
+    free (batch);
+
+    mark_outgoing_completion (module);
+
+    ompi_request_free (&request);
+
+    return 1;
+}
+
+/* the reply to a get batch can not be received. complete the gets with an error
+ * so neither their requests nor a flush wait for the reply, and turn them into
+ * zero length gets, which the target skips without replying. must be called
+ * before the fragment is sent. */
+static void get_batch_abort (ompi_osc_pt2pt_get_batch_t *batch, int ret)
+{
+    ompi_osc_pt2pt_module_t *module = batch->module;
+
+    for (int i = 0 ; i < batch->count ; ++i) {
+        ompi_osc_pt2pt_batch_get_t *get = batch->gets + i;
+
+        get->header->len = 0;
+        OMPI_DATATYPE_RELEASE(get->origin_dt);
+
+        if (NULL != get->request) {
+            ompi_osc_pt2pt_request_complete (get->request, ret);
+        }
+    }
+
+    free (batch->buffer);
+    free (batch->gets);
+    free (batch);
+
+    mark_outgoing_completion (module);
+}
+
 static int frag_send (ompi_osc_pt2pt_module_t *module, ompi_osc_pt2pt_frag_t *frag)
 {
-    int count;
+    ompi_osc_pt2pt_get_batch_t *batch = frag->get_batch;
+    int count, ret, batch_ret = OMPI_SUCCESS;
 
     count = (int)((uintptr_t) frag->top - (uintptr_t) frag->buffer);
 
@@ -53,9 +113,32 @@ static int frag_send (ompi_osc_pt2pt_module_t *module, ompi_osc_pt2pt_frag_t *fr
                          "osc pt2pt: frag_send called to %d, frag = %p, count = %d",
                          frag->target, (void *) frag, count));
 
+    if (NULL != batch) {
+        /* post the receive for the reply to the short gets in this fragment */
+        frag->get_batch = NULL;
+
+        batch->buffer = malloc (batch->len);
+        if (OPAL_UNLIKELY(NULL == batch->buffer)) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+        } else {
+            ret = ompi_osc_pt2pt_irecv_w_cb (batch->buffer, batch->len, MPI_BYTE, frag->target,
+                                             tag_to_origin (batch->tag), module->comm, NULL,
+                                             get_batch_complete, batch);
+        }
+
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+            /* still send the fragment: the target expects it and the other
+             * operations in it are unaffected */
+            get_batch_abort (batch, ret);
+            batch_ret = ret;
+        }
+    }
+
     OSC_PT2PT_HTON(frag->header, module, frag->target);
-    return ompi_osc_pt2pt_isend_w_cb (frag->buffer, count, MPI_BYTE, frag->target, OSC_PT2PT_FRAG_TAG,
-                                     module->comm, frag_send_cb, frag);
+    ret = ompi_osc_pt2pt_isend_w_cb (frag->buffer, count, MPI_BYTE, frag->target, OSC_PT2PT_FRAG_TAG,
+                                    module->comm, frag_send_cb, frag);
+
+    return OMPI_SUCCESS == ret ? batch_ret : ret;
 }
 
 
@@ -16,11 +16,43 @@
 #define OSC_PT2PT_FRAG_H
 
 #include "ompi/communicator/communicator.h"
+#include "ompi/op/op.h"
 
 #include "osc_pt2pt_header.h"
 #include "osc_pt2pt_request.h"
 #include "opal/align.h"
 
+/** Short get whose data arrives as part of a batch reply */
+struct ompi_osc_pt2pt_batch_get_t {
+    void *origin_addr;
+    int origin_count;
+    struct ompi_datatype_t *origin_dt;
+    /* offset of this get's data in the reply */
+    uint32_t offset;
+    uint32_t len;
+    /* request to complete when the data arrives (NULL for MPI_Get) */
+    ompi_osc_pt2pt_request_t *request;
+    /* header of the get in the fragment, valid until the fragment is sent */
+    ompi_osc_pt2pt_header_get_short_t *header;
+};
+typedef struct ompi_osc_pt2pt_batch_get_t ompi_osc_pt2pt_batch_get_t;
+
+/** Short gets in a fragment. The target answers all of them with a single reply. */
+struct ompi_osc_pt2pt_get_batch_t {
+    ompi_osc_pt2pt_module_t *module;
+    /* base tag of the reply */
+    int tag;
+    /* number of gets in the batch and allocated size of the gets array */
+    int count;
+    int size;
+    /* total length of the reply */
+    uint32_t len;
+    /* reply buffer. allocated when the fragment is sent. */
+    char *buffer;
+    ompi_osc_pt2pt_batch_get_t *gets;
+};
+typedef struct ompi_osc_pt2pt_get_batch_t ompi_osc_pt2pt_get_batch_t;
+
 /** Communication buffer for packing messages */
 struct ompi_osc_pt2pt_frag_t {
     opal_free_list_item_t super;
@@ -39,6 +71,14 @@ struct ompi_osc_pt2pt_frag_t {
     int32_t pending_long_sends;
     ompi_osc_pt2pt_frag_header_t *header;
     ompi_osc_pt2pt_module_t *module;
+
+    /* short gets answered with a single reply (NULL if none) */
+    ompi_osc_pt2pt_get_batch_t *get_batch;
+
+    /* last segment of the accumulate vector being built in this fragment and the
+     * end of that segment */
+    ompi_osc_pt2pt_header_acc_seg_t *acc_vec_tail;
+    char *acc_vec_end;
 };
 typedef struct ompi_osc_pt2pt_frag_t ompi_osc_pt2pt_frag_t;
 OBJ_CLASS_DECLARATION(ompi_osc_pt2pt_frag_t);
@@ -90,6 +130,9 @@ static inline ompi_osc_pt2pt_frag_t *ompi_osc_pt2pt_frag_alloc_non_buffered (omp
     curr->remain_len = mca_osc_pt2pt_component.buffer_size;
     curr->module = module;
     curr->pending = 1;
+    curr->get_batch = NULL;
+    curr->acc_vec_tail = NULL;
+    curr->acc_vec_end = NULL;
 
     curr->header->base.type = OMPI_OSC_PT2PT_HDR_TYPE_FRAG;
     curr->header->base.flags = OMPI_OSC_PT2PT_HDR_FLAG_VALID;
@@ -175,9 +218,13 @@ static inline int _ompi_osc_pt2pt_frag_alloc (ompi_osc_pt2pt_module_t *module, i
     return OMPI_SUCCESS;
 }
 
-static inline int ompi_osc_pt2pt_frag_alloc (ompi_osc_pt2pt_module_t *module, int target,
-                                             size_t request_len, ompi_osc_pt2pt_frag_t **buffer,
-                                             char **ptr, bool long_send, bool buffered)
+/*
+ * allocate space in a fragment for a synchronization message. unlike
+ * ompi_osc_pt2pt_frag_alloc() the target is not added to the dirty set.
+ */
+static inline int ompi_osc_pt2pt_frag_alloc_control (ompi_osc_pt2pt_module_t *module, int target,
+                                                     size_t request_len, ompi_osc_pt2pt_frag_t **buffer,
+                                                     char **ptr, bool long_send, bool buffered)
 {
     int ret;
 
@@ -198,4 +245,72 @@ static inline int ompi_osc_pt2pt_frag_alloc (ompi_osc_pt2pt_module_t *module, in
     return ret;
 }
 
+static inline int ompi_osc_pt2pt_frag_alloc (ompi_osc_pt2pt_module_t *module, int target,
+                                             size_t request_len, ompi_osc_pt2pt_frag_t **buffer,
+                                             char **ptr, bool long_send, bool buffered)
+{
+    int ret;
+
+    ret = ompi_osc_pt2pt_frag_alloc_control (module, target, request_len, buffer, ptr, long_send, buffered);
+    if (OPAL_LIKELY(OMPI_SUCCESS == ret)) {
+        /* the space is reserved so a flush started from now on covers this operation */
+        ompi_osc_pt2pt_mark_dirty (module, target);
+    }
+
+    return ret;
+}
+
+/*
+ * Note: this function takes the module lock
+ *
+ * allocate an accumulate segment in the active fragment to the target. the segment
+ * is linked to the accumulate vector being built in the fragment if the datatype
+ * and operation match. if the window requires accumulate ordering the segment is
+ * only linked if it immediately follows the last segment of the vector. otherwise
+ * it starts a new vector. on return *ptr points to the segment payload.
+ */
+static inline int ompi_osc_pt2pt_frag_alloc_acc_seg (ompi_osc_pt2pt_module_t *module, int target,
+                                                     struct ompi_datatype_t *datatype, struct ompi_op_t *op,
+                                                     uint64_t displacement, uint32_t count,
+                                                     ompi_osc_pt2pt_frag_t **buffer, char **ptr)
+{
+    size_t request_len = OPAL_ALIGN(sizeof (ompi_osc_pt2pt_header_acc_seg_t) + datatype->super.size * count,
+                                    8, size_t);
+    ompi_osc_pt2pt_header_acc_seg_t *seg, *tail;
+    ompi_osc_pt2pt_frag_t *curr;
+    int ret;
+
+    ret = ompi_osc_pt2pt_frag_alloc (module, target, request_len, &curr, ptr, false, true);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+        return ret;
+    }
+
+    seg = (ompi_osc_pt2pt_header_acc_seg_t *) *ptr;
+    seg->base.flags = OMPI_OSC_PT2PT_HDR_FLAG_VALID;
+    seg->datatype = datatype->d_f_to_c_index;
+    seg->op = op->o_f_to_c_index;
+    seg->displacement = displacement;
+    seg->count = count;
+    seg->next = 0;
+
+    OPAL_THREAD_LOCK(&module->lock);
+    tail = curr->acc_vec_tail;
+    if (NULL != tail && tail->datatype == seg->datatype && tail->op == seg->op &&
+        (!module->accumulate_ordering || (char *) seg == curr->acc_vec_end)) {
+        seg->base.type = OMPI_OSC_PT2PT_HDR_TYPE_ACC_SEG;
+        tail->next = (uint32_t) ((uintptr_t) seg - (uintptr_t) curr->header);
+    } else {
+        seg->base.type = OMPI_OSC_PT2PT_HDR_TYPE_ACC_VEC;
+    }
+
+    curr->acc_vec_tail = seg;
+    curr->acc_vec_end = (char *) seg + request_len;
+    OPAL_THREAD_UNLOCK(&module->lock);
+
+    *ptr = (char *) (seg + 1);
+    *buffer = curr;
+
+    return OMPI_SUCCESS;
+}
+
 #endif
@@ -42,6 +42,9 @@ enum ompi_osc_pt2pt_hdr_type_t {
     OMPI_OSC_PT2PT_HDR_TYPE_CSWAP_LONG   = 0x07,
     OMPI_OSC_PT2PT_HDR_TYPE_GET_ACC      = 0x08,
     OMPI_OSC_PT2PT_HDR_TYPE_GET_ACC_LONG = 0x09,
+    OMPI_OSC_PT2PT_HDR_TYPE_GET_SHORT    = 0x0a,
+    OMPI_OSC_PT2PT_HDR_TYPE_ACC_VEC      = 0x0b,
+    OMPI_OSC_PT2PT_HDR_TYPE_ACC_SEG      = 0x0c,
     OMPI_OSC_PT2PT_HDR_TYPE_COMPLETE     = 0x10,
     OMPI_OSC_PT2PT_HDR_TYPE_POST         = 0x11,
     OMPI_OSC_PT2PT_HDR_TYPE_LOCK_REQ     = 0x12,
@@ -50,6 +53,8 @@ enum ompi_osc_pt2pt_hdr_type_t {
     OMPI_OSC_PT2PT_HDR_TYPE_UNLOCK_ACK   = 0x15,
     OMPI_OSC_PT2PT_HDR_TYPE_FLUSH_REQ    = 0x16,
     OMPI_OSC_PT2PT_HDR_TYPE_FLUSH_ACK    = 0x17,
+    OMPI_OSC_PT2PT_HDR_TYPE_FENCE        = 0x18,
+    OMPI_OSC_PT2PT_HDR_TYPE_FENCE_ACK    = 0x19,
     OMPI_OSC_PT2PT_HDR_TYPE_FRAG         = 0x20,
 };
 typedef enum ompi_osc_pt2pt_hdr_type_t ompi_osc_pt2pt_hdr_type_t;
@@ -98,6 +103,37 @@ struct ompi_osc_pt2pt_header_get_t {
 };
 typedef struct ompi_osc_pt2pt_header_get_t ompi_osc_pt2pt_header_get_t;
 
+/* contiguous get that is answered as part of a single reply covering every
+ * short get in the same fragment. the data for this get starts reply_offset
+ * bytes into the reply. */
+struct ompi_osc_pt2pt_header_get_short_t {
+    ompi_osc_pt2pt_header_base_t base;
+
+    uint16_t tag;
+    uint32_t len;
+    uint64_t displacement;
+    int64_t offset; /* true lower bound of the target datatype */
+    uint32_t reply_offset;
+    uint32_t pad;
+};
+typedef struct ompi_osc_pt2pt_header_get_short_t ompi_osc_pt2pt_header_get_short_t;
+
+/* one segment of an accumulate vector. the first segment in a fragment
+ * carries the ACC_VEC type and later segments carry ACC_SEG. segments are
+ * linked by next (offset from the start of the fragment, 0 terminates) and
+ * are applied together when the leader is processed. all segments of a
+ * vector share the same predefined datatype and operation. */
+struct ompi_osc_pt2pt_header_acc_seg_t {
+    ompi_osc_pt2pt_header_base_t base;
+
+    uint16_t datatype; /* predefined datatype id */
+    uint32_t op;
+    uint64_t displacement;
+    uint32_t count;
+    uint32_t next;
+};
+typedef struct ompi_osc_pt2pt_header_acc_seg_t ompi_osc_pt2pt_header_acc_seg_t;
+
 struct ompi_osc_pt2pt_header_complete_t {
     ompi_osc_pt2pt_header_base_t base;
 #if OPAL_ENABLE_HETEROGENEOUS_SUPPORT || OPAL_ENABLE_DEBUG
@@ -180,6 +216,20 @@ struct ompi_osc_pt2pt_header_flush_ack_t {
 };
 typedef struct ompi_osc_pt2pt_header_flush_ack_t ompi_osc_pt2pt_header_flush_ack_t;
 
+struct ompi_osc_pt2pt_header_fence_t {
+    ompi_osc_pt2pt_header_base_t base;
+#if OPAL_ENABLE_HETEROGENEOUS_SUPPORT || OPAL_ENABLE_DEBUG
+    uint8_t padding[2];
+#endif
+    uint32_t frag_count;
+};
+typedef struct ompi_osc_pt2pt_header_fence_t ompi_osc_pt2pt_header_fence_t;
+
+struct ompi_osc_pt2pt_header_fence_ack_t {
+    ompi_osc_pt2pt_header_base_t base;
+};
+typedef struct ompi_osc_pt2pt_header_fence_ack_t ompi_osc_pt2pt_header_fence_ack_t;
+
 struct ompi_osc_pt2pt_frag_header_t {
     ompi_osc_pt2pt_header_base_t base;
 #if OPAL_ENABLE_HETEROGENEOUS_SUPPORT || OPAL_ENABLE_DEBUG
@@ -196,6 +246,8 @@ union ompi_osc_pt2pt_header_t {
     ompi_osc_pt2pt_header_put_t        put;
     ompi_osc_pt2pt_header_acc_t        acc;
     ompi_osc_pt2pt_header_get_t        get;
+    ompi_osc_pt2pt_header_get_short_t  get_short;
+    ompi_osc_pt2pt_header_acc_seg_t    acc_seg;
     ompi_osc_pt2pt_header_complete_t   complete;
     ompi_osc_pt2pt_header_cswap_t      cswap;
     ompi_osc_pt2pt_header_post_t       post;
@@ -205,6 +257,8 @@ union ompi_osc_pt2pt_header_t {
     ompi_osc_pt2pt_header_unlock_ack_t unlock_ack;
     ompi_osc_pt2pt_header_flush_t      flush;
     ompi_osc_pt2pt_header_flush_ack_t  flush_ack;
+    ompi_osc_pt2pt_header_fence_t      fence;
+    ompi_osc_pt2pt_header_fence_ack_t  fence_ack;
     ompi_osc_pt2pt_frag_header_t       frag;
 };
 typedef union ompi_osc_pt2pt_header_t ompi_osc_pt2pt_header_t;
@@ -287,6 +341,14 @@ typedef union ompi_osc_pt2pt_header_t ompi_osc_pt2pt_header_t;
 #define MCA_OSC_PT2PT_FLUSH_ACK_HDR_NTOH(h)
 #define MCA_OSC_PT2PT_FLUSH_ACK_HDR_HTON(h)
 
+#define MCA_OSC_PT2PT_FENCE_HDR_NTOH(h)      \
+    (h).frag_count = ntohl((h).frag_count)
+#define MCA_OSC_PT2PT_FENCE_HDR_HTON(h)      \
+    (h).frag_count = htonl((h).frag_count)
+
+#define MCA_OSC_PT2PT_FENCE_ACK_HDR_NTOH(h)
+#define MCA_OSC_PT2PT_FENCE_ACK_HDR_HTON(h)
+
 #define MCA_OSC_PT2PT_POST_HDR_NTOH(h)
 #define MCA_OSC_PT2PT_POST_HDR_HTON(h)
 
@@ -349,6 +411,12 @@ osc_pt2pt_ntoh(ompi_osc_pt2pt_header_t *hdr)
         case OMPI_OSC_PT2PT_HDR_TYPE_FLUSH_ACK:
             MCA_OSC_PT2PT_FLUSH_ACK_HDR_NTOH(hdr->flush_ack);
             break;
+        case OMPI_OSC_PT2PT_HDR_TYPE_FENCE:
+            MCA_OSC_PT2PT_FENCE_HDR_NTOH(hdr->fence);
+            break;
+        case OMPI_OSC_PT2PT_HDR_TYPE_FENCE_ACK:
+            MCA_OSC_PT2PT_FENCE_ACK_HDR_NTOH(hdr->fence_ack);
+            break;
         case OMPI_OSC_PT2PT_HDR_TYPE_FRAG:
             MCA_OSC_PT2PT_FRAG_HDR_NTOH(hdr->frag);
             break;
@@ -417,6 +485,12 @@ osc_pt2pt_hton_intr(ompi_osc_pt2pt_header_t *hdr, const ompi_proc_t *proc)
         case OMPI_OSC_PT2PT_HDR_TYPE_FLUSH_ACK:
             MCA_OSC_PT2PT_FLUSH_ACK_HDR_HTON(hdr->flush_ack);
             break;
+        case OMPI_OSC_PT2PT_HDR_TYPE_FENCE:
+            MCA_OSC_PT2PT_FENCE_HDR_HTON(hdr->fence);
+            break;
+        case OMPI_OSC_PT2PT_HDR_TYPE_FENCE_ACK:
+            MCA_OSC_PT2PT_FENCE_ACK_HDR_HTON(hdr->fence_ack);
+            break;
         case OMPI_OSC_PT2PT_HDR_TYPE_FRAG:
             MCA_OSC_PT2PT_FRAG_HDR_HTON(hdr->frag);
             break;
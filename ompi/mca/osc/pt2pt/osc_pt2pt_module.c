@@ -105,6 +105,7 @@ int ompi_osc_pt2pt_free(ompi_win_t *win)
     }
 
     free ((void *) module->epoch_outgoing_frag_count);
+    free (module->dirty_targets);
 
     if (NULL != module->comm) {
         ompi_comm_free(&module->comm);
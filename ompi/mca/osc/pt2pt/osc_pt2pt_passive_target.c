@@ -54,6 +54,7 @@ static int ompi_osc_pt2pt_activate_next_lock (ompi_osc_pt2pt_module_t *module);
 static inline int queue_lock (ompi_osc_pt2pt_module_t *module, int requestor, int lock_type, uint64_t lock_ptr);
 static int ompi_osc_pt2pt_flush_lock (ompi_osc_pt2pt_module_t *module, ompi_osc_pt2pt_sync_t *lock,
                                       int target);
+static int ompi_osc_pt2pt_dirty_targets (ompi_osc_pt2pt_module_t *module, int **targets, bool clear);
 
 static inline int ompi_osc_pt2pt_lock_self (ompi_osc_pt2pt_module_t *module, ompi_osc_pt2pt_sync_t *lock)
 {
@@ -454,6 +455,9 @@ static int ompi_osc_pt2pt_unlock_internal (int target, ompi_win_t *win)
         ompi_osc_pt2pt_sync_return (lock);
     } else {
         ompi_osc_pt2pt_sync_reset (lock);
+
+        /* all targets have been unlocked */
+        (void) ompi_osc_pt2pt_dirty_targets (module, NULL, true);
     }
 
     --module->passive_target_access_epoch;
@@ -493,6 +497,49 @@ int ompi_osc_pt2pt_sync (struct ompi_win_t *win)
     return OMPI_SUCCESS;
 }
 
+/**
+ * @brief get the targets in the dirty set of a lock_all epoch
+ *
+ * @param[in]  module   osc pt2pt module
+ * @param[out] targets  copy of the set (may be NULL). must be freed by the caller.
+ * @param[in]  clear    empty the set
+ *
+ * @returns the number of targets in the set on success
+ * @returns OMPI_ERR_OUT_OF_RESOURCE if the copy could not be allocated
+ */
+static int ompi_osc_pt2pt_dirty_targets (ompi_osc_pt2pt_module_t *module, int **targets, bool clear)
+{
+    int count;
+
+    OPAL_THREAD_LOCK(&module->lock);
+    count = module->dirty_count;
+
+    if (NULL != targets) {
+        *targets = NULL;
+        if (count) {
+            *targets = malloc (count * sizeof (int));
+            if (OPAL_UNLIKELY(NULL == *targets)) {
+                OPAL_THREAD_UNLOCK(&module->lock);
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
+
+            memcpy (*targets, module->dirty_targets, count * sizeof (int));
+        }
+    }
+
+    if (clear) {
+        for (int i = 0 ; i < count ; ++i) {
+            ompi_osc_pt2pt_peer_set_flag (ompi_osc_pt2pt_peer_lookup (module, module->dirty_targets[i]),
+                                          OMPI_OSC_PT2PT_PEER_FLAG_DIRTY, false);
+        }
+
+        module->dirty_count = 0;
+    }
+    OPAL_THREAD_UNLOCK(&module->lock);
+
+    return count;
+}
+
 static int ompi_osc_pt2pt_flush_lock (ompi_osc_pt2pt_module_t *module, ompi_osc_pt2pt_sync_t *lock,
                                       int target)
 {
@@ -504,17 +551,28 @@ static int ompi_osc_pt2pt_flush_lock (ompi_osc_pt2pt_module_t *module, ompi_osc_
     ompi_osc_pt2pt_sync_wait_expected (lock);
 
     if (-1 == target) {
-        /* NTH: no local flush */
-        for (int i = 0 ; i < ompi_comm_size(module->comm) ; ++i) {
-            if (i == my_rank) {
+        int *targets, count;
+
+        /* NTH: no local flush. only targets that were sent operations since the
+         * last flush need a flush request. */
+        count = ompi_osc_pt2pt_dirty_targets (module, &targets, true);
+        if (OPAL_UNLIKELY(0 > count)) {
+            return count;
+        }
+
+        for (int i = 0 ; i < count ; ++i) {
+            if (targets[i] == my_rank) {
                 continue;
             }
 
-            ret = ompi_osc_pt2pt_flush_remote (module, i, lock);
+            ret = ompi_osc_pt2pt_flush_remote (module, targets[i], lock);
             if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+                free (targets);
                 return ret;
             }
         }
+
+        free (targets);
     } else {
         /* send control message with flush request and count */
         ret = ompi_osc_pt2pt_flush_remote (module, target, lock);
@@ -656,7 +714,28 @@ int ompi_osc_pt2pt_flush_local_all (struct ompi_win_t *win)
         return OMPI_ERR_RMA_SYNC;
     }
 
-    ret = ompi_osc_pt2pt_frag_flush_all(module);
+    if (OMPI_OSC_PT2PT_SYNC_TYPE_LOCK == module->all_sync.type) {
+        int *targets, count;
+
+        /* start the fragments to the targets used in this lock_all epoch. the targets
+         * stay in the dirty set until the next flush_all. */
+        count = ompi_osc_pt2pt_dirty_targets (module, &targets, false);
+        if (OPAL_UNLIKELY(0 > count)) {
+            return count;
+        }
+
+        for (int i = 0 ; i < count ; ++i) {
+            ret = ompi_osc_pt2pt_frag_flush_target (module, targets[i]);
+            if (OMPI_SUCCESS != ret) {
+                break;
+            }
+        }
+
+        free (targets);
+    } else {
+        ret = ompi_osc_pt2pt_frag_flush_all(module);
+    }
+
     if (OMPI_SUCCESS != ret) {
         return ret;
     }
@@ -35,12 +35,12 @@ request_free(struct ompi_request_t **ompi_req)
     ompi_osc_pt2pt_request_t *request =
         (ompi_osc_pt2pt_request_t*) *ompi_req;
 
-    if (REQUEST_COMPLETED != request->super.req_complete) {
-        return MPI_ERR_REQUEST;
+    /* an active RMA request may be freed. in that case the request is returned
+     * to the free list when it completes. */
+    if (2 == OPAL_THREAD_ADD_FETCH32(&request->release_count, 1)) {
+        OMPI_OSC_PT2PT_REQUEST_RETURN(request);
     }
 
-    OMPI_OSC_PT2PT_REQUEST_RETURN(request);
-
     *ompi_req = MPI_REQUEST_NULL;
 
     return OMPI_SUCCESS;
@@ -55,6 +55,7 @@ request_construct(ompi_osc_pt2pt_request_t *request)
     request->super.req_free = request_free;
     request->super.req_cancel = request_cancel;
     request->outstanding_requests = 0;
+    request->release_count = 0;
 }
 
 OBJ_CLASS_INSTANCE(ompi_osc_pt2pt_request_t,
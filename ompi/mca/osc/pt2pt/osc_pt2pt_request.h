@@ -29,6 +29,9 @@ struct ompi_osc_pt2pt_request_t {
     struct ompi_datatype_t *origin_dt;
     ompi_osc_pt2pt_module_t* module;
     opal_atomic_int32_t outstanding_requests;
+    /** the request is returned once both MPI_Request_free and the completion
+     * path are done with it */
+    opal_atomic_int32_t release_count;
     bool internal;
 };
 typedef struct ompi_osc_pt2pt_request_t ompi_osc_pt2pt_request_t;
@@ -58,6 +61,7 @@ OBJ_CLASS_DECLARATION(ompi_osc_pt2pt_request_t);
     do {                                                                \
         OMPI_REQUEST_FINI(&(req)->super);                               \
         (req)->outstanding_requests = 0;                                \
+        (req)->release_count = 0;                                       \
         opal_free_list_return (&mca_osc_pt2pt_component.requests,       \
                                  (opal_free_list_item_t *) (req));      \
     } while (0)
@@ -69,6 +73,11 @@ static inline void ompi_osc_pt2pt_request_complete (ompi_osc_pt2pt_request_t *re
 
         /* mark the request complete at the mpi level */
         ompi_request_complete (&request->super, true);
+
+        /* the user may have freed the request while it was active */
+        if (2 == OPAL_THREAD_ADD_FETCH32(&request->release_count, 1)) {
+            OMPI_OSC_PT2PT_REQUEST_RETURN (request);
+        }
     } else {
         OMPI_OSC_PT2PT_REQUEST_RETURN (request);
     }
@@ -95,6 +95,12 @@ struct ompi_osc_rdma_component_t {
     /** Locking mode to use as the default for all windows */
     int locking_mode;
 
+    /** Queue the processes waiting for an exclusive lock */
+    bool exclusive_lock_queue;
+
+    /** Aggregate the global lock counts of the processes of a node */
+    bool aggregate_global_lock;
+
     /** Accumulate operations will only operate on a single intrinsic datatype */
     bool acc_single_intrinsic;
 
@@ -130,6 +136,12 @@ struct ompi_osc_rdma_module_t {
     /** locking mode to use */
     int locking_mode;
 
+    /** processes waiting for an exclusive lock wait in a queue */
+    bool exclusive_lock_queue;
+
+    /** queue nodes in use (bitmap) */
+    opal_atomic_int32_t queue_nodes_used;
+
     /* window configuration */
 
     /** value of same_disp_unit info key for this window */
@@ -172,6 +184,10 @@ struct ompi_osc_rdma_module_t {
     /** local state structure (shared memory) */
     ompi_osc_rdma_state_t *state;
 
+    /** state of the first process on this node, used to aggregate the global
+     * lock counts of the node (NULL if not aggregating) */
+    ompi_osc_rdma_state_t *node_state;
+
     /** node-level communication data (shared memory) */
     unsigned char *node_comm_info;
 
@@ -230,6 +246,9 @@ struct ompi_osc_rdma_module_t {
     /** array of locks (small jobs) */
     ompi_osc_rdma_sync_t **outstanding_lock_array;
 
+    /** list of outstanding targeted locks. flush_all only visits these. */
+    opal_list_t active_locks;
+
 
     /* ******************* peer storage *********************** */
 
@@ -432,6 +451,8 @@ static inline void ompi_osc_rdma_module_lock_insert (struct ompi_osc_rdma_module
     } else {
         (void) opal_hash_table_set_value_uint32 (&module->outstanding_locks, (uint32_t) lock->sync.lock.target, (void *) lock);
     }
+
+    opal_list_append (&module->active_locks, &lock->super);
 }
 
 
@@ -451,6 +472,8 @@ static inline void ompi_osc_rdma_module_lock_remove (struct ompi_osc_rdma_module
     } else {
         (void) opal_hash_table_remove_value_uint32 (&module->outstanding_locks, (uint32_t) lock->sync.lock.target);
     }
+
+    (void) opal_list_remove_item (&module->active_locks, &lock->super);
 }
 
 /**
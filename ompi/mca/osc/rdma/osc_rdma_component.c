@@ -219,10 +219,11 @@ static int ompi_osc_rdma_component_register (void)
                                             MCA_BASE_VAR_SCOPE_LOCAL, &mca_osc_rdma_component.buffer_size);
     free(description_str);
 
-    mca_osc_rdma_component.max_attach = 64;
+    mca_osc_rdma_component.max_attach = 1024;
     opal_asprintf(&description_str, "Maximum number of buffers that can be attached to a dynamic window. "
              "Keep in mind that each attached buffer will use a potentially limited "
-             "resource (default: %d)", mca_osc_rdma_component.max_attach);
+             "resource and each possible attachment takes space in the window state "
+             "(default: %d)", mca_osc_rdma_component.max_attach);
     (void) mca_base_component_var_register (&mca_osc_rdma_component.super.osc_version, "max_attach", description_str,
                                            MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0, OPAL_INFO_LVL_3,
                                            MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_rdma_component.max_attach);
@@ -245,6 +246,22 @@ static int ompi_osc_rdma_component_register (void)
                                             MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_rdma_component.locking_mode);
     OBJ_RELEASE(new_enum);
 
+    mca_osc_rdma_component.exclusive_lock_queue = true;
+    (void) mca_base_component_var_register (&mca_osc_rdma_component.super.osc_version, "exclusive_lock_queue",
+                                            "Queue the processes waiting for an exclusive lock on the same target "
+                                            "(MCS lock) instead of having all of them retry remote atomics on the "
+                                            "lock of the target (default: true)", MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_GROUP,
+                                            &mca_osc_rdma_component.exclusive_lock_queue);
+
+    mca_osc_rdma_component.aggregate_global_lock = true;
+    (void) mca_base_component_var_register (&mca_osc_rdma_component.super.osc_version, "aggregate_global_lock",
+                                            "With the two_level locking mode, let one process per node update the "
+                                            "global lock on behalf of the other processes of the node "
+                                            "(default: true)", MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_GROUP,
+                                            &mca_osc_rdma_component.aggregate_global_lock);
+
     ompi_osc_rdma_btl_names = "openib,ugni,uct,ucp";
     opal_asprintf(&description_str, "Comma-delimited list of BTL component names to allow without verifying "
              "connectivity. Do not add a BTL to to this list unless it can reach all "
@@ -663,6 +680,11 @@ static int allocate_state_shared (ompi_osc_rdma_module_t *module, void **base, s
         /* initialize my state */
         memset (module->state, 0, module->state_size);
 
+        if (OMPI_OSC_RDMA_LOCKING_TWO_LEVEL == module->locking_mode && mca_osc_rdma_component.aggregate_global_lock) {
+            /* the global lock counts of this node are aggregated in the state of the first local rank */
+            module->node_state = (ompi_osc_rdma_state_t *) ((uintptr_t) module->segment_base + state_base);
+        }
+
         /* barrier to make sure all ranks have attached and initialized */
         shared_comm->c_coll->coll_barrier(shared_comm, shared_comm->c_coll->coll_barrier_module);
 
@@ -1150,6 +1172,7 @@ static int ompi_osc_rdma_component_select (struct ompi_win_t *win, void **base,
     /* initialize the objects, so that always free in cleanup */
     OBJ_CONSTRUCT(&module->lock, opal_recursive_mutex_t);
     OBJ_CONSTRUCT(&module->outstanding_locks, opal_hash_table_t);
+    OBJ_CONSTRUCT(&module->active_locks, opal_list_t);
     OBJ_CONSTRUCT(&module->pending_posts, opal_list_t);
     OBJ_CONSTRUCT(&module->peer_lock, opal_mutex_t);
     OBJ_CONSTRUCT(&module->all_sync, ompi_osc_rdma_sync_t);
@@ -1158,6 +1181,7 @@ static int ompi_osc_rdma_component_select (struct ompi_win_t *win, void **base,
     module->same_size      = check_config_value_bool ("same_size", info);
     module->no_locks       = check_config_value_bool ("no_locks", info);
     module->locking_mode   = mca_osc_rdma_component.locking_mode;
+    module->exclusive_lock_queue = mca_osc_rdma_component.exclusive_lock_queue;
     module->acc_single_intrinsic = check_config_value_bool ("acc_single_intrinsic", info);
     module->acc_use_amo = mca_osc_rdma_component.acc_use_amo;
 
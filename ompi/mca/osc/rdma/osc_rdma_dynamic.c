@@ -308,27 +308,35 @@ int ompi_osc_rdma_detach (struct ompi_win_t *win, const void *base)
     region_count = module->state->region_count & 0xffffffffL;
     region_id    = module->state->region_count >> 32;
 
-    /* look up the associated region */
-    for (region_index = 0 ; region_index < region_count ; ++region_index) {
-        rdma_region_handle = module->dynamic_handles[region_index];
-        region = (ompi_osc_rdma_region_t *) ((intptr_t) module->state->regions + region_index * module->region_size);
-        OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_INFO, "checking attachments at index %d {.base=%p, len=%lu} for attachment %p"
-                         ", region handle=%p", region_index, (void *) region->base, (unsigned long)region->len, base, (void*)rdma_region_handle);
-
-        if ((uintptr_t)region->base > (uintptr_t) base || (uintptr_t)(region->base + region->len) < (uintptr_t) base) {
-            continue;
+    /* look up the associated region. the attachment is usually in the region containing its base */
+    region = ompi_osc_rdma_find_region_containing ((ompi_osc_rdma_region_t *) module->state->regions, 0, region_count - 1,
+                                                   (intptr_t) base, (intptr_t) base + 1, module->region_size, &region_index);
+    if (NULL == region || OPAL_SUCCESS != ompi_osc_rdma_remove_attachment (module->dynamic_handles[region_index],
+                                                                           (intptr_t) base)) {
+        /* regions registered for overlapping attachments may share pages, search all of them */
+        for (region_index = 0 ; region_index < region_count ; ++region_index) {
+            rdma_region_handle = module->dynamic_handles[region_index];
+            region = (ompi_osc_rdma_region_t *) ((intptr_t) module->state->regions + region_index * module->region_size);
+            OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_INFO, "checking attachments at index %d {.base=%p, len=%lu} for attachment %p"
+                             ", region handle=%p", region_index, (void *) region->base, (unsigned long)region->len, base, (void*)rdma_region_handle);
+
+            if ((uintptr_t)region->base > (uintptr_t) base || (uintptr_t)(region->base + region->len) < (uintptr_t) base) {
+                continue;
+            }
+
+            if (OPAL_SUCCESS == ompi_osc_rdma_remove_attachment (rdma_region_handle, (intptr_t) base)) {
+                break;
+            }
         }
 
-        if (OPAL_SUCCESS == ompi_osc_rdma_remove_attachment (rdma_region_handle, (intptr_t) base)) {
-            break;
+        if (region_index == region_count) {
+            OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_INFO, "could not find dynamic memory attachment for %p", base);
+            OPAL_THREAD_UNLOCK(&module->lock);
+            return OMPI_ERR_BASE;
         }
     }
 
-    if (region_index == region_count) {
-        OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_INFO, "could not find dynamic memory attachment for %p", base);
-        OPAL_THREAD_UNLOCK(&module->lock);
-        return OMPI_ERR_BASE;
-    }
+    rdma_region_handle = module->dynamic_handles[region_index];
 
     if (!opal_list_is_empty (&rdma_region_handle->attachments)) {
         /* another region is referencing this attachment */
@@ -375,11 +383,11 @@ int ompi_osc_rdma_detach (struct ompi_win_t *win, const void *base)
  * @param[in] peer           peer object to refresh
  *
  * This function does the work of keeping the local view of a remote peer in sync with what is attached
- * to the remote window. It is called on every address translation since there is no way (currently) to
- * detect that the attached regions have changed. To reduce the amount of data read we first read the
- * region count (which contains an id). If that hasn't changed the region data is not updated. If the
- * list of attached regions has changed then all valid regions are read from the peer while holding
- * their region lock.
+ * to the remote window. It is called on every address translation since the target may detach and
+ * attach regions (possibly at the same addresses) at any time without the origin synchronizing. To
+ * reduce the amount of data read we first read the region count (which contains an id). If that hasn't
+ * changed the region data is not updated. If the list of attached regions has changed then all valid
+ * regions are read from the peer while holding their region lock.
  */
 static int ompi_osc_rdma_refresh_dynamic_region (ompi_osc_rdma_module_t *module, ompi_osc_rdma_peer_dynamic_t *peer) {
     osc_rdma_counter_t region_count, region_id;
@@ -439,4 +439,91 @@ static inline int ompi_osc_rdma_lock_release_exclusive (ompi_osc_rdma_module_t *
     return ret;
 }
 
+/**
+ * ompi_osc_rdma_lock_exchange:
+ *
+ * @param[in]  module - osc/rdma module
+ * @param[in]  peer   - peer object
+ * @param[in]  value  - new value
+ * @param[in]  offset - offset of the word in the peer's state segment
+ * @param[out] result - previous value
+ *
+ * @returns OMPI_SUCCESS on success or another ompi error code on failure
+ *
+ * This function atomically swaps a word of a peer's state.
+ */
+static inline int ompi_osc_rdma_lock_exchange (ompi_osc_rdma_module_t *module, ompi_osc_rdma_peer_t *peer,
+                                               ompi_osc_rdma_lock_t value, ptrdiff_t offset,
+                                               ompi_osc_rdma_lock_t *result)
+{
+    uint64_t lock = (uint64_t) (intptr_t) peer->state + offset;
+
+    if (!ompi_osc_rdma_peer_local_state (peer)) {
+        return ompi_osc_rdma_lock_btl_fop (module, peer, lock, MCA_BTL_ATOMIC_SWAP, value, result, true);
+    }
+
+    *result = ompi_osc_rdma_lock_swap ((ompi_osc_rdma_atomic_lock_t *)(intptr_t) lock, value);
+
+    return OMPI_SUCCESS;
+}
+
+/**
+ * ompi_osc_rdma_lock_compare_exchange_peer:
+ *
+ * @param[in]  module  - osc/rdma module
+ * @param[in]  peer    - peer object
+ * @param[in]  compare - expected value
+ * @param[in]  value   - new value
+ * @param[in]  offset  - offset of the word in the peer's state segment
+ *
+ * @returns 0 if the word was swapped, 1 if it did not hold {compare}, or an
+ * ompi error code on failure.
+ */
+static inline int ompi_osc_rdma_lock_compare_exchange_peer (ompi_osc_rdma_module_t *module, ompi_osc_rdma_peer_t *peer,
+                                                            ompi_osc_rdma_lock_t compare, ompi_osc_rdma_lock_t value,
+                                                            ptrdiff_t offset)
+{
+    uint64_t lock = (uint64_t) (intptr_t) peer->state + offset;
+    ompi_osc_rdma_lock_t lock_state = compare;
+    int ret;
+
+    if (!ompi_osc_rdma_peer_local_state (peer)) {
+        ret = ompi_osc_rdma_lock_btl_cswap (module, peer, lock, compare, value, &lock_state);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+            return ret;
+        }
+
+        return lock_state != compare;
+    }
+
+    return !ompi_osc_rdma_lock_compare_exchange ((ompi_osc_rdma_atomic_lock_t *)(intptr_t) lock, &lock_state, value);
+}
+
+/**
+ * ompi_osc_rdma_lock_signal:
+ *
+ * @param[in] module - osc/rdma module
+ * @param[in] peer   - peer object
+ * @param[in] value  - value to add
+ * @param[in] offset - offset of the word in the peer's state segment
+ *
+ * @returns OMPI_SUCCESS on success or another ompi error code on failure
+ *
+ * This function adds {value} to a word of a peer's state without waiting
+ * for the result. The peer polls the word in its local memory.
+ */
+static inline int ompi_osc_rdma_lock_signal (ompi_osc_rdma_module_t *module, ompi_osc_rdma_peer_t *peer,
+                                             ompi_osc_rdma_lock_t value, ptrdiff_t offset)
+{
+    uint64_t lock = (uint64_t) (intptr_t) peer->state + offset;
+
+    if (!ompi_osc_rdma_peer_local_state (peer)) {
+        return ompi_osc_rdma_lock_btl_op (module, peer, lock, MCA_BTL_ATOMIC_ADD, value, false);
+    }
+
+    (void) ompi_osc_rdma_lock_add ((ompi_osc_rdma_atomic_lock_t *)(intptr_t) lock, value);
+
+    return OMPI_SUCCESS;
+}
+
 #endif /* OMPI_OSC_RDMA_LOCK_H */
@@ -90,6 +90,7 @@ int ompi_osc_rdma_free(ompi_win_t *win)
     }
 
     OBJ_DESTRUCT(&module->outstanding_locks);
+    OBJ_DESTRUCT(&module->active_locks);
     OBJ_DESTRUCT(&module->lock);
     OBJ_DESTRUCT(&module->peer_lock);
     OBJ_DESTRUCT(&module->all_sync);
@@ -67,10 +67,9 @@ int ompi_osc_rdma_flush (int target, struct ompi_win_t *win)
 int ompi_osc_rdma_flush_all (struct ompi_win_t *win)
 {
     ompi_osc_rdma_module_t *module = GET_MODULE(win);
-    ompi_osc_rdma_sync_t *lock;
-    int ret = OMPI_SUCCESS;
-    uint32_t key;
-    void *node;
+    ompi_osc_rdma_sync_t *lock, **locks = NULL;
+    bool flushed = false;
+    int lock_count = 0;
 
     /* flush is only allowed from within a passive target epoch */
     if (!ompi_osc_rdma_in_passive_epoch (module)) {
@@ -79,20 +78,45 @@ int ompi_osc_rdma_flush_all (struct ompi_win_t *win)
 
     OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "flush_all: %s", win->w_name);
 
+    /* take a snapshot of the targeted locks. the references keep the locks alive if
+     * another thread unlocks a target while we are waiting on it. */
+    OPAL_THREAD_LOCK(&module->lock);
+    if (opal_list_get_size (&module->active_locks)) {
+        locks = malloc (opal_list_get_size (&module->active_locks) * sizeof (locks[0]));
+        if (OPAL_UNLIKELY(NULL == locks)) {
+            OPAL_THREAD_UNLOCK(&module->lock);
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+
+        OPAL_LIST_FOREACH(lock, &module->active_locks, ompi_osc_rdma_sync_t) {
+            OBJ_RETAIN(lock);
+            locks[lock_count++] = lock;
+        }
+    }
+    OPAL_THREAD_UNLOCK(&module->lock);
+
     /* globally complete all outstanding rdma requests */
     if (OMPI_OSC_RDMA_SYNC_TYPE_LOCK == module->all_sync.type) {
         ompi_osc_rdma_sync_rdma_complete (&module->all_sync);
+        flushed = true;
     }
 
-    /* flush all locks */
-    ret = opal_hash_table_get_first_key_uint32 (&module->outstanding_locks, &key, (void **) &lock, &node);
-    while (OPAL_SUCCESS == ret) {
-        OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_DEBUG, "flushing lock %p", (void *) lock);
-        ompi_osc_rdma_sync_rdma_complete (lock);
-        ret = opal_hash_table_get_next_key_uint32 (&module->outstanding_locks, &key, (void **) &lock,
-                                                   node, &node);
+    /* flush the targeted locks. operations to all targets progress while waiting on
+     * any one of them so after the first complete only the locks that still have
+     * operations outstanding need to be waited on. */
+    for (int i = 0 ; i < lock_count ; ++i) {
+        lock = locks[i];
+        if (!flushed || ompi_osc_rdma_sync_get_count (lock)) {
+            OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_DEBUG, "flushing lock %p", (void *) lock);
+            ompi_osc_rdma_sync_rdma_complete (lock);
+            flushed = true;
+        }
+
+        OBJ_RELEASE(lock);
     }
 
+    free (locks);
+
     OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "flush_all complete");
 
     return OPAL_SUCCESS;
@@ -110,6 +134,209 @@ int ompi_osc_rdma_flush_local_all (struct ompi_win_t *win)
     return ompi_osc_rdma_flush_all (win);
 }
 
+/* offset of a field of one of the queue nodes in the state structure */
+#define OMPI_OSC_RDMA_QUEUE_NODE_OFFSET(node, field) \
+    (offsetof (ompi_osc_rdma_state_t, queue_nodes) + (node) * sizeof (ompi_osc_rdma_queue_node_t) + \
+     offsetof (ompi_osc_rdma_queue_node_t, field))
+
+static int ompi_osc_rdma_queue_node_alloc (ompi_osc_rdma_module_t *module)
+{
+    int32_t used = module->queue_nodes_used;
+
+    for (int i = 0 ; i < OMPI_OSC_RDMA_QUEUE_NODE_MAX ; ) {
+        if (used & (1 << i)) {
+            ++i;
+        } else if (opal_atomic_compare_exchange_strong_32 (&module->queue_nodes_used, &used, used | (1 << i))) {
+            return i;
+        }
+        /* on failure used was updated, look at the same node again */
+    }
+
+    return -1;
+}
+
+static inline void ompi_osc_rdma_queue_node_free (ompi_osc_rdma_module_t *module, int node)
+{
+    (void) opal_atomic_fetch_and_32 (&module->queue_nodes_used, ~(1 << node));
+}
+
+/**
+ * ompi_osc_rdma_queue_enter:
+ *
+ * @param[in] module - osc/rdma module
+ * @param[in] peer   - target of the exclusive lock
+ * @param[in] node   - queue node of this process to use
+ *
+ * @returns OMPI_SUCCESS on success or another ompi error code on failure
+ *
+ * This function appends this process to the queue of processes waiting for
+ * an exclusive lock on {peer} and returns once it is at the head of the queue.
+ * Only the head of the queue competes for the lock, the other waiters poll
+ * their own queue node in local memory, so each waiter issues a constant
+ * number of remote atomics whatever the contention.
+ */
+static int ompi_osc_rdma_queue_enter (ompi_osc_rdma_module_t *module, ompi_osc_rdma_peer_t *peer, int node)
+{
+    ompi_osc_rdma_queue_node_t *my_node = module->state->queue_nodes + node;
+    ompi_osc_rdma_lock_t me = OMPI_OSC_RDMA_QUEUE_NODE(ompi_comm_rank (module->comm), node);
+    ompi_osc_rdma_lock_t prev;
+    ompi_osc_rdma_peer_t *prev_peer;
+    int ret;
+
+    my_node->next = 0;
+    my_node->locked = 0;
+    opal_atomic_wmb ();
+
+    ret = ompi_osc_rdma_lock_exchange (module, peer, me, offsetof (ompi_osc_rdma_state_t, exclusive_queue), &prev);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != ret) || 0 == prev) {
+        return ret;
+    }
+
+    OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_DEBUG, "waiting for exclusive lock on peer %d behind rank %d", peer->rank,
+                     OMPI_OSC_RDMA_QUEUE_NODE_RANK(prev));
+
+    /* link behind the previous waiter and wait for it to hand the queue over */
+    prev_peer = ompi_osc_rdma_module_peer (module, OMPI_OSC_RDMA_QUEUE_NODE_RANK(prev));
+    ret = ompi_osc_rdma_lock_signal (module, prev_peer, me,
+                                     OMPI_OSC_RDMA_QUEUE_NODE_OFFSET(OMPI_OSC_RDMA_QUEUE_NODE_INDEX(prev), next));
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+        return ret;
+    }
+
+    while (0 == *((volatile ompi_osc_rdma_lock_t *) &my_node->locked)) {
+        ompi_osc_rdma_progress (module);
+    }
+
+    opal_atomic_rmb ();
+
+    return OMPI_SUCCESS;
+}
+
+/**
+ * ompi_osc_rdma_queue_leave:
+ *
+ * @param[in] module - osc/rdma module
+ * @param[in] peer   - target of the exclusive lock
+ * @param[in] node   - queue node of this process
+ *
+ * @returns OMPI_SUCCESS on success or another ompi error code on failure
+ *
+ * This function hands the head of the queue of {peer} over to the next
+ * waiter, if any, and frees the queue node. Must be called after the
+ * exclusive lock was released.
+ */
+static int ompi_osc_rdma_queue_leave (ompi_osc_rdma_module_t *module, ompi_osc_rdma_peer_t *peer, int node)
+{
+    ompi_osc_rdma_queue_node_t *my_node = module->state->queue_nodes + node;
+    ompi_osc_rdma_lock_t me = OMPI_OSC_RDMA_QUEUE_NODE(ompi_comm_rank (module->comm), node);
+    ompi_osc_rdma_lock_t next = *((volatile ompi_osc_rdma_lock_t *) &my_node->next);
+    ompi_osc_rdma_peer_t *next_peer;
+    int ret;
+
+    if (0 == next) {
+        /* empty the queue unless a process is joining it */
+        ret = ompi_osc_rdma_lock_compare_exchange_peer (module, peer, me, 0, offsetof (ompi_osc_rdma_state_t, exclusive_queue));
+        if (1 != ret) {
+            ompi_osc_rdma_queue_node_free (module, node);
+            return ret;
+        }
+
+        while (0 == (next = *((volatile ompi_osc_rdma_lock_t *) &my_node->next))) {
+            ompi_osc_rdma_progress (module);
+        }
+    }
+
+    opal_atomic_rmb ();
+
+    next_peer = ompi_osc_rdma_module_peer (module, OMPI_OSC_RDMA_QUEUE_NODE_RANK(next));
+    ret = ompi_osc_rdma_lock_signal (module, next_peer, 1,
+                                     OMPI_OSC_RDMA_QUEUE_NODE_OFFSET(OMPI_OSC_RDMA_QUEUE_NODE_INDEX(next), locked));
+
+    ompi_osc_rdma_queue_node_free (module, node);
+
+    return ret;
+}
+
+/**
+ * ompi_osc_rdma_global_lock_acquire:
+ *
+ * @param[in] module    - osc/rdma module
+ * @param[in] aggregate - offset of the node aggregate of the count in the state structure
+ * @param[in] value     - increment value
+ * @param[in] check     - check value for success
+ *
+ * @returns OMPI_SUCCESS on success or another ompi error code on failure
+ *
+ * This function takes a count in the global lock of the leader (see
+ * ompi_osc_rdma_lock_acquire_shared). When the counts of the node are
+ * aggregated only the first local holder updates the global lock, the
+ * other processes of the node wait for it in shared memory.
+ */
+static int ompi_osc_rdma_global_lock_acquire (ompi_osc_rdma_module_t *module, ptrdiff_t aggregate,
+                                              ompi_osc_rdma_lock_t value, ompi_osc_rdma_lock_t check)
+{
+    ompi_osc_rdma_node_aggregate_t *node_aggregate;
+    int ret = OMPI_SUCCESS;
+
+    if (NULL == module->node_state) {
+        return ompi_osc_rdma_lock_acquire_shared (module, module->leader, value,
+                                                  offsetof (ompi_osc_rdma_state_t, global_lock), check);
+    }
+
+    node_aggregate = (ompi_osc_rdma_node_aggregate_t *) ((intptr_t) module->node_state + aggregate);
+
+    while (ompi_osc_rdma_trylock_local (&node_aggregate->lock)) {
+        ompi_osc_rdma_progress (module);
+    }
+
+    if (0 == node_aggregate->count) {
+        ret = ompi_osc_rdma_lock_acquire_shared (module, module->leader, value,
+                                                 offsetof (ompi_osc_rdma_state_t, global_lock), check);
+    }
+
+    if (OMPI_SUCCESS == ret) {
+        ++node_aggregate->count;
+    }
+
+    ompi_osc_rdma_unlock_local (&node_aggregate->lock);
+
+    return ret;
+}
+
+/**
+ * ompi_osc_rdma_global_lock_release:
+ *
+ * @param[in] module    - osc/rdma module
+ * @param[in] aggregate - offset of the node aggregate of the count in the state structure
+ * @param[in] value     - decrement value
+ *
+ * This function releases a count taken with ompi_osc_rdma_global_lock_acquire.
+ */
+static void ompi_osc_rdma_global_lock_release (ompi_osc_rdma_module_t *module, ptrdiff_t aggregate,
+                                               ompi_osc_rdma_lock_t value)
+{
+    ompi_osc_rdma_node_aggregate_t *node_aggregate;
+
+    if (NULL == module->node_state) {
+        (void) ompi_osc_rdma_lock_release_shared (module, module->leader, value,
+                                                  offsetof (ompi_osc_rdma_state_t, global_lock));
+        return;
+    }
+
+    node_aggregate = (ompi_osc_rdma_node_aggregate_t *) ((intptr_t) module->node_state + aggregate);
+
+    while (ompi_osc_rdma_trylock_local (&node_aggregate->lock)) {
+        ompi_osc_rdma_progress (module);
+    }
+
+    if (0 == --node_aggregate->count) {
+        (void) ompi_osc_rdma_lock_release_shared (module, module->leader, value,
+                                                  offsetof (ompi_osc_rdma_state_t, global_lock));
+    }
+
+    ompi_osc_rdma_unlock_local (&node_aggregate->lock);
+}
+
 /* locking via atomics */
 static inline int ompi_osc_rdma_lock_atomic_internal (ompi_osc_rdma_module_t *module, ompi_osc_rdma_peer_t *peer,
                                                       ompi_osc_rdma_sync_t *lock)
@@ -118,11 +345,25 @@ static inline int ompi_osc_rdma_lock_atomic_internal (ompi_osc_rdma_module_t *mo
     int ret;
 
     if (MPI_LOCK_EXCLUSIVE == lock->sync.lock.type) {
+        if (module->exclusive_lock_queue) {
+            /* wait for the processes ahead of this one. without a free queue node compete for
+             * the lock directly, which is still safe as the lock itself enforces exclusion */
+            lock->sync.lock.queue_node = ompi_osc_rdma_queue_node_alloc (module);
+            if (0 <= lock->sync.lock.queue_node) {
+                ret = ompi_osc_rdma_queue_enter (module, peer, lock->sync.lock.queue_node);
+                if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+                    ompi_osc_rdma_queue_node_free (module, lock->sync.lock.queue_node);
+                    lock->sync.lock.queue_node = -1;
+                    return ret;
+                }
+            }
+        }
+
         do {
             OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_DEBUG, "incrementing global exclusive lock");
             if (OMPI_OSC_RDMA_LOCKING_TWO_LEVEL == locking_mode) {
                 /* lock the master lock. this requires no rank has a global shared lock */
-                ret = ompi_osc_rdma_lock_acquire_shared (module, module->leader, 1, offsetof (ompi_osc_rdma_state_t, global_lock),
+                ret = ompi_osc_rdma_global_lock_acquire (module, offsetof (ompi_osc_rdma_state_t, node_exclusive), 1,
                                                          0xffffffff00000000L);
                 if (OMPI_SUCCESS != ret) {
                     ompi_osc_rdma_progress (module);
@@ -135,7 +376,7 @@ static inline int ompi_osc_rdma_lock_atomic_internal (ompi_osc_rdma_module_t *mo
             if (ret) {
                 /* release the global lock */
                 if (OMPI_OSC_RDMA_LOCKING_TWO_LEVEL == locking_mode) {
-                    ompi_osc_rdma_lock_release_shared (module, module->leader, -1, offsetof (ompi_osc_rdma_state_t, global_lock));
+                    ompi_osc_rdma_global_lock_release (module, offsetof (ompi_osc_rdma_state_t, node_exclusive), -1);
                 }
                 ompi_osc_rdma_progress (module);
                 continue;
@@ -172,7 +413,13 @@ static inline int ompi_osc_rdma_unlock_atomic_internal (ompi_osc_rdma_module_t *
 
         if (OMPI_OSC_RDMA_LOCKING_TWO_LEVEL == locking_mode) {
             OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_DEBUG, "decrementing global exclusive lock");
-            ompi_osc_rdma_lock_release_shared (module, module->leader, -1, offsetof (ompi_osc_rdma_state_t, global_lock));
+            ompi_osc_rdma_global_lock_release (module, offsetof (ompi_osc_rdma_state_t, node_exclusive), -1);
+        }
+
+        if (0 <= lock->sync.lock.queue_node) {
+            /* let the next waiter in */
+            (void) ompi_osc_rdma_queue_leave (module, peer, lock->sync.lock.queue_node);
+            lock->sync.lock.queue_node = -1;
         }
 
         peer->flags &= ~OMPI_OSC_RDMA_PEER_EXCLUSIVE;
@@ -239,6 +486,7 @@ int ompi_osc_rdma_lock_atomic (int lock_type, int target, int assert, ompi_win_t
     lock->sync.lock.target = target;
     lock->sync.lock.type = lock_type;
     lock->sync.lock.assert = assert;
+    lock->sync.lock.queue_node = -1;
 
     lock->peer_list.peer = peer;
     lock->num_peers = 1;
@@ -351,9 +599,8 @@ int ompi_osc_rdma_lock_all_atomic (int assert, struct ompi_win_t *win)
     if (0 == (assert & MPI_MODE_NOCHECK)) {
         /* increment the global shared lock */
         if (OMPI_OSC_RDMA_LOCKING_TWO_LEVEL == module->locking_mode) {
-            ret = ompi_osc_rdma_lock_acquire_shared (module, module->leader, 0x0000000100000000UL,
-                                                     offsetof(ompi_osc_rdma_state_t, global_lock),
-                                                     0x00000000ffffffffUL);
+            ret = ompi_osc_rdma_global_lock_acquire (module, offsetof (ompi_osc_rdma_state_t, node_lock_all),
+                                                     0x0000000100000000UL, 0x00000000ffffffffUL);
         } else {
             /* always lock myself */
             ret = ompi_osc_rdma_demand_lock_peer (module, module->my_peer);
@@ -407,8 +654,8 @@ int ompi_osc_rdma_unlock_all_atomic (struct ompi_win_t *win)
             }
         } else {
             /* decrement the master lock shared count */
-            (void) ompi_osc_rdma_lock_release_shared (module, module->leader, -0x0000000100000000UL,
-                                                      offsetof (ompi_osc_rdma_state_t, global_lock));
+            ompi_osc_rdma_global_lock_release (module, offsetof (ompi_osc_rdma_state_t, node_lock_all),
+                                               -0x0000000100000000UL);
         }
     }
 
@@ -27,7 +27,7 @@ static void ompi_osc_rdma_sync_destructor (ompi_osc_rdma_sync_t *rdma_sync)
     OBJ_DESTRUCT(&rdma_sync->demand_locked_peers);
 }
 
-OBJ_CLASS_INSTANCE(ompi_osc_rdma_sync_t, opal_object_t, ompi_osc_rdma_sync_constructor,
+OBJ_CLASS_INSTANCE(ompi_osc_rdma_sync_t, opal_list_item_t, ompi_osc_rdma_sync_constructor,
                    ompi_osc_rdma_sync_destructor);
 
 ompi_osc_rdma_sync_t *ompi_osc_rdma_sync_allocate (struct ompi_osc_rdma_module_t *module)
@@ -46,7 +46,8 @@ typedef struct ompi_osc_rdma_sync_aligned_counter_t ompi_osc_rdma_sync_aligned_c
  * This structure holds information about an access epoch.
  */
 struct ompi_osc_rdma_sync_t {
-    opal_object_t super;
+    /** list item. targeted locks are kept on the module's list of active locks */
+    opal_list_item_t super;
 
     /** osc rdma module */
     struct ompi_osc_rdma_module_t *module;
@@ -68,6 +69,9 @@ struct ompi_osc_rdma_sync_t {
              * only uses 5-bits for asserts. if this number goes over 16 this
              * will need to be changed to accomodate. */
             int16_t assert;
+
+            /** queue node used to wait for an exclusive lock (-1 if none) */
+            int16_t queue_node;
         } lock;
 
         /** post/start/complete/wait specific synchronization data */
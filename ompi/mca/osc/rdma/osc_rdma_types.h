@@ -69,6 +69,17 @@ static inline int ompi_osc_rdma_lock_compare_exchange (opal_atomic_int64_t *p, i
     return ret;
 }
 
+static inline int64_t ompi_osc_rdma_lock_swap (opal_atomic_int64_t *p, int64_t value)
+{
+    int64_t old;
+
+    opal_atomic_mb ();
+    old = opal_atomic_swap_64 (p, value);
+    opal_atomic_mb ();
+
+    return old;
+}
+
 #else
 
 #define OMPI_OSC_RDMA_LOCK_EXCLUSIVE 0x80000000l
@@ -99,6 +110,17 @@ static inline int ompi_osc_rdma_lock_compare_exchange (opal_atomic_int32_t *p, i
     return ret;
 }
 
+static inline int32_t ompi_osc_rdma_lock_swap (opal_atomic_int32_t *p, int32_t value)
+{
+    int32_t old;
+
+    opal_atomic_mb ();
+    old = opal_atomic_swap_32 (p, value);
+    opal_atomic_mb ();
+
+    return old;
+}
+
 #endif /* OPAL_HAVE_ATOMIC_MATH_64 */
 
 /**
@@ -158,6 +180,51 @@ OBJ_CLASS_DECLARATION(ompi_osc_rdma_handle_t);
  */
 #define OMPI_OSC_RDMA_POST_PEER_MAX 32
 
+/**
+ * @brief number of queue nodes each process has for the exclusive lock
+ *        queues.
+ *
+ * A process needs one node for each exclusive lock it holds or waits for.
+ * Locks requested while all the nodes are in use skip the queue and
+ * compete for the lock directly.
+ */
+#define OMPI_OSC_RDMA_QUEUE_NODE_MAX 16
+
+/**
+ * @brief encode a queue node as stored in a queue tail or a next pointer.
+ *        0 is the empty queue.
+ */
+#define OMPI_OSC_RDMA_QUEUE_NODE(rank, node) ((((ompi_osc_rdma_lock_t) (rank) + 1) << 8) | (node))
+#define OMPI_OSC_RDMA_QUEUE_NODE_RANK(value) ((int) ((value) >> 8) - 1)
+#define OMPI_OSC_RDMA_QUEUE_NODE_INDEX(value) ((int) ((value) & 0xff))
+
+/**
+ * @brief node of the (MCS) queue of processes waiting for an exclusive lock
+ */
+struct ompi_osc_rdma_queue_node_t {
+    /** next process in the queue, written by the successor */
+    ompi_osc_rdma_lock_t next;
+    /** set by the predecessor when it hands the head of the queue over */
+    ompi_osc_rdma_lock_t locked;
+};
+typedef struct ompi_osc_rdma_queue_node_t ompi_osc_rdma_queue_node_t;
+
+/**
+ * @brief node-level aggregation of a count in the global lock
+ *
+ * Only the state of the first process of each node is used. The first local
+ * process taking a count updates the global lock on behalf of the node and
+ * the last one releases it, so the global leader sees at most one process
+ * per node. Only updated with processor atomics.
+ */
+struct ompi_osc_rdma_node_aggregate_t {
+    /** protects the count and the update of the global lock */
+    ompi_osc_rdma_lock_t lock;
+    /** local holders of the count */
+    ompi_osc_rdma_lock_t count;
+};
+typedef struct ompi_osc_rdma_node_aggregate_t ompi_osc_rdma_node_aggregate_t;
+
 /**
  * @brief window state structure
  *
@@ -173,6 +240,14 @@ struct ompi_osc_rdma_state_t {
     ompi_osc_rdma_lock_t local_lock;
     /** lock for the accumulate state to ensure ordering and consistency */
     ompi_osc_rdma_lock_t accumulate_lock;
+    /** tail of the queue of processes waiting for an exclusive lock on this process */
+    ompi_osc_rdma_lock_t exclusive_queue;
+    /** queue nodes of this process */
+    ompi_osc_rdma_queue_node_t queue_nodes[OMPI_OSC_RDMA_QUEUE_NODE_MAX];
+    /** node aggregation of the exclusive count of the global lock */
+    ompi_osc_rdma_node_aggregate_t node_exclusive;
+    /** node aggregation of the lock_all count of the global lock */
+    ompi_osc_rdma_node_aggregate_t node_lock_all;
     /** current index to post to. compare-and-swap must be used to ensure
      * the index is free */
     osc_rdma_counter_t post_index;
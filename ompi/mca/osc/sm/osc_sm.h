@@ -18,6 +18,15 @@
 
 #include "opal/mca/shmem/base/base.h"
 
+#if defined(HAVE_LINUX_FUTEX_H) && defined(HAVE_SYS_SYSCALL_H)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define OSC_SM_HAVE_FUTEX 1
+#else
+#define OSC_SM_HAVE_FUTEX 0
+#endif
+
 #if OPAL_HAVE_ATOMIC_MATH_64
 
 typedef uint64_t osc_sm_post_type_t;
@@ -34,9 +43,13 @@ typedef opal_atomic_uint32_t osc_sm_post_atomic_type_t;
 
 #endif
 
+/* rounds of the dissemination fence, enough for any communicator size */
+#define OSC_SM_FENCE_ROUNDS 32
+
 /* data shared across all peers */
 struct ompi_osc_sm_global_state_t {
     int use_barrier_for_fence;
+    int use_flags_for_fence;
 
     pthread_mutex_t mtx;
     pthread_cond_t cond;
@@ -61,10 +74,27 @@ struct ompi_osc_sm_node_state_t {
 };
 typedef struct ompi_osc_sm_node_state_t ompi_osc_sm_node_state_t;
 
+/* synchronization flags of a peer, written by the others, on cache lines of
+ * their own so that the peers do not poll each other's lines */
+struct ompi_osc_sm_sync_state_t {
+    /* epoch of the last fence signaled to this peer in each round */
+    opal_atomic_int32_t fence[OSC_SM_FENCE_ROUNDS];
+    /* set while this peer sleeps on one of its flags */
+    opal_atomic_int32_t sleeping;
+    char padding[64 - sizeof (opal_atomic_int32_t)];
+};
+typedef struct ompi_osc_sm_sync_state_t ompi_osc_sm_sync_state_t;
+
 struct ompi_osc_sm_component_t {
     ompi_osc_base_component_t super;
 
     char *backing_directory;
+    bool acc_use_amo;
+    bool fence_use_flags;
+    int sync_spin_count;
+    bool numa_placement;
+    bool huge_pages;
+    size_t huge_page_size;
 };
 typedef struct ompi_osc_sm_component_t ompi_osc_sm_component_t;
 OMPI_DECLSPEC extern ompi_osc_sm_component_t mca_osc_sm_component;
@@ -83,6 +113,9 @@ struct ompi_osc_sm_module_t {
     opal_shmem_ds_t seg_ds;
     void *segment_base;
     bool noncontig;
+    bool acc_use_amo;
+    bool numa_placement;
+    bool huge_pages;
 
     size_t *sizes;
     void **bases;
@@ -92,6 +125,7 @@ struct ompi_osc_sm_module_t {
     ompi_group_t *post_group;
 
     int my_sense;
+    int32_t fence_epoch;
 
     enum ompi_osc_sm_locktype_t *outstanding_locks;
 
@@ -99,6 +133,7 @@ struct ompi_osc_sm_module_t {
     ompi_osc_sm_global_state_t *global_state;
     ompi_osc_sm_node_state_t *my_node_state;
     ompi_osc_sm_node_state_t *node_states;
+    ompi_osc_sm_sync_state_t *sync_states;
 
     osc_sm_post_atomic_type_t **posts;
 
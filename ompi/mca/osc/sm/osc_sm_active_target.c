@@ -22,6 +22,103 @@
 
 #include "osc_sm.h"
 
+#if OSC_SM_HAVE_FUTEX
+#include <limits.h>
+#include <time.h>
+#endif
+
+/* how long a sleeping process waits before it progresses again */
+#define OSC_SM_SYNC_SLEEP_NS 1000000
+
+/**
+ * Wait until a 32-bit synchronization word of the segment reaches value.
+ *
+ * The word is polled for sync_spin_count iterations, calling opal_progress
+ * now and then, after which the process sleeps on it in the kernel with
+ * a timeout so that it keeps progressing the other requests. The writers
+ * wake it through ompi_osc_sm_sync_wake. Words only grow, modulo the
+ * wraparound, while a process waits on them.
+ */
+static void ompi_osc_sm_sync_wait (ompi_osc_sm_sync_state_t *my_sync, opal_atomic_int32_t *word, int32_t value)
+{
+    int32_t current;
+
+    for (int i = 0 ; ; ++i) {
+        current = *word;
+        if ((int32_t) ((uint32_t) current - (uint32_t) value) >= 0) {
+            break;
+        }
+
+#if OSC_SM_HAVE_FUTEX
+        if (i >= mca_osc_sm_component.sync_spin_count) {
+            struct timespec timeout = {.tv_sec = 0, .tv_nsec = OSC_SM_SYNC_SLEEP_NS};
+
+            my_sync->sleeping = 1;
+            opal_atomic_mb ();
+            if (current == *word) {
+                /* not private: the writers are other processes */
+                (void) syscall (SYS_futex, word, FUTEX_WAIT, current, &timeout, NULL, 0);
+            }
+            my_sync->sleeping = 0;
+            opal_progress ();
+            continue;
+        }
+#endif
+
+        if (0 == (i & 0x3f)) {
+            opal_progress ();
+        }
+        opal_atomic_rmb ();
+    }
+
+    opal_atomic_rmb ();
+}
+
+/**
+ * Wake the peer owning sync if it sleeps on word. Must follow the update of
+ * the word.
+ */
+static inline void ompi_osc_sm_sync_wake (ompi_osc_sm_sync_state_t *sync, opal_atomic_int32_t *word)
+{
+    opal_atomic_mb ();
+#if OSC_SM_HAVE_FUTEX
+    if (sync->sleeping) {
+        (void) syscall (SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+#endif
+}
+
+/**
+ * Fence on the flags of the segment: a dissemination barrier in which, in
+ * round k, every process signals the process 2^k ranks after it and waits
+ * for the one 2^k ranks before it. Each process only writes the flags of
+ * its partners and polls its own, which are on cache lines of their own,
+ * and the epoch stored in the flags replaces the sense reversal. A process
+ * cannot leave a fence before all the others entered it, so a flag is never
+ * overwritten with a new epoch before its owner read the previous one.
+ */
+static int ompi_osc_sm_fence_flags (ompi_osc_sm_module_t *module)
+{
+    int size = ompi_comm_size (module->comm), rank = ompi_comm_rank (module->comm);
+    ompi_osc_sm_sync_state_t *my_sync = module->sync_states + rank;
+    int32_t epoch = (int32_t) ((uint32_t) module->fence_epoch + 1);
+
+    module->fence_epoch = epoch;
+
+    for (int round = 0, distance = 1 ; distance < size ; ++round, distance <<= 1) {
+        ompi_osc_sm_sync_state_t *peer = module->sync_states + (rank + distance) % size;
+
+        peer->fence[round] = epoch;
+        ompi_osc_sm_sync_wake (peer, peer->fence + round);
+
+        ompi_osc_sm_sync_wait (my_sync, my_sync->fence + round, epoch);
+    }
+
+    opal_atomic_mb ();
+
+    return OMPI_SUCCESS;
+}
+
 /**
  * compare_ranks:
  *
@@ -100,7 +197,9 @@ ompi_osc_sm_fence(int assert, struct ompi_win_t *win)
     /* ensure all memory operations have completed */
     opal_atomic_mb();
 
-    if (module->global_state->use_barrier_for_fence) {
+    if (module->global_state->use_flags_for_fence) {
+        return ompi_osc_sm_fence_flags (module);
+    } else if (module->global_state->use_barrier_for_fence) {
         return module->comm->c_coll->coll_barrier(module->comm,
                                                  module->comm->c_coll->coll_barrier_module);
     } else {
@@ -202,6 +301,7 @@ ompi_osc_sm_complete(struct ompi_win_t *win)
     gsize = ompi_group_size(group);
     for (int i = 0 ; i < gsize ; ++i) {
         (void) opal_atomic_add_fetch_32(&module->node_states[ranks[i]].complete_count, 1);
+        ompi_osc_sm_sync_wake (module->sync_states + ranks[i], &module->node_states[ranks[i]].complete_count);
     }
 
     free (ranks);
@@ -285,10 +385,8 @@ ompi_osc_sm_wait(struct ompi_win_t *win)
 
     int size = ompi_group_size (group);
 
-    while (module->my_node_state->complete_count != size) {
-        opal_progress();
-        opal_atomic_mb();
-    }
+    ompi_osc_sm_sync_wait (module->sync_states + ompi_comm_rank (module->comm),
+                           &module->my_node_state->complete_count, size);
 
     OBJ_RELEASE(group);
     module->post_group = NULL;
@@ -18,8 +18,235 @@
 #include "ompi/mca/osc/base/base.h"
 #include "ompi/mca/osc/base/osc_base_obj_convert.h"
 
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype_internal.h"
+
 #include "osc_sm.h"
 
+/* origin and result data staged on the stack by the atomic path */
+#define OSC_SM_ATOMIC_STAGING 512
+#define OSC_SM_ATOMIC_IOVEC   32
+
+/* the primitive datatypes whose integer operations map to processor atomics */
+#define OSC_SM_NATIVE_INT32 ((1 << OPAL_DATATYPE_INT4) | (1 << OPAL_DATATYPE_UINT4))
+#define OSC_SM_NATIVE_INT64 ((1 << OPAL_DATATYPE_INT8) | (1 << OPAL_DATATYPE_UINT8))
+
+/**
+ * Return the primitive datatype of an accumulate that can be done with
+ * processor atomics, or NULL if it has to take the accumulate lock.
+ *
+ * The choice depends only on the primitive datatype, never on the counts or
+ * the layouts, so all the accumulates to a location take the same path and
+ * stay atomic with respect to each other whatever the accumulate_ops and
+ * accumulate_ordering of the window. An origin built from another primitive
+ * datatype (erroneous for MPI, which requires the same basic type on both
+ * sides) cannot be staged for the atomics and takes the lock as well.
+ */
+static inline ompi_datatype_t *
+ompi_osc_sm_atomic_type (ompi_osc_sm_module_t *module, ompi_datatype_t *origin_dt,
+                         ompi_datatype_t *dt, ompi_op_t *op)
+{
+    ompi_datatype_t *prim;
+
+    if (!module->acc_use_amo || !ompi_op_is_intrinsic (op)) {
+        return NULL;
+    }
+
+    prim = ompi_datatype_is_predefined (dt) ? dt : ompi_datatype_get_single_predefined_type_from_args (dt);
+    if (NULL == prim) {
+        return NULL;
+    }
+
+    if (op != &ompi_mpi_op_no_op.op && origin_dt != prim &&
+        prim != ompi_datatype_get_single_predefined_type_from_args (origin_dt)) {
+        return NULL;
+    }
+
+    switch (prim->super.size) {
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_32
+    case 4:
+#endif
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_64
+    case 8:
+#endif
+        return prim;
+    default:
+        return NULL;
+    }
+}
+
+#define OSC_SM_ATOMIC_ELEMENTS(bits)                                    \
+    do {                                                                \
+        opal_atomic_int ## bits ## _t *addr = (opal_atomic_int ## bits ## _t *) target; \
+        int ## bits ## _t value = 0, old, tmp;                          \
+                                                                        \
+        for (size_t i = 0 ; i < count ; ++i, ++addr) {                  \
+            if (NULL != origin) {                                       \
+                memcpy (&value, origin + i * sizeof (value), sizeof (value)); \
+            }                                                           \
+            if (op == &ompi_mpi_op_no_op.op) {                          \
+                old = *addr;                                            \
+            } else if (op == &ompi_mpi_op_replace.op) {                 \
+                old = opal_atomic_swap_ ## bits (addr, value);          \
+            } else if (native && op == &ompi_mpi_op_sum.op) {           \
+                old = opal_atomic_fetch_add_ ## bits (addr, value);     \
+            } else if (native && op == &ompi_mpi_op_band.op) {          \
+                old = opal_atomic_fetch_and_ ## bits (addr, value);     \
+            } else if (native && op == &ompi_mpi_op_bor.op) {           \
+                old = opal_atomic_fetch_or_ ## bits (addr, value);      \
+            } else if (native && op == &ompi_mpi_op_bxor.op) {          \
+                old = opal_atomic_fetch_xor_ ## bits (addr, value);     \
+            } else {                                                    \
+                /* everything else, floating point included */          \
+                old = *addr;                                            \
+                do {                                                    \
+                    tmp = old;                                          \
+                    ompi_op_reduce (op, &value, &tmp, 1, prim);         \
+                } while (!opal_atomic_compare_exchange_strong_ ## bits (addr, &old, tmp)); \
+            }                                                           \
+            if (NULL != result) {                                       \
+                memcpy (result + i * sizeof (old), &old, sizeof (old)); \
+            }                                                           \
+        }                                                               \
+    } while (0)
+
+/**
+ * Apply op to count contiguous elements of the target, one processor atomic
+ * per element. Elements that are not naturally aligned cannot be updated
+ * atomically and are done under the accumulate lock instead, which is
+ * consistent as the alignment of a location never changes.
+ */
+static void
+ompi_osc_sm_atomic_elements (ompi_osc_sm_module_t *module, int target_rank, ompi_op_t *op,
+                             ompi_datatype_t *prim, const char *origin, char *result,
+                             char *target, size_t count)
+{
+    size_t size = prim->super.size;
+    bool native;
+
+    if (OPAL_UNLIKELY(0 != ((uintptr_t) target & (size - 1)))) {
+        opal_atomic_lock(&module->node_states[target_rank].accumulate_lock);
+        if (NULL != result) {
+            memcpy (result, target, count * size);
+        }
+        if (op == &ompi_mpi_op_replace.op) {
+            memcpy (target, origin, count * size);
+        } else if (op != &ompi_mpi_op_no_op.op) {
+            ompi_op_reduce (op, (void *) origin, target, count, prim);
+        }
+        opal_atomic_unlock(&module->node_states[target_rank].accumulate_lock);
+        return;
+    }
+
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_32
+    if (4 == size) {
+        native = (0 == (prim->super.bdt_used & ~OSC_SM_NATIVE_INT32));
+        OSC_SM_ATOMIC_ELEMENTS(32);
+        return;
+    }
+#endif
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_64
+    native = (0 == (prim->super.bdt_used & ~OSC_SM_NATIVE_INT64));
+    OSC_SM_ATOMIC_ELEMENTS(64);
+#endif
+}
+
+/**
+ * Accumulate, and fetch when result_addr is not NULL, with processor
+ * atomics. The origin and the result are staged as contiguous arrays of the
+ * primitive datatype, the target is walked region by region.
+ */
+static int
+ompi_osc_sm_atomic_accumulate (ompi_osc_sm_module_t *module, int target, ompi_datatype_t *prim,
+                               const void *origin_addr, int origin_count, ompi_datatype_t *origin_dt,
+                               void *result_addr, int result_count, ompi_datatype_t *result_dt,
+                               void *remote_address, int target_count, ompi_datatype_t *target_dt,
+                               ompi_op_t *op)
+{
+    char origin_staging[OSC_SM_ATOMIC_STAGING], result_staging[OSC_SM_ATOMIC_STAGING];
+    char *origin = NULL, *result = NULL;
+    size_t prim_size = prim->super.size, size, count;
+    int ret = OMPI_SUCCESS;
+
+    ompi_datatype_type_size (target_dt, &size);
+    size *= (size_t) target_count;
+    count = size / prim_size;
+    if (0 == count) {
+        return OMPI_SUCCESS;
+    }
+
+    if (op != &ompi_mpi_op_no_op.op) {
+        if (origin_dt == prim) {
+            origin = (char *) origin_addr;
+        } else {
+            /* ompi_osc_sm_atomic_type checked the origin is made of prim */
+            origin = (size <= OSC_SM_ATOMIC_STAGING) ? origin_staging : malloc (size);
+            if (OPAL_UNLIKELY(NULL == origin)) {
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
+            ret = ompi_datatype_sndrcv ((void *) origin_addr, origin_count, origin_dt,
+                                        origin, (int) count, prim);
+            if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+                goto done;
+            }
+        }
+    }
+
+    if (NULL != result_addr) {
+        if (result_dt == prim) {
+            result = (char *) result_addr;
+        } else {
+            result = (size <= OSC_SM_ATOMIC_STAGING) ? result_staging : malloc (size);
+            if (OPAL_UNLIKELY(NULL == result)) {
+                ret = OMPI_ERR_OUT_OF_RESOURCE;
+                goto done;
+            }
+        }
+    }
+
+    if (ompi_datatype_is_predefined (target_dt)) {
+        ompi_osc_sm_atomic_elements (module, target, op, prim, origin, result,
+                                     (char *) remote_address, count);
+    } else {
+        struct iovec iov[OSC_SM_ATOMIC_IOVEC];
+        opal_convertor_t convertor;
+        size_t offset = 0, length;
+        uint32_t iov_count;
+        bool last;
+
+        OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+        opal_convertor_copy_and_prepare_for_recv (ompi_mpi_local_convertor, &target_dt->super,
+                                                  target_count, remote_address, 0, &convertor);
+        do {
+            iov_count = OSC_SM_ATOMIC_IOVEC;
+            last = opal_convertor_raw (&convertor, iov, &iov_count, &length);
+            for (uint32_t i = 0 ; i < iov_count ; ++i) {
+                ompi_osc_sm_atomic_elements (module, target, op, prim,
+                                             origin ? origin + offset : NULL,
+                                             result ? result + offset : NULL,
+                                             (char *) iov[i].iov_base, iov[i].iov_len / prim_size);
+                offset += iov[i].iov_len;
+            }
+        } while (!last);
+        opal_convertor_cleanup (&convertor);
+        OBJ_DESTRUCT(&convertor);
+    }
+
+    if (NULL != result && result != (char *) result_addr) {
+        ret = ompi_datatype_sndrcv (result, (int) count, prim, result_addr, result_count, result_dt);
+    }
+
+ done:
+    if (NULL != origin && origin != origin_staging && origin != (char *) origin_addr) {
+        free (origin);
+    }
+    if (NULL != result && result != result_staging && result != (char *) result_addr) {
+        free (result);
+    }
+
+    return ret;
+}
+
 int
 ompi_osc_sm_rput(const void *origin_addr,
                  int origin_count,
@@ -115,6 +342,7 @@ ompi_osc_sm_raccumulate(const void *origin_addr,
     int ret;
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
+    ompi_datatype_t *prim;
     void *remote_address;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
@@ -127,16 +355,22 @@ ompi_osc_sm_raccumulate(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
-    opal_atomic_lock(&module->node_states[target].accumulate_lock);
-    if (op == &ompi_mpi_op_replace.op) {
-        ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
-                                    remote_address, target_count, target_dt);
+    prim = ompi_osc_sm_atomic_type(module, origin_dt, target_dt, op);
+    if (NULL != prim) {
+        ret = ompi_osc_sm_atomic_accumulate(module, target, prim, origin_addr, origin_count, origin_dt,
+                                            NULL, 0, NULL, remote_address, target_count, target_dt, op);
     } else {
-        ret = ompi_osc_base_sndrcv_op(origin_addr, origin_count, origin_dt,
-                                      remote_address, target_count, target_dt,
-                                      op);
+        opal_atomic_lock(&module->node_states[target].accumulate_lock);
+        if (op == &ompi_mpi_op_replace.op) {
+            ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
+                                        remote_address, target_count, target_dt);
+        } else {
+            ret = ompi_osc_base_sndrcv_op(origin_addr, origin_count, origin_dt,
+                                          remote_address, target_count, target_dt,
+                                          op);
+        }
+        opal_atomic_unlock(&module->node_states[target].accumulate_lock);
     }
-    opal_atomic_unlock(&module->node_states[target].accumulate_lock);
 
     /* the only valid field of RMA request status is the MPI_ERROR field.
      * ompi_request_empty has status MPI_SUCCESS and indicates the request is
@@ -166,6 +400,7 @@ ompi_osc_sm_rget_accumulate(const void *origin_addr,
     int ret;
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
+    ompi_datatype_t *prim;
     void *remote_address;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
@@ -178,6 +413,14 @@ ompi_osc_sm_rget_accumulate(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
+    prim = ompi_osc_sm_atomic_type(module, origin_dt, target_dt, op);
+    if (NULL != prim) {
+        ret = ompi_osc_sm_atomic_accumulate(module, target, prim, origin_addr, origin_count, origin_dt,
+                                            result_addr, result_count, result_dt, remote_address,
+                                            target_count, target_dt, op);
+        goto atomic_done;
+    }
+
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
 
     ret = ompi_datatype_sndrcv(remote_address, target_count, target_dt,
@@ -196,6 +439,7 @@ ompi_osc_sm_rget_accumulate(const void *origin_addr,
  done:
     opal_atomic_unlock(&module->node_states[target].accumulate_lock);
 
+ atomic_done:
     /* the only valid field of RMA request status is the MPI_ERROR field.
      * ompi_request_empty has status MPI_SUCCESS and indicates the request is
      * complete. */
@@ -281,6 +525,7 @@ ompi_osc_sm_accumulate(const void *origin_addr,
     int ret;
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
+    ompi_datatype_t *prim;
     void *remote_address;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
@@ -293,16 +538,22 @@ ompi_osc_sm_accumulate(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
-    opal_atomic_lock(&module->node_states[target].accumulate_lock);
-    if (op == &ompi_mpi_op_replace.op) {
-        ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
-                                    remote_address, target_count, target_dt);
+    prim = ompi_osc_sm_atomic_type(module, origin_dt, target_dt, op);
+    if (NULL != prim) {
+        ret = ompi_osc_sm_atomic_accumulate(module, target, prim, origin_addr, origin_count, origin_dt,
+                                            NULL, 0, NULL, remote_address, target_count, target_dt, op);
     } else {
-        ret = ompi_osc_base_sndrcv_op(origin_addr, origin_count, origin_dt,
-                                      remote_address, target_count, target_dt,
-                                      op);
+        opal_atomic_lock(&module->node_states[target].accumulate_lock);
+        if (op == &ompi_mpi_op_replace.op) {
+            ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
+                                        remote_address, target_count, target_dt);
+        } else {
+            ret = ompi_osc_base_sndrcv_op(origin_addr, origin_count, origin_dt,
+                                          remote_address, target_count, target_dt,
+                                          op);
+        }
+        opal_atomic_unlock(&module->node_states[target].accumulate_lock);
     }
-    opal_atomic_unlock(&module->node_states[target].accumulate_lock);
 
     return ret;
 }
@@ -325,6 +576,7 @@ ompi_osc_sm_get_accumulate(const void *origin_addr,
     int ret;
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
+    ompi_datatype_t *prim;
     void *remote_address;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
@@ -337,6 +589,14 @@ ompi_osc_sm_get_accumulate(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
+    prim = ompi_osc_sm_atomic_type(module, origin_dt, target_dt, op);
+    if (NULL != prim) {
+        ret = ompi_osc_sm_atomic_accumulate(module, target, prim, origin_addr, origin_count, origin_dt,
+                                            result_addr, result_count, result_dt, remote_address,
+                                            target_count, target_dt, op);
+        goto atomic_done;
+    }
+
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
 
     ret = ompi_datatype_sndrcv(remote_address, target_count, target_dt,
@@ -355,6 +615,7 @@ ompi_osc_sm_get_accumulate(const void *origin_addr,
  done:
     opal_atomic_unlock(&module->node_states[target].accumulate_lock);
 
+ atomic_done:
     return ret;
 }
 
@@ -383,6 +644,31 @@ ompi_osc_sm_compare_and_swap(const void *origin_addr,
 
     ompi_datatype_type_size(dt, &size);
 
+    /* same test as the accumulates, any op will do */
+    if (NULL != ompi_osc_sm_atomic_type(module, dt, dt, &ompi_mpi_op_replace.op) &&
+        0 == ((uintptr_t) remote_address & (size - 1))) {
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_32
+        if (4 == size) {
+            int32_t old, value;
+            memcpy (&old, compare_addr, sizeof (old));
+            memcpy (&value, origin_addr, sizeof (value));
+            (void) opal_atomic_compare_exchange_strong_32 ((opal_atomic_int32_t *) remote_address, &old, value);
+            memcpy (result_addr, &old, sizeof (old));
+            return OMPI_SUCCESS;
+        }
+#endif
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_64
+        if (8 == size) {
+            int64_t old, value;
+            memcpy (&old, compare_addr, sizeof (old));
+            memcpy (&value, origin_addr, sizeof (value));
+            (void) opal_atomic_compare_exchange_strong_64 ((opal_atomic_int64_t *) remote_address, &old, value);
+            memcpy (result_addr, &old, sizeof (old));
+            return OMPI_SUCCESS;
+        }
+#endif
+    }
+
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
 
     /* fetch */
@@ -421,6 +707,12 @@ ompi_osc_sm_fetch_and_op(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
+    if (NULL != ompi_osc_sm_atomic_type(module, dt, dt, op)) {
+        ompi_osc_sm_atomic_elements(module, target, op, dt, origin_addr, result_addr,
+                                    remote_address, 1);
+        return OMPI_SUCCESS;
+    }
+
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
 
     /* fetch */
@@ -30,6 +30,9 @@
 #include "opal/include/opal/align.h"
 #include "opal/util/info_subscriber.h"
 #include "opal/util/printf.h"
+#include "opal/mca/hwloc/base/base.h"
+
+#include <sys/mman.h>
 
 #include "osc_sm.h"
 
@@ -45,6 +48,8 @@ static int component_select(struct ompi_win_t *win, void **base, size_t size, in
                             int flavor, int *model);
 static char* component_set_blocking_fence_info(opal_infosubscriber_t *obj, char *key, char *val);
 static char* component_set_alloc_shared_noncontig_info(opal_infosubscriber_t *obj, char *key, char *val);
+static char* component_set_alloc_shared_numa_info(opal_infosubscriber_t *obj, char *key, char *val);
+static char* component_set_alloc_shared_huge_pages_info(opal_infosubscriber_t *obj, char *key, char *val);
 
 
 ompi_osc_sm_component_t mca_osc_sm_component = {
@@ -125,6 +130,51 @@ static int component_register (void)
                                             MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0, OPAL_INFO_LVL_3,
                                             MCA_BASE_VAR_SCOPE_READONLY, &mca_osc_sm_component.backing_directory);
 
+    mca_osc_sm_component.acc_use_amo = true;
+    (void) mca_base_component_var_register (&mca_osc_sm_component.super.osc_version, "acc_use_amo",
+                                            "Use processor atomics instead of the per-target accumulate lock "
+                                            "for accumulate operations on 4 and 8 byte predefined datatypes "
+                                            "(default: true)", MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_sm_component.acc_use_amo);
+
+    mca_osc_sm_component.fence_use_flags = true;
+    (void) mca_base_component_var_register (&mca_osc_sm_component.super.osc_version, "fence_use_flags",
+                                            "Synchronize MPI_Win_fence with a dissemination barrier on flags "
+                                            "in the shared memory segment instead of the communicator barrier. "
+                                            "Not used when the blocking_fence info key is set (default: true)",
+                                            MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_sm_component.fence_use_flags);
+
+    mca_osc_sm_component.sync_spin_count = 10000;
+    (void) mca_base_component_var_register (&mca_osc_sm_component.super.osc_version, "sync_spin_count",
+                                            "Number of times a process polls a synchronization flag of the "
+                                            "window in fence and MPI_Win_wait before sleeping on it in the "
+                                            "kernel. Only used where futexes are available (default: 10000)",
+                                            MCA_BASE_VAR_TYPE_INT, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_sm_component.sync_spin_count);
+
+    mca_osc_sm_component.numa_placement = true;
+    (void) mca_base_component_var_register (&mca_osc_sm_component.super.osc_version, "numa_placement",
+                                            "Place the pages of each process' part of a shared memory window "
+                                            "on the NUMA node the process is bound to. Default for the "
+                                            "alloc_shared_numa info key (default: true)",
+                                            MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_sm_component.numa_placement);
+
+    mca_osc_sm_component.huge_pages = false;
+    (void) mca_base_component_var_register (&mca_osc_sm_component.super.osc_version, "huge_pages",
+                                            "Ask for transparent huge pages to back shared memory windows. "
+                                            "Default for the alloc_shared_huge_pages info key (default: false)",
+                                            MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_sm_component.huge_pages);
+
+    mca_osc_sm_component.huge_page_size = 2 * 1024 * 1024;
+    (void) mca_base_component_var_register (&mca_osc_sm_component.super.osc_version, "huge_page_size",
+                                            "Size of the huge pages windows are aligned to when huge pages "
+                                            "are requested (default: 2MB)",
+                                            MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_sm_component.huge_page_size);
+
     return OPAL_SUCCESS;
 }
 
@@ -184,6 +234,53 @@ component_query(struct ompi_win_t *win, void **base, size_t size, int disp_unit,
 }
 
 
+/**
+ * Place the pages of this process' part of the window, from the offset
+ * start to end of the segment, before anyone touches them. Pages belong to
+ * the process whose part of the window they start in, so the parts of a
+ * contiguous window do not need to be page aligned. The pages are bound to
+ * the NUMA nodes of the process when it is bound, and touched first by the
+ * process in any case.
+ */
+static void
+component_place_window(ompi_osc_sm_module_t *module, size_t start, size_t end, size_t window_start,
+                       size_t window_end)
+{
+    size_t align = module->huge_pages ? mca_osc_sm_component.huge_page_size : opal_getpagesize();
+    char *segment = (char *) module->segment_base;
+
+#if defined(MADV_HUGEPAGE)
+    if (module->huge_pages && window_end > window_start) {
+        /* every process advises its own mapping of the window */
+        (void) madvise (segment + window_start, window_end - window_start, MADV_HUGEPAGE);
+    }
+#endif
+
+    if (!module->numa_placement || start == end) {
+        return;
+    }
+
+    start = OPAL_ALIGN(start, align, size_t);
+    end = OPAL_ALIGN(end, align, size_t);
+    if (end > module->seg_ds.seg_size) {
+        end = module->seg_ds.seg_size;
+    }
+    if (start >= end) {
+        return;
+    }
+
+    if (OPAL_SUCCESS == opal_hwloc_base_get_topology () && NULL != opal_hwloc_my_cpuset &&
+        !hwloc_bitmap_isequal (opal_hwloc_my_cpuset, hwloc_get_root_obj (opal_hwloc_topology)->cpuset)) {
+        /* not strict: the pages go elsewhere if the nodes are out of memory */
+        (void) hwloc_set_area_membind (opal_hwloc_topology, segment + start, end - start,
+                                       opal_hwloc_my_cpuset, HWLOC_MEMBIND_BIND, 0);
+    }
+
+    /* the segment is zero filled, writing it faults the pages in under our policy */
+    memset (segment + start, 0, end - start);
+}
+
+
 static int
 component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit,
                  struct ompi_communicator_t *comm, struct opal_info_t *info,
@@ -211,6 +308,18 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
 
     if (OPAL_SUCCESS != ret) goto error;
 
+    ret = opal_infosubscribe_subscribe(&(win->super), "alloc_shared_numa",
+                                       mca_osc_sm_component.numa_placement ? "true" : "false",
+                                       component_set_alloc_shared_numa_info);
+
+    if (OPAL_SUCCESS != ret) goto error;
+
+    ret = opal_infosubscribe_subscribe(&(win->super), "alloc_shared_huge_pages",
+                                       mca_osc_sm_component.huge_pages ? "true" : "false",
+                                       component_set_alloc_shared_huge_pages_info);
+
+    if (OPAL_SUCCESS != ret) goto error;
+
     /* fill in the function pointer part */
     memcpy(module, &ompi_osc_sm_module_template,
            sizeof(ompi_osc_base_module_t));
@@ -220,6 +329,7 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
     if (OMPI_SUCCESS != ret) goto error;
 
     module->flavor = flavor;
+    module->acc_use_amo = mca_osc_sm_component.acc_use_amo;
 
     /* create the segment */
     if (1 == comm_size) {
@@ -237,14 +347,16 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
         if (NULL == module->global_state) return OMPI_ERR_TEMP_OUT_OF_RESOURCE;
         module->node_states = malloc(sizeof(ompi_osc_sm_node_state_t));
         if (NULL == module->node_states) return OMPI_ERR_TEMP_OUT_OF_RESOURCE;
+        module->sync_states = calloc(1, sizeof(ompi_osc_sm_sync_state_t));
+        if (NULL == module->sync_states) return OMPI_ERR_TEMP_OUT_OF_RESOURCE;
         module->posts = calloc (1, sizeof(module->posts[0]) + sizeof (module->posts[0][0]));
         if (NULL == module->posts) return OMPI_ERR_TEMP_OUT_OF_RESOURCE;
         module->posts[0] = (osc_sm_post_atomic_type_t *) (module->posts + 1);
     } else {
         unsigned long total, *rbuf;
-        int i, flag;
-        size_t pagesize;
-        size_t state_size;
+        int i, flag, huge_pages;
+        size_t pagesize, align;
+        size_t state_size, sync_size, window_start, my_start = 0;
         size_t posts_size, post_size = (comm_size + OSC_SM_POST_MASK) / (OSC_SM_POST_MASK + 1);
 
         OPAL_OUTPUT_VERBOSE((1, ompi_osc_base_framework.framework_output,
@@ -262,8 +374,29 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
             goto error;
         }
 
+        module->numa_placement = mca_osc_sm_component.numa_placement;
+        if (OMPI_SUCCESS != opal_info_get_bool(info, "alloc_shared_numa",
+                                               &module->numa_placement, &flag)) {
+            goto error;
+        }
+
+        module->huge_pages = mca_osc_sm_component.huge_pages;
+        if (OMPI_SUCCESS != opal_info_get_bool(info, "alloc_shared_huge_pages",
+                                               &module->huge_pages, &flag)) {
+            goto error;
+        }
+
+        /* the layout of the segment depends on it so everyone has to agree */
+        huge_pages = module->huge_pages && mca_osc_sm_component.huge_page_size > pagesize;
+        ret = module->comm->c_coll->coll_allreduce(MPI_IN_PLACE, &huge_pages, 1, MPI_INT, MPI_MIN,
+                                                  module->comm, module->comm->c_coll->coll_allreduce_module);
+        if (OMPI_SUCCESS != ret) goto error;
+        module->huge_pages = !!huge_pages;
+
+        align = module->huge_pages ? mca_osc_sm_component.huge_page_size : pagesize;
+
         if (module->noncontig) {
-            total = ((size - 1) / pagesize + 1) * pagesize;
+            total = ((size - 1) / align + 1) * align;
         } else {
             total = size;
         }
@@ -283,6 +416,9 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
         state_size += OPAL_ALIGN_PAD_AMOUNT(state_size, 64);
         posts_size = comm_size * post_size * sizeof (module->posts[0][0]);
         posts_size += OPAL_ALIGN_PAD_AMOUNT(posts_size, 64);
+        sync_size = comm_size * sizeof (ompi_osc_sm_sync_state_t);
+        /* the window starts on a page of its own so its pages can be placed */
+        window_start = OPAL_ALIGN(state_size + posts_size + sync_size, align, size_t);
         if (0 == ompi_comm_rank (module->comm)) {
             char *data_file;
             ret = opal_asprintf (&data_file, "%s" OPAL_PATH_SEP "osc_sm.%s.%x.%d.%d",
@@ -292,7 +428,7 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
                 return OMPI_ERR_OUT_OF_RESOURCE;
             }
 
-            ret = opal_shmem_segment_create (&module->seg_ds, data_file, total + pagesize + state_size + posts_size);
+            ret = opal_shmem_segment_create (&module->seg_ds, data_file, total + pagesize + window_start);
             free(data_file);
             if (OPAL_SUCCESS != ret) {
                 goto error;
@@ -332,14 +468,20 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
 
         /* set module->posts[0] first to ensure 64-bit alignment */
         module->posts[0] = (osc_sm_post_atomic_type_t *) (module->segment_base);
-        module->global_state = (ompi_osc_sm_global_state_t *) (module->posts[0] + comm_size * post_size);
+        /* the synchronization flags follow on cache line boundaries */
+        module->sync_states = (ompi_osc_sm_sync_state_t *) ((char *) module->segment_base + posts_size);
+        module->global_state = (ompi_osc_sm_global_state_t *) (module->sync_states + comm_size);
         module->node_states = (ompi_osc_sm_node_state_t *) (module->global_state + 1);
 
-        for (i = 0, total = state_size + posts_size ; i < comm_size ; ++i) {
+        for (i = 0, total = window_start ; i < comm_size ; ++i) {
             if (i > 0) {
                 module->posts[i] = module->posts[i - 1] + post_size;
             }
 
+            if (i == ompi_comm_rank (module->comm)) {
+                my_start = total;
+            }
+
             module->sizes[i] = rbuf[i];
             if (module->sizes[i] || !module->noncontig) {
                 module->bases[i] = ((char *) module->segment_base) + total;
@@ -349,12 +491,16 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
             }
         }
 
+        component_place_window (module, my_start, my_start + rbuf[ompi_comm_rank (module->comm)],
+                                window_start, total);
+
         free(rbuf);
     }
 
     /* initialize my state shared */
     module->my_node_state = &module->node_states[ompi_comm_rank(module->comm)];
     memset (module->my_node_state, 0, sizeof(*module->my_node_state));
+    memset (module->sync_states + ompi_comm_rank(module->comm), 0, sizeof (module->sync_states[0]));
 
     *base = module->bases[ompi_comm_rank(module->comm)];
 
@@ -419,6 +565,9 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
 #else
         module->global_state->use_barrier_for_fence = 1;
 #endif
+        /* the flags replace the communicator barrier, not the blocking fence */
+        module->global_state->use_flags_for_fence = module->global_state->use_barrier_for_fence &&
+            mca_osc_sm_component.fence_use_flags;
     }
 
     ret = opal_infosubscribe_subscribe(&(win->super), "blocking_fence", module->global_state->use_barrier_for_fence ? "true" : "false",
@@ -521,6 +670,7 @@ ompi_osc_sm_free(struct ompi_win_t *win)
 	opal_shmem_segment_detach (&module->seg_ds);
     } else {
         free(module->node_states);
+        free(module->sync_states);
         free(module->global_state);
         if (NULL != module->bases) {
             free(module->bases[0]);
@@ -567,6 +717,25 @@ component_set_blocking_fence_info(opal_infosubscriber_t *obj, char *key, char *v
 }
 
 
+static char*
+component_set_alloc_shared_numa_info(opal_infosubscriber_t *obj, char *key, char *val)
+{
+    ompi_osc_sm_module_t *module = (ompi_osc_sm_module_t*) ((struct ompi_win_t*) obj)->w_osc_module;
+
+    /* the pages are placed when the window is allocated */
+    return module->numa_placement ? "true" : "false";
+}
+
+
+static char*
+component_set_alloc_shared_huge_pages_info(opal_infosubscriber_t *obj, char *key, char *val)
+{
+    ompi_osc_sm_module_t *module = (ompi_osc_sm_module_t*) ((struct ompi_win_t*) obj)->w_osc_module;
+
+    return module->huge_pages ? "true" : "false";
+}
+
+
 static char*
 component_set_alloc_shared_noncontig_info(opal_infosubscriber_t *obj, char *key, char *val)
 {
@@ -593,6 +762,10 @@ ompi_osc_sm_get_info(struct ompi_win_t *win, struct opal_info_t **info_used)
                       (1 == module->global_state->use_barrier_for_fence) ? "true" : "false");
         opal_info_set(info, "alloc_shared_noncontig",
                       (module->noncontig) ? "true" : "false");
+        opal_info_set(info, "alloc_shared_numa",
+                      (module->numa_placement) ? "true" : "false");
+        opal_info_set(info, "alloc_shared_huge_pages",
+                      (module->huge_pages) ? "true" : "false");
     }
 
     *info_used = info;
@@ -61,6 +61,7 @@ struct mca_pml_ob1_t {
     int max_rdma_per_request;
     int max_send_per_range;
     bool use_all_rdma;
+    bool use_self_direct;
 
     /* lock queue access */
     opal_mutex_t lock;
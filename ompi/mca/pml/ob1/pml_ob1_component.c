@@ -220,6 +220,13 @@ static int mca_pml_ob1_component_register(void)
                                            "(default: false)", MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_GROUP, &mca_pml_ob1.use_all_rdma);
 
+    mca_pml_ob1.use_self_direct = true;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "use_self_direct",
+                                           "Copy messages sent to self straight into an already posted matching "
+                                           "receive instead of going through the self BTL (default: true)",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_GROUP, &mca_pml_ob1.use_self_direct);
+
     mca_pml_ob1.allocator_name = "bucket";
     (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "allocator",
                                            "Name of allocator component for unexpected messages",
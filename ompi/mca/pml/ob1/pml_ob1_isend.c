@@ -27,6 +27,7 @@
 #include "pml_ob1.h"
 #include "pml_ob1_sendreq.h"
 #include "pml_ob1_recvreq.h"
+#include "pml_ob1_recvfrag.h"
 #include "ompi/peruse/peruse-internal.h"
 #include "ompi/runtime/ompi_spc.h"
 
@@ -144,6 +145,95 @@ static inline int mca_pml_ob1_send_inline (const void *buf, size_t count,
     return (int) size;
 }
 
+#if !OPAL_CUDA_SUPPORT
+/* deliver a message sent to self straight into a matching posted receive,
+ * with a single copy and no fragment. not built with CUDA support, device
+ * buffers need the CUDA aware convertors of the regular path. */
+static inline int mca_pml_ob1_send_self (const void *buf, size_t count,
+                                         ompi_datatype_t * datatype,
+                                         int tag, int16_t seqn,
+                                         mca_pml_ob1_comm_proc_t *ob1_proc,
+                                         ompi_communicator_t * comm)
+{
+    mca_pml_ob1_recv_request_t *match;
+    mca_pml_ob1_match_hdr_t hdr;
+    ompi_datatype_t *recv_type;
+    size_t size;
+
+    if (!mca_pml_ob1.use_self_direct || (ob1_proc->ompi_proc != ompi_proc_local_proc)) {
+        return OMPI_ERR_NOT_AVAILABLE;
+    }
+
+    ompi_datatype_type_size (datatype, &size);
+    size *= count;
+
+    mca_pml_ob1_match_hdr_prepare (&hdr, MCA_PML_OB1_HDR_TYPE_MATCH, 0,
+                                   comm->c_contextid, comm->c_my_rank,
+                                   tag, seqn);
+
+    match = mca_pml_ob1_recv_frag_match_self (comm, ob1_proc, &hdr, size);
+    if (NULL == match) {
+        return OMPI_ERR_NOT_AVAILABLE;
+    }
+
+    match->req_recv.req_bytes_packed = size;
+    MCA_PML_OB1_RECV_REQUEST_MATCHED(match, &hdr);
+
+    if (size > 0) {
+        recv_type = match->req_recv.req_base.req_datatype;
+
+        MEMCHECKER(
+                   memchecker_call(&opal_memchecker_base_mem_defined,
+                                   match->req_recv.req_base.req_addr,
+                                   match->req_recv.req_base.req_count,
+                                   recv_type);
+                   );
+
+        if ((recv_type == datatype) && (match->req_recv.req_base.req_count >= count)) {
+            /* same layout on both sides */
+            ompi_datatype_copy_content_same_ddt (datatype, count,
+                                                 (char *) match->req_recv.req_base.req_addr,
+                                                 (char *) buf);
+        } else {
+            /* walk the memory regions of the send buffer and unpack them
+             * directly into the receive buffer */
+            struct iovec iov[MCA_BTL_DES_MAX_SEGMENTS];
+            opal_convertor_t convertor;
+            uint32_t iov_count;
+            size_t length;
+            int done;
+
+            OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+            opal_convertor_copy_and_prepare_for_send (ompi_proc_local_proc->super.proc_convertor,
+                                                      (const struct opal_datatype_t *) datatype,
+                                                      count, buf, 0, &convertor);
+            do {
+                iov_count = MCA_BTL_DES_MAX_SEGMENTS;
+                length = size;
+                done = opal_convertor_raw (&convertor, iov, &iov_count, &length);
+                opal_convertor_unpack (&match->req_recv.req_base.req_convertor,
+                                       iov, &iov_count, &length);
+            } while (!done && length > 0);
+            opal_convertor_cleanup (&convertor);
+            OBJ_DESTRUCT(&convertor);
+        }
+
+        MEMCHECKER(
+                   memchecker_call(&opal_memchecker_base_mem_noaccess,
+                                   match->req_recv.req_base.req_addr,
+                                   match->req_recv.req_base.req_count,
+                                   recv_type);
+                   );
+        SPC_USER_OR_MPI(tag, (ompi_spc_value_t)size, OMPI_SPC_BYTES_SENT_USER, OMPI_SPC_BYTES_SENT_MPI);
+        SPC_USER_OR_MPI(tag, (ompi_spc_value_t)size, OMPI_SPC_BYTES_RECEIVED_USER, OMPI_SPC_BYTES_RECEIVED_MPI);
+    }
+    match->req_bytes_received = size;
+
+    recv_request_pml_complete (match);
+    return OMPI_SUCCESS;
+}
+#endif /* !OPAL_CUDA_SUPPORT */
+
 int mca_pml_ob1_isend(const void *buf,
                       size_t count,
                       ompi_datatype_t * datatype,
@@ -180,6 +270,16 @@ int mca_pml_ob1_isend(const void *buf,
         }
     }
 
+#if !OPAL_CUDA_SUPPORT
+    if (MCA_PML_BASE_SEND_BUFFERED != sendmode) {
+        rc = mca_pml_ob1_send_self (buf, count, datatype, tag, seqn, ob1_proc, comm);
+        if (OMPI_SUCCESS == rc) {
+            *request = &ompi_request_empty;
+            return OMPI_SUCCESS;
+        }
+    }
+#endif /* !OPAL_CUDA_SUPPORT */
+
     MCA_PML_OB1_SEND_REQUEST_ALLOC(comm, dst, sendreq);
     if (NULL == sendreq)
         return OMPI_ERR_OUT_OF_RESOURCE;
@@ -250,6 +350,13 @@ int mca_pml_ob1_send(const void *buf,
         }
     }
 
+#if !OPAL_CUDA_SUPPORT
+    if (MCA_PML_BASE_SEND_BUFFERED != sendmode &&
+        OMPI_SUCCESS == mca_pml_ob1_send_self (buf, count, datatype, tag, seqn, ob1_proc, comm)) {
+        return OMPI_SUCCESS;
+    }
+#endif /* !OPAL_CUDA_SUPPORT */
+
     if (OPAL_LIKELY(!ompi_mpi_thread_multiple)) {
         sendreq = mca_pml_ob1_sendreq;
         mca_pml_ob1_sendreq = NULL;
@@ -1071,3 +1071,90 @@ mca_pml_ob1_recv_frag_match_proc( mca_btl_base_module_t *btl,
     return OMPI_SUCCESS;
 }
 
+
+/**
+ * Match a message sent to self against the posted receives without going
+ * through a BTL. The match is only made when the message is the next in
+ * sequence, when the first matching receive is a regular receive and when
+ * it can hold the whole message, otherwise NULL is returned, nothing is
+ * consumed and the message has to take the usual path.
+ */
+mca_pml_ob1_recv_request_t *
+mca_pml_ob1_recv_frag_match_self( ompi_communicator_t *comm_ptr,
+                                  mca_pml_ob1_comm_proc_t *proc,
+                                  mca_pml_ob1_match_hdr_t *hdr,
+                                  size_t bytes )
+{
+#if !MCA_PML_OB1_CUSTOM_MATCH
+    mca_pml_ob1_comm_t *comm = (mca_pml_ob1_comm_t *)comm_ptr->c_pml_comm;
+    mca_pml_ob1_recv_request_t *specific_recv, *wild_recv, *match = NULL;
+    mca_pml_sequence_t wild_recv_seq, specific_recv_seq;
+    opal_list_t *queue = NULL;
+    int tag = hdr->hdr_tag;
+
+    OB1_MATCHING_LOCK(&comm->matching_lock);
+
+    if( (NULL != proc->frags_cant_match) ||
+        (!OMPI_COMM_CHECK_ASSERT_ALLOW_OVERTAKE(comm_ptr) &&
+         (((uint16_t) hdr->hdr_seq) != ((uint16_t) proc->expected_sequence))) ) {
+        OB1_MATCHING_UNLOCK(&comm->matching_lock);
+        return NULL;
+    }
+
+    /* same walk as match_incomming, but only dequeue once we know the
+     * message can be delivered in place */
+    specific_recv = get_posted_recv(&proc->specific_receives);
+    wild_recv = OMPI_COMM_CHECK_ASSERT_NO_ANY_SOURCE(comm_ptr) ? NULL : get_posted_recv(&comm->wild_receives);
+
+    wild_recv_seq = wild_recv ?
+        wild_recv->req_recv.req_base.req_sequence : PML_MAX_SEQ;
+    specific_recv_seq = specific_recv ?
+        specific_recv->req_recv.req_base.req_sequence : PML_MAX_SEQ;
+
+    while(wild_recv_seq != specific_recv_seq) {
+        mca_pml_ob1_recv_request_t **next;
+        mca_pml_sequence_t *seq;
+        int req_tag;
+
+        if (OPAL_UNLIKELY(wild_recv_seq < specific_recv_seq)) {
+            next = &wild_recv;
+            queue = &comm->wild_receives;
+            seq = &wild_recv_seq;
+        } else {
+            next = &specific_recv;
+            queue = &proc->specific_receives;
+            seq = &specific_recv_seq;
+        }
+
+        req_tag = (*next)->req_recv.req_base.req_tag;
+        if(req_tag == tag || (req_tag == OMPI_ANY_TAG && tag >= 0)) {
+            match = *next;
+            break;
+        }
+
+        *next = get_next_posted_recv(queue, *next);
+        *seq = (*next) ? (*next)->req_recv.req_base.req_sequence : PML_MAX_SEQ;
+    }
+
+    if( (NULL == match) || (MCA_PML_REQUEST_RECV != match->req_recv.req_base.req_type) ||
+        (bytes > match->req_recv.req_base.req_datatype->super.size * match->req_recv.req_base.req_count) ) {
+        OB1_MATCHING_UNLOCK(&comm->matching_lock);
+        return NULL;
+    }
+
+    opal_list_remove_item(queue, (opal_list_item_t*)match);
+    PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_REQ_REMOVE_FROM_POSTED_Q,
+                            &(match->req_recv.req_base), PERUSE_RECV);
+    proc->expected_sequence++;
+    match->req_recv.req_base.req_proc = proc->ompi_proc;
+
+    OB1_MATCHING_UNLOCK(&comm->matching_lock);
+
+    PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_MSG_MATCH_POSTED_REQ,
+                            &(match->req_recv.req_base), PERUSE_RECV);
+    return match;
+#else
+    /* the custom matching queues cannot be searched without dequeuing */
+    return NULL;
+#endif
+}
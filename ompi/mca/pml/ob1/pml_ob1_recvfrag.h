@@ -180,6 +180,17 @@ void append_frag_to_ordered_list(mca_pml_ob1_recv_frag_t** queue,
                                  uint16_t seq);
 
 extern void mca_pml_ob1_dump_cant_match(mca_pml_ob1_recv_frag_t* queue);
+
+/**
+ * Match a message sent to self directly against the posted receives. On
+ * success the receive is dequeued and the sequence number consumed.
+ */
+struct mca_pml_ob1_recv_request_t;
+extern struct mca_pml_ob1_recv_request_t*
+mca_pml_ob1_recv_frag_match_self(ompi_communicator_t *comm_ptr,
+                                 mca_pml_ob1_comm_proc_t *proc,
+                                 mca_pml_ob1_match_hdr_t *hdr,
+                                 size_t bytes);
 END_C_DECLS
 
 #endif
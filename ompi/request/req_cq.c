@@ -0,0 +1,435 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Completion queues for MPI_Waitany, MPI_Waitsome and MPI_Testsome.
+ *
+ * Applications keeping a large array of requests outstanding and calling
+ * waitsome in a loop pay for a pass over every request on each call, and
+ * when nothing has completed yet for attaching a sync object to (and later
+ * detaching it from) every pending request. For arrays of at least
+ * ompi_request_cq_min_count entries the request layer instead remembers
+ * the array between calls and arms each of its requests with a pointer
+ * back to a queue. ompi_request_complete() appends the index of an armed
+ * request to the ready list of the queue, so a call only dereferences the
+ * requests that completed since the previous one.
+ *
+ * The array belongs to the application and may change between calls, so
+ * every call compares it with the handles seen at the previous call. This
+ * pass only reads the array; a request is armed when its handle shows up
+ * in a slot. Finalizing, initializing or destructing an armed request
+ * detaches it and forgets the handle in its slot, so a request allocated
+ * again at the same address is seen as a new handle.
+ *
+ * Arrays holding persistent requests are left to the scanning code, as
+ * MPI_Start does not go through the request layer.
+ *
+ * One lock protects the queues and the req_cq field of the requests. The
+ * queues live until MPI_Finalize and req_cq is always checked against the
+ * slot it claims, so a stale pointer is harmless.
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "opal/threads/mutex.h"
+#include "opal/threads/wait_sync.h"
+#include "ompi/constants.h"
+#include "ompi/request/request.h"
+#include "ompi/request/request_default.h"
+#include "ompi/runtime/params.h"
+
+#include "ompi/mca/crcp/crcp.h"
+
+/** number of arrays tracked at the same time */
+#define OMPI_REQUEST_CQ_MAX    4
+
+/** the index is on the ready list */
+#define OMPI_REQUEST_CQ_QUEUED 0x01
+/** the request in the slot points back to the queue */
+#define OMPI_REQUEST_CQ_ARMED  0x02
+/** the slot holds a request other than MPI_REQUEST_NULL */
+#define OMPI_REQUEST_CQ_ACTIVE 0x04
+
+struct ompi_request_cq_t {
+    /** array (and its length) tracked by this queue */
+    ompi_request_t **requests;
+    size_t count;
+    /** number of entries allocated in slots, flags and ready */
+    size_t size;
+    /** handles found in the array by the last call, NULL if unknown */
+    ompi_request_t **slots;
+    uint8_t *flags;
+    /** circular list of indices whose request may have completed */
+    size_t *ready;
+    size_t ready_head;
+    size_t ready_count;
+    /** number of slots with the OMPI_REQUEST_CQ_ACTIVE flag */
+    size_t active;
+    /** sync object of the thread waiting on this queue */
+    ompi_wait_sync_t *sync;
+    /** last use, the least recently used queue is recycled */
+    uint64_t stamp;
+    /** a thread is waiting on this queue */
+    bool busy;
+    /** the array holds persistent requests */
+    bool legacy;
+};
+
+typedef struct ompi_request_cq_t ompi_request_cq_t;
+
+static ompi_request_cq_t ompi_request_cqs[OMPI_REQUEST_CQ_MAX];
+static opal_mutex_t ompi_request_cq_lock;
+static uint64_t ompi_request_cq_clock;
+
+static void ompi_request_cq_queue (ompi_request_cq_t *cq, size_t index)
+{
+    if (cq->flags[index] & OMPI_REQUEST_CQ_QUEUED) {
+        return;
+    }
+
+    cq->flags[index] |= OMPI_REQUEST_CQ_QUEUED;
+    cq->ready[(cq->ready_head + cq->ready_count++) % cq->count] = index;
+
+    if (NULL != cq->sync) {
+        wait_sync_update (cq->sync, 1, OPAL_SUCCESS);
+        cq->sync = NULL;
+    }
+}
+
+static void ompi_request_cq_clear_slot (ompi_request_cq_t *cq, size_t index)
+{
+    ompi_request_t *request = cq->slots[index];
+
+    if (cq->flags[index] & OMPI_REQUEST_CQ_ARMED) {
+        if (cq == request->req_cq && index == request->req_cq_index) {
+            request->req_cq = NULL;
+        }
+    }
+
+    if (cq->flags[index] & OMPI_REQUEST_CQ_ACTIVE) {
+        cq->active--;
+    }
+
+    /* the index may still be on the ready list */
+    cq->flags[index] &= OMPI_REQUEST_CQ_QUEUED;
+    cq->slots[index] = NULL;
+}
+
+static void ompi_request_cq_detach_locked (ompi_request_t *request)
+{
+    ompi_request_cq_t *cq = request->req_cq;
+    size_t index = request->req_cq_index;
+
+    if (index < cq->count && request == cq->slots[index]) {
+        ompi_request_cq_clear_slot (cq, index);
+    }
+
+    request->req_cq = NULL;
+}
+
+void ompi_request_cq_detach (ompi_request_t *request)
+{
+    OPAL_THREAD_LOCK(&ompi_request_cq_lock);
+    if (NULL != request->req_cq) {
+        ompi_request_cq_detach_locked (request);
+    }
+    OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+}
+
+void ompi_request_cq_notify (ompi_request_t *request)
+{
+    ompi_request_cq_t *cq;
+    size_t index;
+
+    OPAL_THREAD_LOCK(&ompi_request_cq_lock);
+    cq = request->req_cq;
+    index = request->req_cq_index;
+    if (NULL != cq && index < cq->count && request == cq->slots[index]) {
+        ompi_request_cq_queue (cq, index);
+    }
+    OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+}
+
+/* detach all the requests and empty the ready list, the queue keeps
+ * tracking the same array */
+static void ompi_request_cq_disarm (ompi_request_cq_t *cq)
+{
+    for (size_t i = 0 ; i < cq->count ; ++i) {
+        ompi_request_cq_clear_slot (cq, i);
+        cq->flags[i] = 0;
+    }
+
+    cq->ready_head = 0;
+    cq->ready_count = 0;
+}
+
+static void ompi_request_cq_reset (ompi_request_cq_t *cq)
+{
+    ompi_request_cq_disarm (cq);
+
+    cq->requests = NULL;
+    cq->count = 0;
+    cq->legacy = false;
+}
+
+static int ompi_request_cq_resize (ompi_request_cq_t *cq, size_t count)
+{
+    ompi_request_t **slots;
+    uint8_t *flags;
+    size_t *ready;
+
+    slots = (ompi_request_t **) realloc (cq->slots, count * sizeof (cq->slots[0]));
+    if (NULL != slots) {
+        cq->slots = slots;
+    }
+    flags = (uint8_t *) realloc (cq->flags, count * sizeof (cq->flags[0]));
+    if (NULL != flags) {
+        cq->flags = flags;
+    }
+    ready = (size_t *) realloc (cq->ready, count * sizeof (cq->ready[0]));
+    if (NULL != ready) {
+        cq->ready = ready;
+    }
+
+    if (NULL == slots || NULL == flags || NULL == ready) {
+        free (cq->slots);
+        free (cq->flags);
+        free (cq->ready);
+        cq->slots = NULL;
+        cq->flags = NULL;
+        cq->ready = NULL;
+        cq->size = 0;
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    cq->size = count;
+
+    return OMPI_SUCCESS;
+}
+
+/* find the queue tracking an array or recycle the least recently used one */
+static ompi_request_cq_t *ompi_request_cq_lookup (ompi_request_t **requests, size_t count)
+{
+    ompi_request_cq_t *cq = NULL, *victim = NULL;
+
+    for (int i = 0 ; i < OMPI_REQUEST_CQ_MAX ; ++i) {
+        ompi_request_cq_t *tmp = ompi_request_cqs + i;
+
+        if (requests == tmp->requests && count == tmp->count) {
+            cq = tmp;
+            break;
+        }
+
+        if (!tmp->busy && (NULL == victim || tmp->stamp < victim->stamp)) {
+            victim = tmp;
+        }
+    }
+
+    if (NULL == cq) {
+        if (NULL == victim) {
+            return NULL;
+        }
+
+        cq = victim;
+        ompi_request_cq_reset (cq);
+
+        if (cq->size < count && OMPI_SUCCESS != ompi_request_cq_resize (cq, count)) {
+            return NULL;
+        }
+
+        memset (cq->slots, 0, count * sizeof (cq->slots[0]));
+        memset (cq->flags, 0, count * sizeof (cq->flags[0]));
+        cq->requests = requests;
+        cq->count = count;
+    }
+
+    cq->stamp = ++ompi_request_cq_clock;
+
+    if (cq->busy || cq->legacy) {
+        return NULL;
+    }
+
+    return cq;
+}
+
+/* pick up the handles that changed since the last call */
+static bool ompi_request_cq_update (ompi_request_cq_t *cq)
+{
+    ompi_request_t **requests = cq->requests;
+
+    for (size_t i = 0 ; i < cq->count ; ++i) {
+        ompi_request_t *request = requests[i];
+
+        if (OPAL_LIKELY(request == cq->slots[i])) {
+            continue;
+        }
+
+        ompi_request_cq_clear_slot (cq, i);
+
+        if (request->req_persistent) {
+            cq->legacy = true;
+            ompi_request_cq_disarm (cq);
+            return false;
+        }
+
+        cq->slots[i] = request;
+
+        if (OMPI_REQUEST_INACTIVE == request->req_state) {
+            /* MPI_REQUEST_NULL */
+            continue;
+        }
+
+        cq->flags[i] |= OMPI_REQUEST_CQ_ACTIVE;
+        cq->active++;
+
+        /* ompi_request_empty is shared by all the requests that completed
+         * immediately, it is never armed */
+        if (&ompi_request_empty != request) {
+            if (NULL != request->req_cq) {
+                /* the same request is used in another array or slot */
+                ompi_request_cq_detach_locked (request);
+            }
+
+            request->req_cq = cq;
+            request->req_cq_index = i;
+            cq->flags[i] |= OMPI_REQUEST_CQ_ARMED;
+
+            /* pairs with the check of req_cq after the request is marked
+             * complete in ompi_request_complete */
+            opal_atomic_mb ();
+        }
+
+        if (REQUEST_COMPLETE(request)) {
+            ompi_request_cq_queue (cq, i);
+        }
+    }
+
+    return true;
+}
+
+static size_t ompi_request_cq_harvest (ompi_request_cq_t *cq, size_t max, int *indices)
+{
+    size_t num_requests_done = 0, pending = cq->ready_count;
+
+    for ( ; pending > 0 && num_requests_done < max ; --pending) {
+        size_t index = cq->ready[cq->ready_head];
+        ompi_request_t *request = cq->requests[index];
+
+        cq->ready_head = (cq->ready_head + 1) % cq->count;
+        cq->ready_count--;
+        cq->flags[index] &= ~OMPI_REQUEST_CQ_QUEUED;
+
+        if (request != cq->slots[index] || !(cq->flags[index] & OMPI_REQUEST_CQ_ACTIVE) ||
+            !REQUEST_COMPLETE(request)) {
+            continue;
+        }
+
+        indices[num_requests_done++] = (int) index;
+    }
+
+    /* The caller frees the requests that completed successfully, which
+     * clears their slots. The others stay in the array and have to be
+     * returned again by the next call, as the scanning code does. */
+    for (size_t i = 0 ; i < num_requests_done ; ++i) {
+        ompi_request_cq_queue (cq, indices[i]);
+    }
+
+    /* make sure the status of the completed requests is visible */
+    opal_atomic_rmb ();
+
+    return num_requests_done;
+}
+
+int ompi_request_cq_some (size_t count, ompi_request_t **requests, size_t max,
+                          bool blocking, int *outcount, int *indices)
+{
+    size_t num_requests_done;
+    ompi_request_cq_t *cq;
+    ompi_wait_sync_t sync;
+
+    if (0 == ompi_request_cq_min_count || count < ompi_request_cq_min_count) {
+        return OMPI_ERR_NOT_AVAILABLE;
+    }
+
+#if OPAL_ENABLE_FT_CR == 1
+    if( opal_cr_is_enabled ) {
+        return OMPI_ERR_NOT_AVAILABLE;
+    }
+#endif
+
+    OPAL_THREAD_LOCK(&ompi_request_cq_lock);
+    cq = ompi_request_cq_lookup (requests, count);
+    if (NULL == cq || !ompi_request_cq_update (cq)) {
+        OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+        return OMPI_ERR_NOT_AVAILABLE;
+    }
+
+    if (0 == cq->active) {
+        OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+        *outcount = MPI_UNDEFINED;
+        return OMPI_SUCCESS;
+    }
+
+    num_requests_done = ompi_request_cq_harvest (cq, max, indices);
+    if (0 == num_requests_done && blocking) {
+        cq->busy = true;
+        do {
+            WAIT_SYNC_INIT(&sync, 1);
+            cq->sync = &sync;
+            OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+
+            /* ompi_request_cq_queue signals the sync and removes it */
+            SYNC_WAIT(&sync);
+            WAIT_SYNC_RELEASE(&sync);
+
+            OPAL_THREAD_LOCK(&ompi_request_cq_lock);
+            num_requests_done = ompi_request_cq_harvest (cq, max, indices);
+        } while (0 == num_requests_done);
+        cq->busy = false;
+    }
+    OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+
+    *outcount = (int) num_requests_done;
+
+    return OMPI_SUCCESS;
+}
+
+int ompi_request_cq_init (void)
+{
+    OBJ_CONSTRUCT(&ompi_request_cq_lock, opal_mutex_t);
+    memset (ompi_request_cqs, 0, sizeof (ompi_request_cqs));
+    ompi_request_cq_clock = 0;
+
+    return OMPI_SUCCESS;
+}
+
+int ompi_request_cq_finalize (void)
+{
+    OPAL_THREAD_LOCK(&ompi_request_cq_lock);
+    for (int i = 0 ; i < OMPI_REQUEST_CQ_MAX ; ++i) {
+        ompi_request_cq_t *cq = ompi_request_cqs + i;
+
+        ompi_request_cq_reset (cq);
+        free (cq->slots);
+        free (cq->flags);
+        free (cq->ready);
+        cq->slots = NULL;
+        cq->flags = NULL;
+        cq->ready = NULL;
+        cq->size = 0;
+    }
+    OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+
+    OBJ_DESTRUCT(&ompi_request_cq_lock);
+
+    return OMPI_SUCCESS;
+}
@@ -306,6 +306,21 @@ int ompi_request_default_test_some(
     ompi_request_t **rptr;
     ompi_request_t *request;
 
+    /* large arrays are tracked by a completion queue (see req_cq.c) */
+    if (OMPI_SUCCESS == ompi_request_cq_some(count, requests, count, false, outcount, indices)) {
+        if (MPI_UNDEFINED == *outcount) {
+            return OMPI_SUCCESS;
+        }
+        num_requests_done = *outcount;
+        if (0 == num_requests_done) {
+#if OPAL_ENABLE_PROGRESS_THREADS == 0
+            opal_progress();
+#endif
+            return OMPI_SUCCESS;
+        }
+        goto requests_completed;
+    }
+
     opal_atomic_mb();
     rptr = requests;
     for (i = 0; i < count; i++, rptr++) {
@@ -341,6 +356,7 @@ int ompi_request_default_test_some(
         return OMPI_SUCCESS;
     }
 
+  requests_completed:
     /* fill out completion status and free request if required */
     for( i = 0; i < num_requests_done; i++) {
         request = requests[indices[i]];
@@ -90,15 +90,56 @@ int ompi_request_default_wait_any(size_t count,
     int rc = OMPI_SUCCESS;
     ompi_request_t *request=NULL;
     ompi_wait_sync_t sync;
+    bool sync_used = false;
+    int num_requests_done;
 
     if (OPAL_UNLIKELY(0 == count)) {
         *index = MPI_UNDEFINED;
         return OMPI_SUCCESS;
     }
 
+    /* large arrays are tracked by a completion queue (see req_cq.c) */
+    if (OMPI_SUCCESS == ompi_request_cq_some(count, requests, 1, true, &num_requests_done, index)) {
+        if (MPI_UNDEFINED == num_requests_done) {
+            *index = MPI_UNDEFINED;
+            if (MPI_STATUS_IGNORE != status) {
+                *status = ompi_status_empty;
+            }
+            return rc;
+        }
+        goto request_completed;
+    }
+
+    /* Look for an already completed request using plain loads before
+     * paying for the sync object and the atomic attach/detach of every
+     * pending request.
+     */
+    for (i = 0; i < count; i++) {
+        request = requests[i];
+
+        if( request->req_state == OMPI_REQUEST_INACTIVE ) {
+            num_requests_null_inactive++;
+            continue;
+        }
+
+        if( REQUEST_COMPLETE(request) ) {
+            opal_atomic_rmb();
+            *index = i;
+            goto request_completed;
+        }
+    }
+
+    if(num_requests_null_inactive == count) {
+        *index = MPI_UNDEFINED;
+        if (MPI_STATUS_IGNORE != status) {
+            *status = ompi_status_empty;
+        }
+        return rc;
+    }
+
     WAIT_SYNC_INIT(&sync, 1);
+    sync_used = true;
 
-    num_requests_null_inactive = 0;
     for (i = 0; i < count; i++) {
         void *_tmp_ptr = REQUEST_PENDING;
 
@@ -108,7 +149,6 @@ int ompi_request_default_wait_any(size_t count,
          * MPI_REQUEST_NULL, the req_state is always OMPI_REQUEST_INACTIVE.
          */
         if( request->req_state == OMPI_REQUEST_INACTIVE ) {
-            num_requests_null_inactive++;
             continue;
         }
 
@@ -120,16 +160,6 @@ int ompi_request_default_wait_any(size_t count,
         }
     }
 
-    if(num_requests_null_inactive == count) {
-        *index = MPI_UNDEFINED;
-        if (MPI_STATUS_IGNORE != status) {
-            *status = ompi_status_empty;
-        }
-        /* No signal-in-flight can be in this case */
-        WAIT_SYNC_RELEASE_NOWAIT(&sync);
-        return rc;
-    }
-
     SYNC_WAIT(&sync);
 
   after_sync_wait:
@@ -163,6 +193,7 @@ int ompi_request_default_wait_any(size_t count,
         WAIT_SYNC_SIGNALLED(&sync);
     }
 
+  request_completed:
     request = requests[*index];
     assert( REQUEST_COMPLETE(request) );
 #if OPAL_ENABLE_FT_CR == 1
@@ -193,7 +224,9 @@ int ompi_request_default_wait_any(size_t count,
         rc = ompi_request_free(&requests[*index]);
     }
 
-    WAIT_SYNC_RELEASE(&sync);
+    if( sync_used ) {
+        WAIT_SYNC_RELEASE(&sync);
+    }
     return rc;
 }
 
@@ -389,6 +422,7 @@ int ompi_request_default_wait_some(size_t count,
                                    ompi_status_public_t * statuses)
 {
     size_t num_requests_null_inactive, num_requests_done, num_active_reqs;
+    size_t num_attached;
     int rc = MPI_SUCCESS;
     ompi_request_t **rptr = NULL;
     ompi_request_t *request = NULL;
@@ -400,17 +434,27 @@ int ompi_request_default_wait_some(size_t count,
         return OMPI_SUCCESS;
     }
 
-    WAIT_SYNC_INIT(&sync, 1);
-
     *outcount = 0;
 
+    /* large arrays are tracked by a completion queue (see req_cq.c) */
+    if (OMPI_SUCCESS == ompi_request_cq_some(count, requests, count, true, outcount, indices)) {
+        if (MPI_UNDEFINED == *outcount) {
+            return rc;
+        }
+        num_requests_done = *outcount;
+        goto requests_completed;
+    }
+
+    /* Harvest the requests that are already complete using plain loads.
+     * Applications keeping thousands of requests outstanding and calling
+     * waitsome in a loop usually find at least one completion here, in
+     * which case there is no need to attach the sync object to (and later
+     * detach it from) every pending request.
+     */
     rptr = requests;
     num_requests_null_inactive = 0;
     num_requests_done = 0;
-    num_active_reqs = 0;
     for (size_t i = 0; i < count; i++, rptr++) {
-        void *_tmp_ptr = REQUEST_PENDING;
-
         request = *rptr;
         /*
          * Check for null or completed persistent request.
@@ -420,25 +464,52 @@ int ompi_request_default_wait_some(size_t count,
             num_requests_null_inactive++;
             continue;
         }
-        indices[num_active_reqs] = OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&request->req_complete, &_tmp_ptr, &sync);
-        if( !indices[num_active_reqs] ) {
-            /* If the request is completed go ahead and mark it as such */
-            assert( REQUEST_COMPLETE(request) );
-            num_requests_done++;
+        if( REQUEST_COMPLETE(request) ) {
+            indices[num_requests_done++] = i;
         }
-        num_active_reqs++;
     }
 
     if(num_requests_null_inactive == count) {
         *outcount = MPI_UNDEFINED;
-        /* nobody will signall us */
-        WAIT_SYNC_RELEASE_NOWAIT(&sync);
         return rc;
     }
 
+    if( 0 != num_requests_done ) {
+        /* make sure the status of the completed requests is visible */
+        opal_atomic_rmb();
+        goto requests_completed;
+    }
+
+    WAIT_SYNC_INIT(&sync, 1);
+
+    rptr = requests;
+    num_requests_done = 0;
+    num_active_reqs = 0;
+    num_attached = count;
+    for (size_t i = 0; i < count; i++, rptr++) {
+        void *_tmp_ptr = REQUEST_PENDING;
+
+        request = *rptr;
+
+        if( request->req_state == OMPI_REQUEST_INACTIVE ) {
+            continue;
+        }
+        indices[num_active_reqs] = OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&request->req_complete, &_tmp_ptr, &sync);
+        num_active_reqs++;
+        if( !indices[num_active_reqs - 1] ) {
+            /* If the request is completed go ahead and mark it as such. One
+             * completed request is enough to satisfy the some condition, so
+             * there is no point in attaching the sync to the remaining ones.
+             */
+            assert( REQUEST_COMPLETE(request) );
+            num_requests_done++;
+            num_attached = i + 1;
+            break;
+        }
+    }
+
     sync_sets = num_active_reqs - num_requests_done;
     if( 0 == num_requests_done ) {
-        /* One completed request is enough to satisfy the some condition */
         SYNC_WAIT(&sync);
     }
 
@@ -448,7 +519,7 @@ int ompi_request_default_wait_some(size_t count,
     rptr = requests;
     num_requests_done = 0;
     num_active_reqs = 0;
-    for (size_t i = 0; i < count; i++, rptr++) {
+    for (size_t i = 0; i < num_attached; i++, rptr++) {
         void *_tmp_ptr = &sync;
 
         request = *rptr;
@@ -487,6 +558,7 @@ int ompi_request_default_wait_some(size_t count,
 
     WAIT_SYNC_RELEASE(&sync);
 
+  requests_completed:
     *outcount = num_requests_done;
 
     for (size_t i = 0; i < num_requests_done; i++) {
@@ -63,10 +63,15 @@ static void ompi_request_construct(ompi_request_t* req)
     req->req_complete_cb_data = NULL;
     req->req_f_to_c_index = MPI_UNDEFINED;
     req->req_mpi_object.comm = (struct ompi_communicator_t*) NULL;
+    req->req_cq           = NULL;
+    req->req_cq_index     = 0;
 }
 
 static void ompi_request_destruct(ompi_request_t* req)
 {
+    if (NULL != req->req_cq) {
+        ompi_request_cq_detach(req);
+    }
     assert( MPI_UNDEFINED == req->req_f_to_c_index );
     assert( OMPI_REQUEST_INVALID == req->req_state );
 }
@@ -106,6 +111,12 @@ OBJ_CLASS_INSTANCE(
 
 int ompi_request_init(void)
 {
+    int rc;
+
+    rc = ompi_request_cq_init();
+    if (OMPI_SUCCESS != rc) {
+        return rc;
+    }
 
     OBJ_CONSTRUCT(&ompi_request_null, ompi_request_t);
     OBJ_CONSTRUCT(&ompi_request_f_to_c_table, opal_pointer_array_t);
@@ -179,6 +190,7 @@ int ompi_request_init(void)
 
 int ompi_request_finalize(void)
 {
+    ompi_request_cq_finalize();
     OMPI_REQUEST_FINI( &ompi_request_null.request );
     OBJ_DESTRUCT( &ompi_request_null.request );
     OMPI_REQUEST_FINI( &ompi_request_empty );
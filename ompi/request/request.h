@@ -110,6 +110,11 @@ struct ompi_win_t;
  */
 struct ompi_file_t;
 
+/**
+ * Forward declaration
+ */
+struct ompi_request_cq_t;
+
 /**
  * Union for holding several different MPI pointer types on the request
  */
@@ -136,6 +141,8 @@ struct ompi_request_t {
     ompi_request_complete_fn_t req_complete_cb; /**< Called when the request is MPI completed */
     void *req_complete_cb_data;
     ompi_mpi_object_t req_mpi_object;           /**< Pointer to MPI object that created this request */
+    struct ompi_request_cq_t *req_cq;           /**< Completion queue the request is armed on (see req_cq.c) */
+    size_t req_cq_index;                        /**< Index of the request in the array tracked by req_cq */
 };
 
 /**
@@ -172,6 +179,9 @@ typedef struct ompi_predefined_request_t ompi_predefined_request_t;
         (request)->req_persistent = (persistent);               \
         (request)->req_complete_cb  = NULL;                     \
         (request)->req_complete_cb_data = NULL;                 \
+        if (OPAL_UNLIKELY(NULL != (request)->req_cq)) {         \
+            ompi_request_cq_detach(request);                    \
+        }                                                       \
     } while (0);
 
 
@@ -199,6 +209,9 @@ do {                                                                    \
                                     (request)->req_f_to_c_index, NULL); \
         (request)->req_f_to_c_index = MPI_UNDEFINED;                    \
     }                                                                   \
+    if (OPAL_UNLIKELY(NULL != (request)->req_cq)) {                     \
+        ompi_request_cq_detach(request);                                \
+    }                                                                   \
 } while (0);
 
 /**
@@ -359,6 +372,18 @@ int ompi_request_finalize(void);
  */
 int ompi_request_persistent_noop_create(ompi_request_t **request);
 
+/**
+ * Queue an armed request on its completion queue. Invoked by
+ * ompi_request_complete() for requests with a req_cq.
+ */
+OMPI_DECLSPEC void ompi_request_cq_notify(ompi_request_t *request);
+
+/**
+ * Remove a request from its completion queue. Invoked when the request
+ * is initialized, finalized or destructed while it is armed.
+ */
+OMPI_DECLSPEC void ompi_request_cq_detach(ompi_request_t *request);
+
 /**
  * Cancel a pending request.
  */
@@ -450,8 +475,17 @@ static inline int ompi_request_complete(ompi_request_t* request, bool with_signa
                 if( REQUEST_PENDING != tmp_sync )
                     wait_sync_update(tmp_sync, 1, request->req_status.MPI_ERROR);
             }
-        } else
+        } else {
             request->req_complete = REQUEST_COMPLETED;
+            /* pairs with the barrier between arming a request and checking
+             * its completion in req_cq.c */
+            opal_atomic_mb();
+        }
+
+        if (OPAL_UNLIKELY(NULL != request->req_cq)) {
+            /* a waitsome/testsome completion queue tracks this request */
+            ompi_request_cq_notify(request);
+        }
     }
 
     return OMPI_SUCCESS;
@@ -65,6 +65,32 @@ int ompi_request_default_wait_some(
                                    int * indices,
                                    ompi_status_public_t * statuses);
 
+/**
+ * Completion queue path of waitany, waitsome and testsome.
+ *
+ * @param count (IN)        Number of requests
+ * @param requests (IN)     Array of requests
+ * @param max (IN)          Maximum number of indices to return
+ * @param blocking (IN)     Wait until at least one request completed
+ * @param outcount (OUT)    Number of completed requests or MPI_UNDEFINED
+ * @param indices (OUT)     Indices of the completed requests
+ * @return                  OMPI_SUCCESS, or OMPI_ERR_NOT_AVAILABLE if the
+ *                          array is not tracked by a completion queue and
+ *                          the caller has to scan it.
+ *
+ * The completed requests are neither freed nor marked inactive.
+ */
+int ompi_request_cq_some(size_t count,
+                         ompi_request_t ** requests,
+                         size_t max,
+                         bool blocking,
+                         int * outcount,
+                         int * indices);
+
+int ompi_request_cq_init(void);
+
+int ompi_request_cq_finalize(void);
+
 END_C_DECLS
 
 #endif
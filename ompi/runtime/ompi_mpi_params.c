@@ -74,6 +74,7 @@ bool ompi_async_mpi_finalize = false;
 #define OMPI_ADD_PROCS_CUTOFF_DEFAULT 0
 uint32_t ompi_add_procs_cutoff = OMPI_ADD_PROCS_CUTOFF_DEFAULT;
 bool ompi_mpi_dynamics_enabled = true;
+unsigned int ompi_request_cq_min_count = 256;
 
 char *ompi_mpi_spc_attach_string = NULL;
 bool ompi_mpi_spc_dump_enabled = false;
@@ -288,6 +289,16 @@ int ompi_mpi_register_params(void)
                                   0, 0, OPAL_INFO_LVL_3, MCA_BASE_VAR_SCOPE_LOCAL,
                                   &ompi_add_procs_cutoff);
 
+    ompi_request_cq_min_count = 256;
+    (void) mca_base_var_register ("ompi", "mpi", NULL, "request_cq_min_count",
+                                  "Minimum number of requests passed to MPI_Waitany, MPI_Waitsome or "
+                                  "MPI_Testsome for the request array to be tracked by a completion "
+                                  "queue. Repeated calls on a tracked array only look at the requests "
+                                  "that completed since the previous call (0 disables completion queues)",
+                                  MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL,
+                                  0, 0, OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                  &ompi_request_cq_min_count);
+
     ompi_mpi_dynamics_enabled = true;
     (void) mca_base_var_register("ompi", "mpi", NULL, "dynamics_enabled",
                                  "Is the MPI dynamic process functionality enabled (e.g., MPI_COMM_SPAWN)?  Default is yes, but certain transports and/or environments may disable it.",
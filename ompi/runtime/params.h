@@ -129,6 +129,12 @@ OMPI_DECLSPEC extern bool ompi_use_sparse_group_storage;
  */
 OMPI_DECLSPEC extern uint32_t ompi_add_procs_cutoff;
 
+/**
+ * Minimum size of the request arrays tracked by a completion queue in
+ * waitany/waitsome/testsome (0: never)
+ */
+OMPI_DECLSPEC extern unsigned int ompi_request_cq_min_count;
+
 /**
  * Whether anything in the code base has disabled MPI dynamic process
  * functionality or not
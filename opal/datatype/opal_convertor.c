@@ -27,8 +27,11 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "opal/prefetch.h"
+#include "opal/sys/atomic.h"
 #include "opal/util/arch.h"
 #include "opal/util/output.h"
 
@@ -269,6 +272,18 @@ complete_contiguous_data_pack:
         return 1;
     }
 
+    if( OPAL_UNLIKELY(pConv->flags & CONVERTOR_STACK_STALE) &&
+        (opal_pack_kernel != pConv->fAdvance) ) {
+        opal_convertor_rebuild_stack( pConv );
+    }
+
+    if( OPAL_UNLIKELY(opal_ddt_pack_threads > 0) && (iov[0].iov_len >= opal_ddt_pack_threads_min_size) ) {
+        int32_t rc = opal_convertor_parallel_advance( pConv, iov, out_size, max_data );
+        if( OPAL_ERR_NOT_AVAILABLE != rc ) {
+            return rc;
+        }
+    }
+
     return pConv->fAdvance( pConv, iov, out_size, max_data );
 }
 
@@ -321,6 +336,18 @@ complete_contiguous_data_unpack:
         return 1;
     }
 
+    if( OPAL_UNLIKELY(pConv->flags & CONVERTOR_STACK_STALE) &&
+        (opal_unpack_kernel != pConv->fAdvance) ) {
+        opal_convertor_rebuild_stack( pConv );
+    }
+
+    if( OPAL_UNLIKELY(opal_ddt_pack_threads > 0) && (iov[0].iov_len >= opal_ddt_pack_threads_min_size) ) {
+        int32_t rc = opal_convertor_parallel_advance( pConv, iov, out_size, max_data );
+        if( OPAL_ERR_NOT_AVAILABLE != rc ) {
+            return rc;
+        }
+    }
+
     return pConv->fAdvance( pConv, iov, out_size, max_data );
 }
 
@@ -410,11 +437,133 @@ opal_convertor_create_stack_at_begining( opal_convertor_t* convertor,
 }
 
 
+/**
+ * Take a snapshot of the stack of a convertor on one instance of the datatype
+ * every interval bytes.
+ */
+static opal_datatype_checkpoints_t*
+opal_convertor_build_checkpoints( const opal_convertor_t* convertor )
+{
+    const opal_datatype_t* pData = convertor->pDesc;
+    opal_datatype_checkpoints_t* ckpts;
+    size_t interval = opal_ddt_checkpoint_interval, position;
+    uint32_t count, depth = convertor->stack_size;
+    opal_convertor_t conv;
+
+    if( (pData->size / interval) > OPAL_DATATYPE_MAX_CHECKPOINTS ) {
+        interval = (pData->size + OPAL_DATATYPE_MAX_CHECKPOINTS - 1) / OPAL_DATATYPE_MAX_CHECKPOINTS;
+    }
+    count = (uint32_t)((pData->size - 1) / interval);
+
+    ckpts = (opal_datatype_checkpoints_t*)malloc( sizeof(opal_datatype_checkpoints_t) +
+                                                  count * (sizeof(size_t) + sizeof(int32_t)) +
+                                                  count * depth * sizeof(dt_stack_t) );
+    if( OPAL_UNLIKELY(NULL == ckpts) ) {
+        return NULL;
+    }
+    ckpts->interval  = interval;
+    ckpts->count     = count;
+    ckpts->depth     = depth;
+    ckpts->stack     = (dt_stack_t*)(ckpts + 1);
+    ckpts->position  = (size_t*)(ckpts->stack + count * depth);
+    ckpts->stack_pos = (int32_t*)(ckpts->position + count);
+    if( 0 == count ) {
+        return ckpts;
+    }
+
+    /* walk one instance, with a NULL base the saved displacements are relative to the instance */
+    OBJ_CONSTRUCT( &conv, opal_convertor_t );
+    opal_convertor_clone( convertor, &conv, 0 );
+    conv.flags     &= ~(CONVERTOR_STACK_STALE | CONVERTOR_COMPLETED);
+    conv.count      = 1;
+    conv.local_size = pData->size;
+    conv.pBaseBuf   = NULL;
+    opal_convertor_create_stack_at_begining( &conv, opal_datatype_local_sizes );
+    for( uint32_t i = 0; i < count; i++ ) {
+        position = (i + 1) * interval;
+        opal_convertor_generic_simple_position( &conv, &position );
+        /* the stack is on the boundary of the partially converted predefined type */
+        ckpts->position[i]  = conv.bConverted - conv.partial_length;
+        ckpts->stack_pos[i] = conv.stack_pos;
+        memcpy( ckpts->stack + i * depth, conv.pStack, (conv.stack_pos + 1) * sizeof(dt_stack_t) );
+    }
+    OBJ_DESTRUCT( &conv );
+
+    return ckpts;
+}
+
+/**
+ * Move the convertor to the last checkpoint before position, if it is ahead
+ * of the current position of the convertor.
+ */
+static inline void
+opal_convertor_position_from_checkpoint( opal_convertor_t* convertor, size_t position )
+{
+    opal_datatype_t* pData = (opal_datatype_t*)convertor->pDesc;
+    opal_datatype_checkpoints_t* ckpts = OPAL_DATATYPE_CACHE_OWNER(pData)->checkpoints;
+    size_t instance, checkpoint;
+    ptrdiff_t shift;
+
+    if( OPAL_UNLIKELY(NULL == ckpts) ) {
+        intptr_t expected = 0;
+
+        ckpts = opal_convertor_build_checkpoints( convertor );
+        if( NULL == ckpts ) return;
+        /* another thread might have been faster */
+        if( !opal_atomic_compare_exchange_strong_ptr( (opal_atomic_intptr_t*)&OPAL_DATATYPE_CACHE_OWNER(pData)->checkpoints,
+                                                      &expected, (intptr_t)ckpts ) ) {
+            free( ckpts );
+            ckpts = (opal_datatype_checkpoints_t*)expected;
+        }
+    }
+
+    instance   = position / pData->size;
+    checkpoint = (position % pData->size) / ckpts->interval;
+    if( (0 == checkpoint) || (convertor->stack_size < ckpts->depth) ) return;
+    if( checkpoint > ckpts->count ) checkpoint = ckpts->count;
+    checkpoint--;
+
+    if( (instance * pData->size + ckpts->position[checkpoint]) <= convertor->bConverted ) {
+        return;  /* closer from where we are */
+    }
+
+    shift = (ptrdiff_t)instance * (pData->ub - pData->lb);
+    memcpy( convertor->pStack, ckpts->stack + checkpoint * ckpts->depth,
+            (ckpts->stack_pos[checkpoint] + 1) * sizeof(dt_stack_t) );
+    convertor->stack_pos = ckpts->stack_pos[checkpoint];
+    for( int32_t i = 0; i <= convertor->stack_pos; i++ ) {
+        convertor->pStack[i].disp += shift;
+    }
+    convertor->pStack[0].count  = convertor->count - instance;
+    convertor->bConverted       = instance * pData->size + ckpts->position[checkpoint];
+    convertor->partial_length   = 0;
+}
+
 int32_t opal_convertor_set_position_nocheck( opal_convertor_t* convertor,
                                              size_t* position )
 {
     int32_t rc;
 
+    if( OPAL_UNLIKELY(convertor->flags & CONVERTOR_STACK_STALE) ) {
+        /**
+         * The specialized kernels compute their state from bConverted, there is
+         * no stack to rebuild. Like the generic engine, keep the send convertors on
+         * predefined datatypes boundaries.
+         */
+        if( (opal_pack_kernel == convertor->fAdvance) || (opal_unpack_kernel == convertor->fAdvance) ) {
+            const opal_datatype_kernel_t* kernel = convertor->pDesc->kernel;
+            if( CONVERTOR_SEND & convertor->flags ) {
+                *position -= ((*position) % convertor->pDesc->size) % kernel->blocklen % kernel->elem_size;
+            }
+            convertor->bConverted     = *position;
+            convertor->partial_length = 0;
+            return OPAL_SUCCESS;
+        }
+        /* the stack cannot be trusted, restart from the begining */
+        convertor->flags &= ~CONVERTOR_STACK_STALE;
+        convertor->bConverted = convertor->local_size;
+    }
+
     /**
      * create_stack_with_pos_contig always set the position relative to the ZERO
      * position, so there is no need for special handling. In all other cases,
@@ -429,7 +578,15 @@ int32_t opal_convertor_set_position_nocheck( opal_convertor_t* convertor,
             rc = opal_convertor_create_stack_at_begining( convertor, opal_datatype_local_sizes );
             if( 0 == (*position) ) return rc;
         }
-        rc = opal_convertor_generic_simple_position( convertor, position );
+        if( (0 != opal_ddt_checkpoint_interval) &&
+            (((*position) - convertor->bConverted) > opal_ddt_checkpoint_interval) &&
+            (convertor->use_desc == &convertor->pDesc->opt_desc) ) {
+            opal_convertor_position_from_checkpoint( convertor, *position );
+        }
+        rc = OPAL_SUCCESS;
+        if( (*position) != convertor->bConverted ) {
+            rc = opal_convertor_generic_simple_position( convertor, position );
+        }
         /**
          * If we have a non-contigous send convertor don't allow it move in the middle
          * of a predefined datatype, it won't be able to copy out the left-overs
@@ -446,6 +603,15 @@ int32_t opal_convertor_set_position_nocheck( opal_convertor_t* convertor,
     return rc;
 }
 
+int32_t opal_convertor_rebuild_stack( opal_convertor_t* convertor )
+{
+    size_t position = convertor->bConverted;
+
+    convertor->flags &= ~CONVERTOR_STACK_STALE;
+    convertor->bConverted = convertor->local_size;  /* force a restart from the begining */
+    return opal_convertor_set_position_nocheck( convertor, &position );
+}
+
 static size_t
 opal_datatype_compute_remote_size( const opal_datatype_t* pData,
                                    const size_t* sizes )
@@ -562,6 +728,21 @@ size_t opal_convertor_compute_remote_size( opal_convertor_t* pConvertor )
     }
 
 
+/*
+ * Replace the generic engine by the specialized kernel built when the datatype
+ * was committed, if any. The kernels only handle local representations in host
+ * memory.
+ */
+static inline void
+opal_convertor_select_kernel( opal_convertor_t* convertor, convertor_advance_fct_t fct )
+{
+    if( (NULL != convertor->pDesc->kernel) &&
+        !(convertor->flags & (CONVERTOR_CUDA | CONVERTOR_CUDA_UNIFIED)) ) {
+        convertor->fAdvance = fct;
+        convertor->flags   |= CONVERTOR_STACK_STALE;
+    }
+}
+
 int32_t opal_convertor_prepare_for_recv( opal_convertor_t* convertor,
                                          const struct opal_datatype_t* datatype,
                                          size_t count,
@@ -599,6 +780,7 @@ int32_t opal_convertor_prepare_for_recv( opal_convertor_t* convertor,
                 convertor->fAdvance = opal_unpack_homogeneous_contig;
             } else {
                 convertor->fAdvance = opal_generic_simple_unpack;
+                opal_convertor_select_kernel( convertor, opal_unpack_kernel );
             }
         }
     return OPAL_SUCCESS;
@@ -647,6 +829,7 @@ int32_t opal_convertor_prepare_for_send( opal_convertor_t* convertor,
                     convertor->fAdvance = opal_pack_homogeneous_contig_with_gaps;
             } else {
                 convertor->fAdvance = opal_generic_simple_pack;
+                opal_convertor_select_kernel( convertor, opal_pack_kernel );
             }
         }
     return OPAL_SUCCESS;
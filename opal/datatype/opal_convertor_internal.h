@@ -49,6 +49,33 @@ opal_convertor_master_t* opal_convertor_find_or_create_master( uint32_t remote_a
  */
 void opal_convertor_destroy_masters( void );
 
+/*
+ * Rebuild the stack of a convertor flagged with CONVERTOR_STACK_STALE for the
+ * current position (bConverted), so that the generic engine can continue from
+ * there.
+ */
+int32_t opal_convertor_rebuild_stack( opal_convertor_t* convertor );
+
+/*
+ * Split a large conversion in ranges converted concurrently by helper threads
+ * (see mpi_ddt_pack_threads). Returns OPAL_ERR_NOT_AVAILABLE without touching
+ * the convertor when the conversion is not eligible, otherwise the same values
+ * as opal_convertor_pack and opal_convertor_unpack.
+ */
+int32_t opal_convertor_parallel_advance( opal_convertor_t* pConv,
+                                         struct iovec* iov, uint32_t* out_size,
+                                         size_t* max_data );
+
+/*
+ * Reset the helper thread pool, they are started on demand.
+ */
+void opal_convertor_parallel_init( void );
+
+/*
+ * Stop the helper threads.
+ */
+void opal_convertor_parallel_fini( void );
+
 
 END_C_DECLS
 
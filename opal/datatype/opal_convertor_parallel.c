@@ -0,0 +1,251 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Parallel conversion of very large non-contiguous buffers.
+ *
+ * A conversion is split into independent ranges of the packed stream. Each
+ * range gets its own copy of the convertor, moved to the beginning of the
+ * range with opal_convertor_set_position, and is converted by one of the
+ * helper threads. The calling thread converts the last range with the
+ * original convertor, so that once all the ranges are done the convertor is
+ * in the same state as after a sequential conversion.
+ *
+ * The split points are moved back to predefined datatype boundaries, so a
+ * range never starts or ends in the middle of a basic element.
+ *
+ * The helper threads are only used by applications that do not call into
+ * the library from several threads (!opal_using_threads()): there is a
+ * single set of jobs, and a multithreaded application is likely to keep
+ * the cores busy on its own.
+ */
+
+#include "opal_config.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "opal/constants.h"
+#include "opal/sys/atomic.h"
+#include "opal/threads/threads.h"
+#include "opal/threads/thread_usage.h"
+#include "opal/datatype/opal_convertor_internal.h"
+#include "opal/datatype/opal_datatype_internal.h"
+
+typedef struct opal_convertor_parallel_job_t {
+    opal_convertor_t convertor;
+    struct iovec     iov;
+    size_t           max_data;
+} opal_convertor_parallel_job_t;
+
+static struct {
+    pthread_mutex_t                 lock;
+    pthread_cond_t                  cond;
+    uint32_t                        generation;  /**< incremented for each batch of jobs */
+    bool                            shutdown;
+    opal_atomic_int32_t             pending;     /**< jobs of the current batch not yet done */
+    int                             nthreads;
+    opal_thread_t                  *threads;
+    opal_convertor_parallel_job_t  *jobs;
+} opal_convertor_parallel_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void *opal_convertor_parallel_worker( opal_object_t *obj )
+{
+    opal_thread_t *thread = (opal_thread_t *) obj;
+    opal_convertor_parallel_job_t *job = (opal_convertor_parallel_job_t *) thread->t_arg;
+    uint32_t generation = 0;
+
+    while( 1 ) {
+        pthread_mutex_lock( &opal_convertor_parallel_pool.lock );
+        while( (generation == opal_convertor_parallel_pool.generation) &&
+               !opal_convertor_parallel_pool.shutdown ) {
+            pthread_cond_wait( &opal_convertor_parallel_pool.cond, &opal_convertor_parallel_pool.lock );
+        }
+        generation = opal_convertor_parallel_pool.generation;
+        pthread_mutex_unlock( &opal_convertor_parallel_pool.lock );
+
+        if( opal_convertor_parallel_pool.shutdown ) {
+            break;
+        }
+
+        if( 0 != job->iov.iov_len ) {
+            uint32_t iov_count = 1;
+            (void) job->convertor.fAdvance( &job->convertor, &job->iov, &iov_count, &job->max_data );
+        }
+        opal_atomic_wmb();
+        (void) opal_atomic_add_fetch_32( &opal_convertor_parallel_pool.pending, -1 );
+    }
+
+    return NULL;
+}
+
+static int opal_convertor_parallel_start( void )
+{
+    int nthreads = opal_ddt_pack_threads;
+
+    opal_convertor_parallel_pool.threads = (opal_thread_t *) calloc( nthreads, sizeof(opal_thread_t) );
+    opal_convertor_parallel_pool.jobs = (opal_convertor_parallel_job_t *) calloc( nthreads, sizeof(opal_convertor_parallel_job_t) );
+    if( NULL == opal_convertor_parallel_pool.threads || NULL == opal_convertor_parallel_pool.jobs ) {
+        opal_convertor_parallel_fini();
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    for( int i = 0; i < nthreads; i++ ) {
+        opal_thread_t *thread = opal_convertor_parallel_pool.threads + i;
+
+        OBJ_CONSTRUCT(thread, opal_thread_t);
+        thread->t_run = opal_convertor_parallel_worker;
+        thread->t_arg = opal_convertor_parallel_pool.jobs + i;
+        if( OPAL_SUCCESS != opal_thread_start( thread ) ) {
+            OBJ_DESTRUCT(thread);
+            break;
+        }
+        opal_convertor_parallel_pool.nthreads++;
+    }
+
+    if( 0 == opal_convertor_parallel_pool.nthreads ) {
+        opal_convertor_parallel_fini();
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    return OPAL_SUCCESS;
+}
+
+void opal_convertor_parallel_init( void )
+{
+    /* the helper threads are started by the first eligible conversion. A
+     * previous finalize left the pool shut down, and new threads must not
+     * see a generation they have not been given jobs for. */
+    pthread_mutex_lock( &opal_convertor_parallel_pool.lock );
+    opal_convertor_parallel_pool.shutdown   = false;
+    opal_convertor_parallel_pool.generation = 0;
+    opal_convertor_parallel_pool.pending    = 0;
+    pthread_mutex_unlock( &opal_convertor_parallel_pool.lock );
+}
+
+void opal_convertor_parallel_fini( void )
+{
+    pthread_mutex_lock( &opal_convertor_parallel_pool.lock );
+    opal_convertor_parallel_pool.shutdown = true;
+    pthread_cond_broadcast( &opal_convertor_parallel_pool.cond );
+    pthread_mutex_unlock( &opal_convertor_parallel_pool.lock );
+
+    for( int i = 0; i < opal_convertor_parallel_pool.nthreads; i++ ) {
+        opal_thread_join( opal_convertor_parallel_pool.threads + i, NULL );
+        OBJ_DESTRUCT(opal_convertor_parallel_pool.threads + i);
+    }
+
+    free( opal_convertor_parallel_pool.threads );
+    free( opal_convertor_parallel_pool.jobs );
+    opal_convertor_parallel_pool.threads = NULL;
+    opal_convertor_parallel_pool.jobs = NULL;
+    opal_convertor_parallel_pool.nthreads = 0;
+}
+
+/**
+ * Move the convertor to the predefined datatype boundary at or before
+ * position.
+ */
+static inline size_t
+opal_convertor_parallel_set_position( opal_convertor_t* convertor, size_t position )
+{
+    opal_convertor_set_position( convertor, &position );
+    if( 0 != convertor->partial_length ) {
+        /* only the receivers can stop in the middle of a predefined type */
+        position = convertor->bConverted - convertor->partial_length;
+        opal_convertor_set_position( convertor, &position );
+    }
+    return convertor->bConverted;
+}
+
+int32_t opal_convertor_parallel_advance( opal_convertor_t* pConv,
+                                         struct iovec* iov, uint32_t* out_size,
+                                         size_t* max_data )
+{
+    static bool in_use = false;
+    opal_convertor_parallel_job_t *jobs;
+    unsigned char *base = (unsigned char *) iov[0].iov_base;
+    size_t start, length, chunk, position, end;
+    uint32_t iov_count = 1;
+    int nthreads;
+    int32_t rc;
+
+    if( (1 != *out_size) || (NULL == base) || opal_using_threads() || in_use ||
+        (0 != pConv->partial_length) || !(pConv->flags & CONVERTOR_HOMOGENEOUS) ||
+        (pConv->flags & (CONVERTOR_CUDA | CONVERTOR_CUDA_UNIFIED | CONVERTOR_WITH_CHECKSUM)) ) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+    start  = pConv->bConverted;
+    length = pConv->local_size - start;
+    if( length > iov[0].iov_len ) length = iov[0].iov_len;
+    if( length < opal_ddt_pack_threads_min_size ) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+    if( OPAL_UNLIKELY(0 == opal_convertor_parallel_pool.nthreads) ) {
+        if( opal_convertor_parallel_pool.shutdown || OPAL_SUCCESS != opal_convertor_parallel_start() ) {
+            return OPAL_ERR_NOT_AVAILABLE;
+        }
+    }
+    in_use   = true;
+    jobs     = opal_convertor_parallel_pool.jobs;
+    nthreads = opal_convertor_parallel_pool.nthreads;
+    chunk    = length / (nthreads + 1);
+
+    /* the first range starts at the current position, the last one is
+     * converted by the original convertor */
+    for( int i = 0; i < nthreads; i++ ) {
+        opal_convertor_parallel_job_t *job = jobs + i;
+
+        OBJ_CONSTRUCT(&job->convertor, opal_convertor_t);
+        opal_convertor_clone( pConv, &job->convertor, 0 == i );
+        if( 0 != i ) {
+            (void) opal_convertor_parallel_set_position( &job->convertor, start + chunk * i );
+        }
+        job->iov.iov_base = (IOVBASE_TYPE *)(base + (job->convertor.bConverted - start));
+        job->max_data     = 0;
+    }
+    position = opal_convertor_parallel_set_position( pConv, start + chunk * nthreads );
+    for( int i = 0; i < nthreads; i++ ) {
+        end = (i + 1 < nthreads) ? jobs[i + 1].convertor.bConverted : position;
+        jobs[i].iov.iov_len = end - jobs[i].convertor.bConverted;
+    }
+
+    opal_convertor_parallel_pool.pending = nthreads;
+    opal_atomic_wmb();
+    pthread_mutex_lock( &opal_convertor_parallel_pool.lock );
+    opal_convertor_parallel_pool.generation++;
+    pthread_cond_broadcast( &opal_convertor_parallel_pool.cond );
+    pthread_mutex_unlock( &opal_convertor_parallel_pool.lock );
+
+    iov[0].iov_base = (IOVBASE_TYPE *)(base + (position - start));
+    iov[0].iov_len  = start + length - position;
+    rc = pConv->fAdvance( pConv, iov, &iov_count, max_data );
+
+    while( 0 != opal_convertor_parallel_pool.pending ) {
+        opal_atomic_rmb();
+    }
+    opal_atomic_rmb();
+
+    for( int i = 0; i < nthreads; i++ ) {
+        /* the ranges end on predefined datatype boundaries, they are always complete */
+        assert( jobs[i].max_data == jobs[i].iov.iov_len );
+        OBJ_DESTRUCT(&jobs[i].convertor);
+    }
+    in_use = false;
+
+    iov[0].iov_base = (IOVBASE_TYPE *) base;
+    iov[0].iov_len  = *max_data = pConv->bConverted - start;
+    *out_size = 1;
+    return rc;
+}
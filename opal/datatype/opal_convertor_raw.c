@@ -17,9 +17,12 @@
 #include "opal_config.h"
 
 #include <stddef.h>
+#include <stdlib.h>
 
 #include "opal/datatype/opal_convertor_internal.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/sys/atomic.h"
+#include "opal/util/arch.h"
 #include "opal_stdint.h"
 
 #if OPAL_ENABLE_DEBUG
@@ -30,6 +33,9 @@
 #define DO_DEBUG(INST)
 #endif /* OPAL_ENABLE_DEBUG */
 
+/* number of iovecs generated at once while building the flattened description */
+#define OPAL_DATATYPE_IOV_CACHE_CHUNK 32
+
 /* Take a new iovec (base + len) and try to merge it with what we already
  * have. If we succeed return 0 and move forward, otherwise save it into a new
  * iovec location. If we need to advance position and we reach the end
@@ -54,14 +60,13 @@ opal_convertor_merge_iov( struct iovec* iov, uint32_t* iov_count,
 }
 
 /**
- * This function always work in local representation. This means no representation
- * conversion (i.e. no heterogeneity) is taken into account, and that all
- * length we're working on are local.
+ * Walk the description stack of the datatype and generate the iovecs. This is
+ * the slow path, used when the flattened description is not available.
  */
-int32_t
-opal_convertor_raw( opal_convertor_t* pConvertor,
-                    struct iovec* iov, uint32_t* iov_count,
-                    size_t* length )
+static int32_t
+opal_convertor_raw_generic( opal_convertor_t* pConvertor,
+                            struct iovec* iov, uint32_t* iov_count,
+                            size_t* length )
 {
     const opal_datatype_t *pData = pConvertor->pDesc;
     dt_stack_t* pStack;       /* pointer to the position on the stack */
@@ -73,30 +78,9 @@ opal_convertor_raw( opal_convertor_t* pConvertor,
     size_t sum_iov_len = 0;      /* sum of raw data lengths in the iov_len fields */
     uint32_t index = 0;          /* the iov index and a simple counter */
 
-    assert( (*iov_count) > 0 );
-    if( OPAL_LIKELY(pConvertor->flags & CONVERTOR_COMPLETED) ) {
-        iov[0].iov_base = NULL;
-        iov[0].iov_len  = 0;
-        *iov_count      = 0;
-        *length         = iov[0].iov_len;
-        return 1;  /* We're still done */
+    if( OPAL_UNLIKELY(pConvertor->flags & CONVERTOR_STACK_STALE) ) {
+        opal_convertor_rebuild_stack( pConvertor );
     }
-    if( OPAL_LIKELY(pConvertor->flags & CONVERTOR_NO_OP) ) {
-        /* The convertor contain minimal informations, we only use the bConverted
-         * to manage the conversion. This function work even after the convertor
-         * was moved to a specific position.
-         */
-        opal_convertor_get_current_pointer( pConvertor, (void**)&iov[0].iov_base );
-        iov[0].iov_len = pConvertor->local_size - pConvertor->bConverted;
-        *length = iov[0].iov_len;
-        pConvertor->bConverted = pConvertor->local_size;
-        pConvertor->flags |= CONVERTOR_COMPLETED;
-        *iov_count = 1;
-        return 1;  /* we're done */
-    }
-
-    DO_DEBUG( opal_output( 0, "opal_convertor_raw( %p, {%p, %" PRIu32 "}, %"PRIsize_t " )\n", (void*)pConvertor,
-                           (void*)iov, *iov_count, *length ); );
 
     description = pConvertor->use_desc->desc;
 
@@ -263,3 +247,228 @@ opal_convertor_raw( opal_convertor_t* pConvertor,
                            pConvertor->stack_pos, pStack->index, pStack->count, (long)pStack->disp ); );
     return 0;
 }
+
+/**
+ * Record the layout of one instance of the datatype as a list of runs. Returns
+ * a cache without runs if the datatype needs more than the allowed number of
+ * runs, and NULL if the cache cannot be built.
+ */
+static opal_datatype_iov_cache_t*
+opal_datatype_iov_cache_build( const opal_datatype_t* pData )
+{
+    struct iovec iov[OPAL_DATATYPE_IOV_CACHE_CHUNK];
+    uint32_t max_runs = (uint32_t)opal_ddt_iov_cache_max_runs;
+    opal_datatype_iov_run_t* run = NULL;
+    opal_datatype_iov_cache_t* cache;
+    opal_convertor_t* pConv;
+    size_t length, packed = 0;
+    uint32_t iov_count;
+    int32_t rc;
+
+    cache = (opal_datatype_iov_cache_t*)malloc( sizeof(opal_datatype_iov_cache_t) +
+                                                max_runs * sizeof(opal_datatype_iov_run_t) );
+    if( OPAL_UNLIKELY(NULL == cache) ) {
+        return NULL;
+    }
+    cache->nruns = 0;
+
+    pConv = opal_convertor_create( opal_local_arch, 0 );
+    if( OPAL_UNLIKELY(NULL == pConv) ) {
+        free( cache );
+        return NULL;
+    }
+    /* with a NULL base the iovec addresses are the displacements in the instance */
+    if( OPAL_UNLIKELY(OPAL_SUCCESS != opal_convertor_prepare_for_send( pConv, pData, 1, NULL )) ) {
+        OBJ_RELEASE( pConv );
+        free( cache );
+        return NULL;
+    }
+
+    if( pConv->flags & CONVERTOR_NO_OP ) {
+        run = &cache->runs[cache->nruns++];
+        run->disp   = pData->true_lb;
+        run->stride = 0;
+        run->len    = pData->size;
+        run->count  = 1;
+        run->packed = 0;
+        goto cleanup;
+    }
+
+    do {
+        iov_count = OPAL_DATATYPE_IOV_CACHE_CHUNK;
+        rc = opal_convertor_raw_generic( pConv, iov, &iov_count, &length );
+        for( uint32_t i = 0; i < iov_count; i++ ) {
+            ptrdiff_t disp = (ptrdiff_t)iov[i].iov_base;
+            size_t len = iov[i].iov_len;
+
+            if( 0 == len ) continue;
+            if( NULL != run ) {
+                if( (1 == run->count) && (disp == (run->disp + (ptrdiff_t)run->len)) ) {
+                    run->len += len;  /* contiguous with the previous piece */
+                    packed += len;
+                    continue;
+                }
+                if( len == run->len ) {
+                    if( 1 == run->count ) {
+                        run->stride = disp - run->disp;
+                        run->count  = 2;
+                        packed += len;
+                        continue;
+                    }
+                    if( disp == (run->disp + (ptrdiff_t)run->count * run->stride) ) {
+                        run->count++;
+                        packed += len;
+                        continue;
+                    }
+                }
+            }
+            if( cache->nruns == max_runs ) {
+                /* not worth it, remember that this datatype should not be cached */
+                cache->nruns = 0;
+                goto cleanup;
+            }
+            run = &cache->runs[cache->nruns++];
+            run->disp   = disp;
+            run->stride = 0;
+            run->len    = len;
+            run->count  = 1;
+            run->packed = packed;
+            packed += len;
+        }
+    } while( 1 != rc );
+    assert( packed == pData->size );
+
+ cleanup:
+    OBJ_RELEASE( pConv );
+    if( cache->nruns < max_runs ) {  /* give back the unused runs */
+        opal_datatype_iov_cache_t* shrunk;
+        shrunk = (opal_datatype_iov_cache_t*)realloc( cache, sizeof(opal_datatype_iov_cache_t) +
+                                                      cache->nruns * sizeof(opal_datatype_iov_run_t) );
+        if( NULL != shrunk ) cache = shrunk;
+    }
+    return cache;
+}
+
+/**
+ * Generate the iovecs from the flattened description. Only bConverted is used
+ * and updated, the stack of the convertor is left untouched.
+ */
+static int32_t
+opal_convertor_raw_cached( opal_convertor_t* pConvertor, const opal_datatype_iov_cache_t* cache,
+                           struct iovec* iov, uint32_t* iov_count,
+                           size_t* length )
+{
+    const opal_datatype_t *pData = pConvertor->pDesc;
+    const ptrdiff_t extent = pData->ub - pData->lb;
+    size_t instance = pConvertor->bConverted / pData->size;
+    size_t offset = pConvertor->bConverted % pData->size;
+    const opal_datatype_iov_run_t* run;
+    unsigned char *source_base;
+    size_t sum_iov_len = 0, piece, skip;
+    uint32_t index = 0, lo = 0, hi = cache->nruns - 1;
+
+    /* find the run holding the current position */
+    while( lo < hi ) {
+        uint32_t mid = (lo + hi + 1) / 2;
+        if( cache->runs[mid].packed <= offset ) lo = mid;
+        else hi = mid - 1;
+    }
+    run   = &cache->runs[lo];
+    piece = (offset - run->packed) / run->len;
+    skip  = (offset - run->packed) % run->len;
+
+    source_base = pConvertor->pBaseBuf + instance * extent;
+    iov[0].iov_len = 0;
+    while( instance < pConvertor->count ) {
+        for( ; piece < run->count; piece++ ) {
+            size_t blength = run->len - skip;
+            if( opal_convertor_merge_iov( iov, iov_count,
+                                          (IOVBASE_TYPE *)(source_base + run->disp + (ptrdiff_t)piece * run->stride + skip),
+                                          blength, &index ) )
+                goto complete_loop;  /* no more iovec available, bail out */
+            sum_iov_len += blength;
+            skip = 0;
+        }
+        piece = 0;
+        if( ++run == (cache->runs + cache->nruns) ) {  /* next instance */
+            run = cache->runs;
+            instance++;
+            source_base += extent;
+        }
+    }
+    index++;  /* account for the currently updating iovec */
+
+ complete_loop:
+    pConvertor->bConverted += sum_iov_len;  /* update the already converted bytes */
+    *length = sum_iov_len;
+    *iov_count = index;
+    if( pConvertor->bConverted == pConvertor->local_size ) {
+        pConvertor->flags |= CONVERTOR_COMPLETED;
+        return 1;
+    }
+    /* the stack no longer matches the position */
+    pConvertor->flags |= CONVERTOR_STACK_STALE;
+    return 0;
+}
+
+/**
+ * This function always work in local representation. This means no representation
+ * conversion (i.e. no heterogeneity) is taken into account, and that all
+ * length we're working on are local.
+ */
+int32_t
+opal_convertor_raw( opal_convertor_t* pConvertor,
+                    struct iovec* iov, uint32_t* iov_count,
+                    size_t* length )
+{
+    opal_datatype_t *pData = (opal_datatype_t*)pConvertor->pDesc;
+    opal_datatype_iov_cache_t* cache;
+
+    assert( (*iov_count) > 0 );
+    if( OPAL_LIKELY(pConvertor->flags & CONVERTOR_COMPLETED) ) {
+        iov[0].iov_base = NULL;
+        iov[0].iov_len  = 0;
+        *iov_count      = 0;
+        *length         = iov[0].iov_len;
+        return 1;  /* We're still done */
+    }
+    if( OPAL_LIKELY(pConvertor->flags & CONVERTOR_NO_OP) ) {
+        /* The convertor contain minimal informations, we only use the bConverted
+         * to manage the conversion. This function work even after the convertor
+         * was moved to a specific position.
+         */
+        opal_convertor_get_current_pointer( pConvertor, (void**)&iov[0].iov_base );
+        iov[0].iov_len = pConvertor->local_size - pConvertor->bConverted;
+        *length = iov[0].iov_len;
+        pConvertor->bConverted = pConvertor->local_size;
+        pConvertor->flags |= CONVERTOR_COMPLETED;
+        *iov_count = 1;
+        return 1;  /* we're done */
+    }
+
+    DO_DEBUG( opal_output( 0, "opal_convertor_raw( %p, {%p, %" PRIu32 "}, %"PRIsize_t " )\n", (void*)pConvertor,
+                           (void*)iov, *iov_count, *length ); );
+
+    if( (opal_ddt_iov_cache_max_runs > 0) && (0 != pData->size) &&
+        (pData->flags & OPAL_DATATYPE_FLAG_COMMITTED) &&
+        !(pData->flags & OPAL_DATATYPE_FLAG_PREDEFINED) ) {
+        cache = OPAL_DATATYPE_CACHE_OWNER(pData)->iov_cache;
+        if( OPAL_UNLIKELY(NULL == cache) ) {
+            cache = opal_datatype_iov_cache_build( pData );
+            if( NULL != cache ) {
+                intptr_t expected = 0;
+                /* another thread might have been faster */
+                if( !opal_atomic_compare_exchange_strong_ptr( (opal_atomic_intptr_t*)&OPAL_DATATYPE_CACHE_OWNER(pData)->iov_cache,
+                                                              &expected, (intptr_t)cache ) ) {
+                    free( cache );
+                    cache = (opal_datatype_iov_cache_t*)expected;
+                }
+            }
+        }
+        if( (NULL != cache) && (0 != cache->nruns) ) {
+            return opal_convertor_raw_cached( pConvertor, cache, iov, iov_count, length );
+        }
+    }
+
+    return opal_convertor_raw_generic( pConvertor, iov, iov_count, length );
+}
@@ -47,24 +47,7 @@
 static inline void
 opal_dt_swap_bytes(void *to_p, const void *from_p, const size_t size, size_t count)
 {
-    size_t i;
-    size_t back_i = size - 1;
-    uint8_t *to = (uint8_t*) to_p;
-    uint8_t *from = (uint8_t*) from_p;
-
-    /* Do the first element */
-    for (i = 0 ; i < size ; i++, back_i--) {
-        to[back_i] = from[i];
-    }
-    /* Do all the others if any */
-    while(count > 1) {
-        to += size;
-        from += size;
-        count--;
-        for (i = 0, back_i = size - 1 ; i < size ; i++, back_i--) {
-            to[back_i] = from[i];
-        }
-    }
+    opal_datatype_bswap(to_p, from_p, size, count);
 }
 
 #ifdef HAVE_IEEE754_H
@@ -100,6 +100,10 @@ struct dt_type_desc_t {
 };
 typedef struct dt_type_desc_t dt_type_desc_t;
 
+struct opal_datatype_kernel_t;
+struct opal_datatype_iov_cache_t;
+struct opal_datatype_checkpoints_t;
+
 
 /*
  * The datatype description.
@@ -132,10 +136,17 @@ struct opal_datatype_t {
                                       all language interfaces (because Fortran is not known at the OPAL
                                       layer). This field should never be initialized in homogeneous
                                       environments */
-    /* --- cacheline 5 boundary (320 bytes) was 32-36 bytes ago --- */
-
-    /* size: 352, cachelines: 6, members: 15 */
-    /* last cacheline: 28-32 bytes */
+    struct opal_datatype_kernel_t *kernel; /**< specialized pack/unpack kernel built at commit time,
+                                                NULL if the generic engine has to be used */
+    /* --- cacheline 5 boundary (320 bytes) was 40-44 bytes ago --- */
+    struct opal_datatype_iov_cache_t *iov_cache; /**< flattened description used by opal_convertor_raw,
+                                                       built on first use */
+    struct opal_datatype_checkpoints_t *checkpoints; /**< convertor stack snapshots used to reach
+                                                          any position quickly, built on first use */
+    struct opal_datatype_t *shared; /**< interned datatype owning the optimized description, the
+                                         kernel and the caches, NULL if they are private */
+
+    /* size: 384, cachelines: 6, members: 19 */
 };
 
 typedef struct opal_datatype_t opal_datatype_t;
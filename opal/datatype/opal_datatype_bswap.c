@@ -0,0 +1,175 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if OPAL_C_HAVE_X86_TARGET_ATTRIBUTE
+#include <immintrin.h>
+#endif
+
+#include "opal/types.h"
+#include "opal/datatype/opal_datatype_internal.h"
+
+/*
+ * Byte swapping of arrays of predefined types, for the conversions between
+ * peers of different endianness and for external32.
+ *
+ * The elements are swapped one at a time with the byte swap instructions of
+ * the CPU. When the CPU supports SSSE3 or AVX2, long runs of 2, 4, 8 or 16
+ * bytes elements are instead reversed 16 or 32 bytes at a time with a byte
+ * shuffle, which runs at memory bandwidth.
+ */
+
+/* runs shorter than this are not worth loading the shuffle mask */
+#define OPAL_DATATYPE_BSWAP_VECTOR_MIN 64
+
+/**
+ * Swap as many elements as possible, return the number of elements done.
+ */
+typedef size_t (*opal_datatype_bswap_vector_fn_t)( unsigned char* to, const unsigned char* from,
+                                                  size_t size, size_t count );
+
+static opal_datatype_bswap_vector_fn_t opal_datatype_bswap_vector = NULL;
+
+static void
+opal_datatype_bswap_scalar( unsigned char* to, const unsigned char* from, size_t size, size_t count )
+{
+    size_t i, j;
+
+    switch( size ) {
+    case 2:
+        for( i = 0; i < count; i++, to += 2, from += 2 ) {
+            uint16_t val;
+            memcpy( &val, from, 2 );
+            val = opal_swap_bytes2( val );
+            memcpy( to, &val, 2 );
+        }
+        break;
+    case 4:
+        for( i = 0; i < count; i++, to += 4, from += 4 ) {
+            uint32_t val;
+            memcpy( &val, from, 4 );
+            val = opal_swap_bytes4( val );
+            memcpy( to, &val, 4 );
+        }
+        break;
+    case 8:
+        for( i = 0; i < count; i++, to += 8, from += 8 ) {
+            uint64_t val;
+            memcpy( &val, from, 8 );
+            val = opal_swap_bytes8( val );
+            memcpy( to, &val, 8 );
+        }
+        break;
+    case 16:
+        for( i = 0; i < count; i++, to += 16, from += 16 ) {
+            uint64_t val[2];
+            memcpy( val, from, 16 );
+            val[0] = opal_swap_bytes8( val[0] );
+            val[1] = opal_swap_bytes8( val[1] );
+            memcpy( to, val + 1, 8 );
+            memcpy( to + 8, val, 8 );
+        }
+        break;
+    default:
+        for( i = 0; i < count; i++, to += size, from += size ) {
+            for( j = 0; j < size / 2; j++ ) {
+                unsigned char tmp = from[j];
+                to[j] = from[size - 1 - j];
+                to[size - 1 - j] = tmp;
+            }
+            if( size & 1 ) to[size / 2] = from[size / 2];
+        }
+    }
+}
+
+#if OPAL_C_HAVE_X86_TARGET_ATTRIBUTE
+
+/* the shuffle masks reversing the bytes of 2, 4, 8 and 16 bytes elements in
+ * a 32 bytes vector, indexed by log2(size) - 1 */
+static uint8_t opal_datatype_bswap_masks[4][32];
+
+__attribute__((target("ssse3")))
+static size_t
+opal_datatype_bswap_ssse3( unsigned char* to, const unsigned char* from, size_t size, size_t count )
+{
+    const __m128i mask = _mm_loadu_si128( (const __m128i*)opal_datatype_bswap_masks[__builtin_ctzl(size) - 1] );
+    size_t length = (count * size) & ~(size_t)63, i;
+
+    for( i = 0; i < length; i += 64 ) {
+        __m128i v0 = _mm_loadu_si128( (const __m128i*)(from + i) );
+        __m128i v1 = _mm_loadu_si128( (const __m128i*)(from + i + 16) );
+        __m128i v2 = _mm_loadu_si128( (const __m128i*)(from + i + 32) );
+        __m128i v3 = _mm_loadu_si128( (const __m128i*)(from + i + 48) );
+        _mm_storeu_si128( (__m128i*)(to + i),      _mm_shuffle_epi8( v0, mask ) );
+        _mm_storeu_si128( (__m128i*)(to + i + 16), _mm_shuffle_epi8( v1, mask ) );
+        _mm_storeu_si128( (__m128i*)(to + i + 32), _mm_shuffle_epi8( v2, mask ) );
+        _mm_storeu_si128( (__m128i*)(to + i + 48), _mm_shuffle_epi8( v3, mask ) );
+    }
+    return length / size;
+}
+
+__attribute__((target("avx2")))
+static size_t
+opal_datatype_bswap_avx2( unsigned char* to, const unsigned char* from, size_t size, size_t count )
+{
+    const __m256i mask = _mm256_loadu_si256( (const __m256i*)opal_datatype_bswap_masks[__builtin_ctzl(size) - 1] );
+    size_t length = (count * size) & ~(size_t)127, i;
+
+    /* the shuffle does not cross the 16 bytes lanes, the elements never do either */
+    for( i = 0; i < length; i += 128 ) {
+        __m256i v0 = _mm256_loadu_si256( (const __m256i*)(from + i) );
+        __m256i v1 = _mm256_loadu_si256( (const __m256i*)(from + i + 32) );
+        __m256i v2 = _mm256_loadu_si256( (const __m256i*)(from + i + 64) );
+        __m256i v3 = _mm256_loadu_si256( (const __m256i*)(from + i + 96) );
+        _mm256_storeu_si256( (__m256i*)(to + i),      _mm256_shuffle_epi8( v0, mask ) );
+        _mm256_storeu_si256( (__m256i*)(to + i + 32), _mm256_shuffle_epi8( v1, mask ) );
+        _mm256_storeu_si256( (__m256i*)(to + i + 64), _mm256_shuffle_epi8( v2, mask ) );
+        _mm256_storeu_si256( (__m256i*)(to + i + 96), _mm256_shuffle_epi8( v3, mask ) );
+    }
+    return length / size;
+}
+
+#endif  /* OPAL_C_HAVE_X86_TARGET_ATTRIBUTE */
+
+void opal_datatype_bswap_init( void )
+{
+#if OPAL_C_HAVE_X86_TARGET_ATTRIBUTE
+    for( int i = 0; i < 4; i++ ) {
+        int size = 2 << i;
+        for( int j = 0; j < 32; j++ ) {
+            opal_datatype_bswap_masks[i][j] = (uint8_t)((j % 16) / size * size + (size - 1 - j % size));
+        }
+    }
+
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports("avx2") ) {
+        opal_datatype_bswap_vector = opal_datatype_bswap_avx2;
+    } else if( __builtin_cpu_supports("ssse3") ) {
+        opal_datatype_bswap_vector = opal_datatype_bswap_ssse3;
+    }
+#endif  /* OPAL_C_HAVE_X86_TARGET_ATTRIBUTE */
+}
+
+void opal_datatype_bswap( void* to_p, const void* from_p, size_t size, size_t count )
+{
+    unsigned char* to = (unsigned char*)to_p;
+    const unsigned char* from = (const unsigned char*)from_p;
+    size_t done = 0;
+
+    if( (NULL != opal_datatype_bswap_vector) && ((size * count) >= OPAL_DATATYPE_BSWAP_VECTOR_MIN) &&
+        ((2 == size) || (4 == size) || (8 == size) || (16 == size)) ) {
+        done = opal_datatype_bswap_vector( to, from, size, count );
+    }
+    opal_datatype_bswap_scalar( to + done * size, from + done * size, size, count - done );
+}
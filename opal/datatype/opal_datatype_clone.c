@@ -44,6 +44,10 @@ int32_t opal_datatype_clone( const opal_datatype_t * src_type, opal_datatype_t *
 
     dest_type->flags &= (~OPAL_DATATYPE_FLAG_PREDEFINED);
     dest_type->ptypes = NULL;
+    dest_type->kernel = NULL;
+    dest_type->iov_cache = NULL;  /* rebuilt on demand */
+    dest_type->checkpoints = NULL;
+    dest_type->shared = NULL;
     dest_type->desc.desc = temp;
 
     /**
@@ -54,6 +58,9 @@ int32_t opal_datatype_clone( const opal_datatype_t * src_type, opal_datatype_t *
         if( 0 != src_type->opt_desc.used ) {
             if( src_type->opt_desc.desc == src_type->desc.desc) {
                 dest_type->opt_desc = dest_type->desc;
+            } else if( NULL != src_type->shared ) {
+                /* share the interned description and kernel as well */
+                opal_datatype_intern_retain( dest_type, src_type->shared );
             } else {
                 desc_length = dest_type->opt_desc.used + 1;
                 dest_type->opt_desc.desc = (dt_elem_desc_t*)malloc( desc_length * sizeof(dt_elem_desc_t) );
@@ -71,5 +78,8 @@ int32_t opal_datatype_clone( const opal_datatype_t * src_type, opal_datatype_t *
     }
     dest_type->id  = src_type->id;  /* preserve the default id. This allow us to
                                      * copy predefined types. */
+    if( (NULL != src_type->kernel) && (NULL == dest_type->shared) ) {
+        dest_type->kernel = opal_datatype_kernel_create( dest_type );
+    }
     return OPAL_SUCCESS;
 }
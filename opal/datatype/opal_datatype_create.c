@@ -54,11 +54,19 @@ static void opal_datatype_construct( opal_datatype_t* pData )
     pData->opt_desc.used      = 0;
 
     pData->ptypes             = NULL;
+    pData->kernel             = NULL;
+    pData->iov_cache          = NULL;
+    pData->checkpoints        = NULL;
+    pData->shared             = NULL;
     pData->loops              = 0;
 }
 
 static void opal_datatype_destruct( opal_datatype_t* datatype )
 {
+    if( NULL != datatype->shared ) {
+        /* leaves the optimized description and the caches to the interned datatype */
+        opal_datatype_intern_release( datatype );
+    }
     /**
      * As the default description and the optimized description might point to the
      * same data description we should start by cleaning the optimized description.
@@ -78,6 +86,18 @@ static void opal_datatype_destruct( opal_datatype_t* datatype )
             datatype->desc.desc   = NULL;
         }
     }
+    if( NULL != datatype->kernel ) {
+        opal_datatype_kernel_free( datatype->kernel );
+        datatype->kernel = NULL;
+    }
+    if( NULL != datatype->iov_cache ) {
+        free( datatype->iov_cache );
+        datatype->iov_cache = NULL;
+    }
+    if( NULL != datatype->checkpoints ) {
+        free( datatype->checkpoints );
+        datatype->checkpoints = NULL;
+    }
     /* dont free the ptypes of predefined types (it was not dynamically allocated) */
     if( (NULL != datatype->ptypes) && (!opal_datatype_is_predefined(datatype)) ) {
         free(datatype->ptypes);
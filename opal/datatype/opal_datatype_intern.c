@@ -0,0 +1,236 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Interning of the committed datatypes.
+ *
+ * Applications creating the same derived datatype over and over get a new
+ * optimized description, kernel and caches for each of them. When enabled
+ * (mpi_ddt_intern), the commit looks up the layout of the datatype in a table
+ * of the layouts already committed, and a datatype with a known layout shares
+ * the optimized description, kernel, iovec cache and checkpoints of the
+ * canonical datatype of that layout instead of building its own.
+ *
+ * The canonical datatype is a private clone of the first datatype committed
+ * with that layout. It is reference counted by the table and by each datatype
+ * sharing it, and leaves the table with the last of them, so freeing the
+ * datatypes in any order is safe.
+ *
+ * The layout key is the size, the bounds, the flags and the description of
+ * the datatype, with the padding of the description elements cleared.
+ */
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opal/constants.h"
+#include "opal/class/opal_hash_table.h"
+#include "opal/threads/mutex.h"
+#include "opal/datatype/opal_datatype.h"
+#include "opal/datatype/opal_datatype_internal.h"
+
+typedef struct opal_datatype_intern_key_t {
+    size_t     size;
+    ptrdiff_t  true_lb;
+    ptrdiff_t  true_ub;
+    ptrdiff_t  lb;
+    ptrdiff_t  ub;
+    uint32_t   flags;
+    uint32_t   used;
+    dt_elem_desc_t desc[];
+} opal_datatype_intern_key_t;
+
+static opal_hash_table_t opal_datatype_intern_table;
+static opal_mutex_t opal_datatype_intern_lock = OPAL_MUTEX_STATIC_INIT;
+static bool opal_datatype_intern_initialized = false;
+
+static opal_datatype_intern_key_t*
+opal_datatype_intern_key( const opal_datatype_t* pData, size_t* keylen )
+{
+    opal_datatype_intern_key_t* key;
+    const dt_elem_desc_t* pElem = pData->desc.desc;
+    uint32_t i;
+
+    *keylen = sizeof(opal_datatype_intern_key_t) + (pData->desc.used + 1) * sizeof(dt_elem_desc_t);
+    key = (opal_datatype_intern_key_t*)calloc( 1, *keylen );
+    if( NULL == key ) return NULL;
+
+    key->size    = pData->size;
+    key->true_lb = pData->true_lb;
+    key->true_ub = pData->true_ub;
+    key->lb      = pData->lb;
+    key->ub      = pData->ub;
+    key->flags   = pData->flags;
+    key->used    = pData->desc.used;
+    for( i = 0; i <= pData->desc.used; i++ ) {
+        dt_elem_desc_t* pKey = &key->desc[i];
+
+        pKey->elem.common = pElem[i].elem.common;
+        if( OPAL_DATATYPE_LOOP == pElem[i].elem.common.type ) {
+            pKey->loop.items  = pElem[i].loop.items;
+            pKey->loop.loops  = pElem[i].loop.loops;
+            pKey->loop.extent = pElem[i].loop.extent;
+        } else if( OPAL_DATATYPE_END_LOOP == pElem[i].elem.common.type ) {
+            pKey->end_loop.items           = pElem[i].end_loop.items;
+            pKey->end_loop.size            = pElem[i].end_loop.size;
+            pKey->end_loop.first_elem_disp = pElem[i].end_loop.first_elem_disp;
+        } else {
+            pKey->elem.count    = pElem[i].elem.count;
+            pKey->elem.blocklen = pElem[i].elem.blocklen;
+            pKey->elem.extent   = pElem[i].elem.extent;
+            pKey->elem.disp     = pElem[i].elem.disp;
+        }
+    }
+    return key;
+}
+
+static inline void
+opal_datatype_intern_share( opal_datatype_t* pData, opal_datatype_t* canonical )
+{
+    OBJ_RETAIN( canonical );
+    pData->shared   = canonical;
+    pData->opt_desc = canonical->opt_desc;
+    pData->kernel   = canonical->kernel;
+}
+
+bool opal_datatype_intern_lookup( opal_datatype_t* pData )
+{
+    opal_datatype_intern_key_t* key;
+    opal_datatype_t* canonical = NULL;
+    size_t keylen;
+
+    if( (0 == pData->desc.used) || (pData->flags & OPAL_DATATYPE_FLAG_PREDEFINED) ) {
+        return false;
+    }
+    key = opal_datatype_intern_key( pData, &keylen );
+    if( NULL == key ) return false;
+
+    OPAL_THREAD_LOCK( &opal_datatype_intern_lock );
+    if( opal_datatype_intern_initialized &&
+        (OPAL_SUCCESS == opal_hash_table_get_value_ptr( &opal_datatype_intern_table, key, keylen,
+                                                        (void**)&canonical )) ) {
+        opal_datatype_intern_share( pData, canonical );
+    }
+    OPAL_THREAD_UNLOCK( &opal_datatype_intern_lock );
+
+    free( key );
+    return (NULL != canonical);
+}
+
+void opal_datatype_intern_insert( opal_datatype_t* pData )
+{
+    opal_datatype_intern_key_t* key;
+    opal_datatype_t* canonical = NULL;
+    size_t keylen;
+
+    if( (0 == pData->desc.used) || (0 == pData->opt_desc.used) || (NULL != pData->shared) ||
+        (pData->opt_desc.desc == pData->desc.desc) || (pData->flags & OPAL_DATATYPE_FLAG_PREDEFINED) ) {
+        return;
+    }
+    key = opal_datatype_intern_key( pData, &keylen );
+    if( NULL == key ) return;
+
+    OPAL_THREAD_LOCK( &opal_datatype_intern_lock );
+    if( !opal_datatype_intern_initialized ) {
+        OBJ_CONSTRUCT( &opal_datatype_intern_table, opal_hash_table_t );
+        opal_hash_table_init( &opal_datatype_intern_table, 256 );
+        opal_datatype_intern_initialized = true;
+    }
+    if( OPAL_SUCCESS != opal_hash_table_get_value_ptr( &opal_datatype_intern_table, key, keylen,
+                                                       (void**)&canonical ) ) {
+        /* the canonical datatype takes over the optimized description and the kernel */
+        canonical = opal_datatype_create( pData->desc.used );
+        canonical->desc.used = pData->desc.used;
+        memcpy( canonical->desc.desc, pData->desc.desc, (pData->desc.used + 1) * sizeof(dt_elem_desc_t) );
+        canonical->flags    = pData->flags;
+        canonical->size     = pData->size;
+        canonical->true_lb  = pData->true_lb;
+        canonical->true_ub  = pData->true_ub;
+        canonical->lb       = pData->lb;
+        canonical->ub       = pData->ub;
+        canonical->opt_desc = pData->opt_desc;
+        canonical->kernel   = pData->kernel;
+        if( OPAL_SUCCESS != opal_hash_table_set_value_ptr( &opal_datatype_intern_table, key, keylen,
+                                                           canonical ) ) {
+            canonical->opt_desc.desc = NULL;
+            canonical->kernel = NULL;
+            OBJ_RELEASE( canonical );
+            OPAL_THREAD_UNLOCK( &opal_datatype_intern_lock );
+            free( key );
+            return;
+        }
+        opal_datatype_intern_share( pData, canonical );
+    } else {
+        /* committed concurrently with the same layout: use the existing one */
+        free( pData->opt_desc.desc );
+        opal_datatype_kernel_free( pData->kernel );
+        opal_datatype_intern_share( pData, canonical );
+    }
+    OPAL_THREAD_UNLOCK( &opal_datatype_intern_lock );
+
+    free( key );
+}
+
+void opal_datatype_intern_retain( opal_datatype_t* pData, opal_datatype_t* canonical )
+{
+    OPAL_THREAD_LOCK( &opal_datatype_intern_lock );
+    opal_datatype_intern_share( pData, canonical );
+    OPAL_THREAD_UNLOCK( &opal_datatype_intern_lock );
+}
+
+void opal_datatype_intern_release( opal_datatype_t* pData )
+{
+    opal_datatype_t* canonical = pData->shared;
+    opal_datatype_intern_key_t* key;
+    size_t keylen;
+
+    /* the description is owned by the canonical datatype */
+    pData->shared        = NULL;
+    pData->opt_desc.desc = NULL;
+    pData->kernel        = NULL;
+
+    OPAL_THREAD_LOCK( &opal_datatype_intern_lock );
+    if( opal_datatype_intern_initialized && (2 == canonical->super.obj_reference_count) ) {
+        /* the last user, the table holds the other reference */
+        key = opal_datatype_intern_key( canonical, &keylen );
+        if( (NULL != key) &&
+            (OPAL_SUCCESS == opal_hash_table_remove_value_ptr( &opal_datatype_intern_table, key, keylen )) ) {
+            OBJ_RELEASE( canonical );
+        }
+        free( key );
+    }
+    OBJ_RELEASE( canonical );
+    OPAL_THREAD_UNLOCK( &opal_datatype_intern_lock );
+}
+
+void opal_datatype_intern_fini( void )
+{
+    opal_datatype_t* canonical;
+    void *key, *node;
+    size_t keylen;
+    int rc;
+
+    OPAL_THREAD_LOCK( &opal_datatype_intern_lock );
+    if( opal_datatype_intern_initialized ) {
+        /* the datatypes still sharing a description keep it alive */
+        rc = opal_hash_table_get_first_key_ptr( &opal_datatype_intern_table, &key, &keylen,
+                                                (void**)&canonical, &node );
+        while( OPAL_SUCCESS == rc ) {
+            OBJ_RELEASE( canonical );
+            rc = opal_hash_table_get_next_key_ptr( &opal_datatype_intern_table, &key, &keylen,
+                                                   (void**)&canonical, node, &node );
+        }
+        OBJ_DESTRUCT( &opal_datatype_intern_table );
+        opal_datatype_intern_initialized = false;
+    }
+    OPAL_THREAD_UNLOCK( &opal_datatype_intern_lock );
+}
@@ -514,6 +514,113 @@ OPAL_DECLSPEC int opal_datatype_contain_basic_datatypes( const struct opal_datat
 OPAL_DECLSPEC int opal_datatype_dump_data_flags( unsigned short usflags, char* ptr, size_t length );
 OPAL_DECLSPEC int opal_datatype_dump_data_desc( union dt_elem_desc* pDesc, int nbElems, char* ptr, size_t length );
 
+/**
+ * Specialized pack/unpack kernels.
+ *
+ * At commit time the optimized description of the datatype is matched against
+ * a few common shapes. When it matches, the layout is captured in a kernel
+ * description and the convertor uses dedicated pack/unpack functions instead of
+ * the generic stack based engine. All blocks of a kernel have the same length.
+ */
+#define OPAL_DATATYPE_KERNEL_STRIDED        1  /**< up to 3 dimensional strided blocks */
+#define OPAL_DATATYPE_KERNEL_INDEXED_BLOCK  2  /**< blocks at arbitrary displacements */
+
+#define OPAL_DATATYPE_KERNEL_MAX_DIMS       3
+#define OPAL_DATATYPE_KERNEL_MAX_BLOCKS     65536
+
+struct opal_datatype_kernel_t {
+    int32_t    type;      /**< OPAL_DATATYPE_KERNEL_STRIDED or OPAL_DATATYPE_KERNEL_INDEXED_BLOCK */
+    uint32_t   elem_size; /**< size of the basic datatype */
+    size_t     blocklen;  /**< length in bytes of each block */
+    size_t     nblocks;   /**< number of blocks in one instance of the datatype */
+    ptrdiff_t  disp;      /**< displacement of the first block (strided) */
+    size_t     count[OPAL_DATATYPE_KERNEL_MAX_DIMS];   /**< number of blocks in each dimension (strided) */
+    ptrdiff_t  stride[OPAL_DATATYPE_KERNEL_MAX_DIMS];  /**< distance between blocks in each dimension (strided) */
+    ptrdiff_t* disps;     /**< displacement of each block (indexed block) */
+};
+typedef struct opal_datatype_kernel_t opal_datatype_kernel_t;
+
+struct opal_datatype_kernel_t* opal_datatype_kernel_create( const struct opal_datatype_t* pData );
+void opal_datatype_kernel_free( struct opal_datatype_kernel_t* kernel );
+
+/*
+ * Flattened iovec description.
+ *
+ * opal_convertor_raw walks the whole description stack for every call, which
+ * dominates the cost of registering or describing large derived datatypes for
+ * RDMA. The first walk over an instance of the datatype is recorded as a list
+ * of runs: count pieces of len bytes, each stride bytes after the previous
+ * one. Later calls only have to find the run matching the position (binary
+ * search on packed) and to replay the runs, shifted by the extent for the
+ * following instances. A cache with no runs marks a datatype that has too
+ * many runs to be worth caching (see mpi_ddt_iov_cache_max_runs).
+ */
+struct opal_datatype_iov_run_t {
+    ptrdiff_t  disp;     /**< displacement of the first piece relative to the instance */
+    ptrdiff_t  stride;   /**< distance between two consecutive pieces */
+    size_t     len;      /**< length in bytes of each piece */
+    size_t     count;    /**< number of pieces in the run */
+    size_t     packed;   /**< number of bytes in the instance before this run */
+};
+typedef struct opal_datatype_iov_run_t opal_datatype_iov_run_t;
+
+struct opal_datatype_iov_cache_t {
+    uint32_t                 nruns;
+    opal_datatype_iov_run_t  runs[];
+};
+typedef struct opal_datatype_iov_cache_t opal_datatype_iov_cache_t;
+
+/*
+ * Position checkpoints.
+ *
+ * Moving a convertor to a position walks the description from the current
+ * state (or from the beginning when going backward), which for deeply nested
+ * datatypes costs as much as the conversion itself. For large non-contiguous
+ * datatypes a snapshot of the convertor stack is taken every interval bytes
+ * of one instance, on the predefined datatype boundary at or before the
+ * position. Positioning then restarts from the closest checkpoint, shifted
+ * to the right instance, and walks at most interval bytes. A datatype too
+ * small to benefit gets an index without checkpoints.
+ */
+#define OPAL_DATATYPE_MAX_CHECKPOINTS  4096
+
+struct dt_stack_t;
+struct opal_datatype_checkpoints_t {
+    size_t              interval;   /**< distance in bytes between two checkpoints */
+    uint32_t            count;      /**< number of checkpoints */
+    uint32_t            depth;      /**< number of stack entries reserved for each checkpoint */
+    size_t             *position;   /**< position of each checkpoint in the instance */
+    int32_t            *stack_pos;  /**< top of the saved stack of each checkpoint */
+    struct dt_stack_t  *stack;      /**< the saved stacks, depth entries per checkpoint */
+};
+typedef struct opal_datatype_checkpoints_t opal_datatype_checkpoints_t;
+
+/*
+ * Reverse the bytes of count consecutive elements of size bytes from from to
+ * to (which can be the same buffer), with vector instructions when available.
+ */
+void opal_datatype_bswap_init( void );
+OPAL_DECLSPEC void opal_datatype_bswap( void* to, const void* from, size_t size, size_t count );
+
+/*
+ * Interning of the committed datatypes (see opal_datatype_intern.c).
+ */
+bool opal_datatype_intern_lookup( struct opal_datatype_t* pData );
+void opal_datatype_intern_insert( struct opal_datatype_t* pData );
+void opal_datatype_intern_retain( struct opal_datatype_t* pData, struct opal_datatype_t* canonical );
+void opal_datatype_intern_release( struct opal_datatype_t* pData );
+void opal_datatype_intern_fini( void );
+
+/* the datatype holding the lazily built caches of PDATA */
+#define OPAL_DATATYPE_CACHE_OWNER( PDATA ) \
+    ((struct opal_datatype_t*)((NULL != (PDATA)->shared) ? (PDATA)->shared : (PDATA)))
+
+extern bool opal_ddt_kernels;
+extern bool opal_ddt_intern;
+extern int opal_ddt_iov_cache_max_runs;
+extern int opal_ddt_pack_threads;
+extern size_t opal_ddt_pack_threads_min_size;
+extern size_t opal_ddt_checkpoint_interval;
 extern bool opal_ddt_position_debug;
 extern bool opal_ddt_copy_debug;
 extern bool opal_ddt_unpack_debug;
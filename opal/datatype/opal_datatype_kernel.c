@@ -0,0 +1,375 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opal/datatype/opal_datatype.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_prototypes.h"
+
+/*
+ * Specialized pack/unpack kernels.
+ *
+ * The generic engine interprets the datatype description one element at a
+ * time and has to save its state on the convertor stack. For the layouts below
+ * the position of every block can be computed directly, which allows the copy
+ * loops to be written with the block length known to the compiler for the most
+ * common sizes:
+ *
+ *  - strided: a 1, 2 or 3 dimensional array of equally sized blocks, as created
+ *    by vectors, hvectors and subarrays;
+ *  - indexed block: equally sized blocks at arbitrary displacements, as created
+ *    by indexed_block and friends.
+ *
+ * The kernels derive their position from bConverted only, so they do not use
+ * the convertor stack and the convertor can be moved to any position in O(1).
+ */
+
+static void opal_datatype_kernel_normalize( opal_datatype_kernel_t* kernel )
+{
+    uint32_t i, j, ndims = 0;
+
+    /* remove the degenerated dimensions */
+    for( i = 0; i < OPAL_DATATYPE_KERNEL_MAX_DIMS; i++ ) {
+        if( kernel->count[i] > 1 ) {
+            kernel->count[ndims]  = kernel->count[i];
+            kernel->stride[ndims] = kernel->stride[i];
+            ndims++;
+        }
+    }
+    /* the innermost dimension might be contiguous with the blocks */
+    while( (ndims > 0) && (kernel->stride[0] == (ptrdiff_t)kernel->blocklen) ) {
+        kernel->blocklen *= kernel->count[0];
+        for( j = 1; j < ndims; j++ ) {
+            kernel->count[j - 1]  = kernel->count[j];
+            kernel->stride[j - 1] = kernel->stride[j];
+        }
+        ndims--;
+    }
+    /* merge the dimensions that are contiguous with each other */
+    for( i = 0; (i + 1) < ndims; ) {
+        if( kernel->stride[i + 1] == (ptrdiff_t)kernel->count[i] * kernel->stride[i] ) {
+            kernel->count[i] *= kernel->count[i + 1];
+            for( j = i + 2; j < ndims; j++ ) {
+                kernel->count[j - 1]  = kernel->count[j];
+                kernel->stride[j - 1] = kernel->stride[j];
+            }
+            ndims--;
+        } else {
+            i++;
+        }
+    }
+    /* pad the unused dimensions so the kernels do not have to care */
+    for( i = ndims; i < OPAL_DATATYPE_KERNEL_MAX_DIMS; i++ ) {
+        kernel->count[i]  = 1;
+        kernel->stride[i] = 0;
+    }
+}
+
+/*
+ * A strided datatype is described by at most two nested loops around a single
+ * element: LOOP, [LOOP,] ELEM, [END_LOOP,] END_LOOP.
+ */
+static opal_datatype_kernel_t*
+opal_datatype_kernel_create_strided( const dt_elem_desc_t* pElem, uint32_t used )
+{
+    opal_datatype_kernel_t* kernel;
+    uint32_t i, nloops = 0;
+
+    while( (nloops < used) && (OPAL_DATATYPE_LOOP == pElem[nloops].elem.common.type) ) {
+        nloops++;
+    }
+    if( (nloops >= OPAL_DATATYPE_KERNEL_MAX_DIMS) || (used != (2 * nloops + 1)) ||
+        !(pElem[nloops].elem.common.flags & OPAL_DATATYPE_FLAG_DATA) ) {
+        return NULL;
+    }
+    for( i = 0; i < nloops; i++ ) {
+        if( (pElem[i].loop.items != 2 * (nloops - i)) ||
+            (OPAL_DATATYPE_END_LOOP != pElem[nloops + 1 + i].elem.common.type) ) {
+            return NULL;
+        }
+    }
+
+    kernel = (opal_datatype_kernel_t*)calloc(1, sizeof(opal_datatype_kernel_t));
+    if( NULL == kernel ) {
+        return NULL;
+    }
+    kernel->type      = OPAL_DATATYPE_KERNEL_STRIDED;
+    kernel->elem_size = opal_datatype_basicDatatypes[pElem[nloops].elem.common.type]->size;
+    kernel->blocklen  = pElem[nloops].elem.blocklen * kernel->elem_size;
+    kernel->disp      = pElem[nloops].elem.disp;
+    kernel->count[0]  = pElem[nloops].elem.count;
+    kernel->stride[0] = pElem[nloops].elem.extent;
+    for( i = 1; i <= nloops; i++ ) {
+        kernel->count[i]  = pElem[nloops - i].loop.loops;
+        kernel->stride[i] = pElem[nloops - i].loop.extent;
+    }
+    for( ; i < OPAL_DATATYPE_KERNEL_MAX_DIMS; i++ ) {
+        kernel->count[i]  = 1;
+        kernel->stride[i] = 0;
+    }
+    opal_datatype_kernel_normalize( kernel );
+    kernel->nblocks = kernel->count[0] * kernel->count[1] * kernel->count[2];
+    return kernel;
+}
+
+/*
+ * An indexed block datatype is a list of elements without loops, all of them
+ * with the same block length.
+ */
+static opal_datatype_kernel_t*
+opal_datatype_kernel_create_indexed( const dt_elem_desc_t* pElem, uint32_t used )
+{
+    opal_datatype_kernel_t* kernel;
+    size_t blocklen = 0, nblocks = 0, i, j;
+
+    for( i = 0; i < used; i++ ) {
+        if( !(pElem[i].elem.common.flags & OPAL_DATATYPE_FLAG_DATA) ) {
+            return NULL;
+        }
+        if( 0 == i ) {
+            blocklen = pElem[i].elem.blocklen * opal_datatype_basicDatatypes[pElem[i].elem.common.type]->size;
+        } else if( blocklen != pElem[i].elem.blocklen * opal_datatype_basicDatatypes[pElem[i].elem.common.type]->size ) {
+            return NULL;
+        }
+        nblocks += pElem[i].elem.count;
+        if( nblocks > OPAL_DATATYPE_KERNEL_MAX_BLOCKS ) {
+            return NULL;
+        }
+    }
+
+    kernel = (opal_datatype_kernel_t*)calloc(1, sizeof(opal_datatype_kernel_t));
+    if( NULL == kernel ) {
+        return NULL;
+    }
+    /* one extra entry so the copy loop can always look ahead */
+    kernel->disps = (ptrdiff_t*)calloc(nblocks + 1, sizeof(ptrdiff_t));
+    if( NULL == kernel->disps ) {
+        free( kernel );
+        return NULL;
+    }
+    kernel->type      = OPAL_DATATYPE_KERNEL_INDEXED_BLOCK;
+    kernel->elem_size = opal_datatype_basicDatatypes[pElem[0].elem.common.type]->size;
+    kernel->blocklen  = blocklen;
+    kernel->nblocks   = nblocks;
+    for( i = 0, nblocks = 0; i < used; i++ ) {
+        for( j = 0; j < pElem[i].elem.count; j++ ) {
+            kernel->disps[nblocks++] = pElem[i].elem.disp + (ptrdiff_t)j * pElem[i].elem.extent;
+        }
+        /* mixed basic types are fine as long as they all share the same size */
+        if( kernel->elem_size != opal_datatype_basicDatatypes[pElem[i].elem.common.type]->size ) {
+            kernel->elem_size = 1;
+        }
+    }
+    return kernel;
+}
+
+opal_datatype_kernel_t* opal_datatype_kernel_create( const opal_datatype_t* pData )
+{
+    const dt_type_desc_t* desc = (0 != pData->opt_desc.used) ? &pData->opt_desc : &pData->desc;
+    opal_datatype_kernel_t* kernel;
+
+    if( !opal_ddt_kernels || (0 == pData->size) || (0 == desc->used) ||
+        (pData->flags & OPAL_DATATYPE_FLAG_CONTIGUOUS) ) {
+        return NULL;  /* nothing to gain */
+    }
+
+    kernel = opal_datatype_kernel_create_strided( desc->desc, desc->used );
+    if( NULL == kernel ) {
+        if( desc->used < 2 ) return NULL;
+        kernel = opal_datatype_kernel_create_indexed( desc->desc, desc->used );
+        if( NULL == kernel ) return NULL;
+    }
+    if( (kernel->nblocks * kernel->blocklen) != pData->size ) {
+        opal_datatype_kernel_free( kernel );
+        return NULL;
+    }
+    return kernel;
+}
+
+void opal_datatype_kernel_free( opal_datatype_kernel_t* kernel )
+{
+    if( NULL == kernel ) return;
+    free( kernel->disps );
+    free( kernel );
+}
+
+static inline ptrdiff_t
+opal_datatype_kernel_block_disp( const opal_datatype_kernel_t* kernel, size_t block )
+{
+    if( OPAL_DATATYPE_KERNEL_INDEXED_BLOCK == kernel->type ) {
+        return kernel->disps[block];
+    }
+    return kernel->disp + (ptrdiff_t)(block % kernel->count[0]) * kernel->stride[0]
+        + (ptrdiff_t)((block / kernel->count[0]) % kernel->count[1]) * kernel->stride[1]
+        + (ptrdiff_t)(block / (kernel->count[0] * kernel->count[1])) * kernel->stride[2];
+}
+
+/*
+ * Copy count blocks between the user memory and the packed buffer. The block
+ * length is a compile time constant for the usual sizes.
+ */
+#define OPAL_DATATYPE_KERNEL_COPY_ROW( MEM, NEXT_MEM, BUF, COUNT, LEN, PACK ) \
+    do {                                                                \
+        for( size_t _k = 0; _k < (COUNT); _k++ ) {                      \
+            if( PACK ) {                                                \
+                memcpy( (BUF), (MEM), (LEN) );                          \
+            } else {                                                    \
+                memcpy( (MEM), (BUF), (LEN) );                          \
+            }                                                           \
+            (BUF) += (LEN);                                             \
+            NEXT_MEM;                                                   \
+        }                                                               \
+    } while(0)
+
+#define OPAL_DATATYPE_KERNEL_COPY_BLOCKS( MEM, NEXT_MEM, BUF, COUNT, LEN, PACK ) \
+    switch( LEN ) {                                                     \
+    case 4:  OPAL_DATATYPE_KERNEL_COPY_ROW( MEM, NEXT_MEM, BUF, COUNT, 4, PACK ); break; \
+    case 8:  OPAL_DATATYPE_KERNEL_COPY_ROW( MEM, NEXT_MEM, BUF, COUNT, 8, PACK ); break; \
+    case 16: OPAL_DATATYPE_KERNEL_COPY_ROW( MEM, NEXT_MEM, BUF, COUNT, 16, PACK ); break; \
+    case 32: OPAL_DATATYPE_KERNEL_COPY_ROW( MEM, NEXT_MEM, BUF, COUNT, 32, PACK ); break; \
+    default: OPAL_DATATYPE_KERNEL_COPY_ROW( MEM, NEXT_MEM, BUF, COUNT, (LEN), PACK ); break; \
+    }
+
+static inline unsigned char*
+opal_datatype_kernel_copy_strided( const opal_datatype_kernel_t* kernel, unsigned char* base,
+                                   size_t block, size_t nblocks, unsigned char* buf, const int pack )
+{
+    const size_t blocklen = kernel->blocklen;
+    size_t i0 = block % kernel->count[0], i1, i2;
+    unsigned char* mem;
+
+    block /= kernel->count[0];
+    i1 = block % kernel->count[1];
+    i2 = block / kernel->count[1];
+    mem = base + kernel->disp + (ptrdiff_t)i0 * kernel->stride[0] +
+        (ptrdiff_t)i1 * kernel->stride[1] + (ptrdiff_t)i2 * kernel->stride[2];
+
+    while( nblocks > 0 ) {
+        size_t todo = kernel->count[0] - i0;
+
+        if( todo > nblocks ) todo = nblocks;
+        OPAL_DATATYPE_KERNEL_COPY_BLOCKS( mem, mem += kernel->stride[0], buf, todo, blocklen, pack );
+        nblocks -= todo;
+        i0 += todo;
+        if( i0 == kernel->count[0] ) {
+            i0 = 0;
+            if( ++i1 == kernel->count[1] ) {
+                i1 = 0;
+                i2++;
+            }
+            mem = base + kernel->disp + (ptrdiff_t)i1 * kernel->stride[1] + (ptrdiff_t)i2 * kernel->stride[2];
+        }
+    }
+    return buf;
+}
+
+static inline unsigned char*
+opal_datatype_kernel_copy_indexed( const opal_datatype_kernel_t* kernel, unsigned char* base,
+                                   size_t block, size_t nblocks, unsigned char* buf, const int pack )
+{
+    const ptrdiff_t* disps = kernel->disps + block;
+    unsigned char* mem = base + *disps;
+
+    OPAL_DATATYPE_KERNEL_COPY_BLOCKS( mem, mem = base + *(++disps), buf, nblocks, kernel->blocklen, pack );
+    return buf;
+}
+
+static inline int32_t
+opal_datatype_kernel_advance( opal_convertor_t* pConv, struct iovec* iov,
+                              uint32_t* out_size, size_t* max_data, const int pack )
+{
+    const opal_datatype_t* pData = pConv->pDesc;
+    const opal_datatype_kernel_t* kernel = pData->kernel;
+    const ptrdiff_t extent = pData->ub - pData->lb;
+    size_t instance, block, offset, total_length = 0;
+    uint32_t iov_count;
+
+    instance = pConv->bConverted / pData->size;
+    offset   = pConv->bConverted - instance * pData->size;
+    block    = offset / kernel->blocklen;
+    offset  -= block * kernel->blocklen;
+
+    for( iov_count = 0; iov_count < (*out_size); iov_count++ ) {
+        unsigned char* buf = (unsigned char*)iov[iov_count].iov_base;
+        size_t length = iov[iov_count].iov_len;
+
+        if( instance == pConv->count ) break;
+
+        while( (length > 0) && (instance < pConv->count) ) {
+            unsigned char* base = pConv->pBaseBuf + (ptrdiff_t)instance * extent;
+
+            if( (0 != offset) || (length < kernel->blocklen) ) {
+                /* partial block, either left from the previous call or at the end of the iovec */
+                unsigned char* mem = base + opal_datatype_kernel_block_disp( kernel, block ) + offset;
+                size_t todo = kernel->blocklen - offset;
+
+                if( todo > length ) todo = length;
+                if( pack ) {
+                    memcpy( buf, mem, todo );
+                } else {
+                    memcpy( mem, buf, todo );
+                }
+                buf += todo;
+                length -= todo;
+                offset += todo;
+                if( offset == kernel->blocklen ) {
+                    offset = 0;
+                    block++;
+                }
+            } else {
+                size_t nblocks = length / kernel->blocklen;
+
+                if( nblocks > (kernel->nblocks - block) ) nblocks = kernel->nblocks - block;
+                if( OPAL_DATATYPE_KERNEL_STRIDED == kernel->type ) {
+                    buf = opal_datatype_kernel_copy_strided( kernel, base, block, nblocks, buf, pack );
+                } else {
+                    buf = opal_datatype_kernel_copy_indexed( kernel, base, block, nblocks, buf, pack );
+                }
+                block += nblocks;
+                length -= nblocks * kernel->blocklen;
+            }
+            if( block == kernel->nblocks ) {
+                block = 0;
+                instance++;
+            }
+        }
+        iov[iov_count].iov_len -= length;
+        total_length += iov[iov_count].iov_len;
+    }
+    *max_data = total_length;
+    *out_size = iov_count;
+    pConv->bConverted += total_length;
+    if( pConv->bConverted == pConv->local_size ) {
+        pConv->flags |= CONVERTOR_COMPLETED;
+        return 1;
+    }
+    return 0;
+}
+
+int32_t
+opal_pack_kernel( opal_convertor_t* pConvertor,
+                  struct iovec* iov, uint32_t* out_size,
+                  size_t* max_data )
+{
+    return opal_datatype_kernel_advance( pConvertor, iov, out_size, max_data, 1 );
+}
+
+int32_t
+opal_unpack_kernel( opal_convertor_t* pConvertor,
+                    struct iovec* iov, uint32_t* out_size,
+                    size_t* max_data )
+{
+    return opal_datatype_kernel_advance( pConvertor, iov, out_size, max_data, 0 );
+}
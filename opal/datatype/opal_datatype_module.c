@@ -46,6 +46,12 @@ bool opal_ddt_pack_debug = false;
 bool opal_ddt_position_debug = false;
 bool opal_ddt_copy_debug = false;
 bool opal_ddt_raw_debug = false;
+bool opal_ddt_kernels = true;
+bool opal_ddt_intern = false;
+int opal_ddt_iov_cache_max_runs = 1024;
+int opal_ddt_pack_threads = 0;
+size_t opal_ddt_pack_threads_min_size = 32 * 1024 * 1024;
+size_t opal_ddt_checkpoint_interval = 64 * 1024;
 int opal_ddt_verbose = -1;  /* Has the datatype verbose it's own output stream */
 
 extern int opal_cuda_verbose;
@@ -158,9 +164,65 @@ OPAL_DECLSPEC const opal_datatype_t* opal_datatype_basicDatatypes[OPAL_DATATYPE_
 
 int opal_datatype_register_params(void)
 {
-#if OPAL_ENABLE_DEBUG
     int ret;
 
+    ret = mca_base_var_register ("opal", "mpi", NULL, "ddt_kernels",
+                                 "Use specialized pack/unpack functions for the strided and indexed block "
+                                 "datatypes committed after this point (default: true)",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_LOCAL, &opal_ddt_kernels);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = mca_base_var_register ("opal", "mpi", NULL, "ddt_iov_cache_max_runs",
+                                 "Maximum number of runs in the flattened description cached for the raw "
+                                 "(iovec) representation of a datatype, 0 disables the cache (default: 1024)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_LOCAL, &opal_ddt_iov_cache_max_runs);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = mca_base_var_register ("opal", "mpi", NULL, "ddt_intern",
+                                 "Whether committed datatypes with the same layout share their optimized "
+                                 "description and caches (default: false)",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_LOCAL, &opal_ddt_intern);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = mca_base_var_register ("opal", "mpi", NULL, "ddt_pack_threads",
+                                 "Number of helper threads used to pack and unpack very large non-contiguous "
+                                 "buffers, only in applications that do not use MPI from several threads "
+                                 "(default: 0, disabled)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_LOCAL, &opal_ddt_pack_threads);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = mca_base_var_register ("opal", "mpi", NULL, "ddt_pack_threads_min_size",
+                                 "Minimum number of bytes converted at once before the helper threads are used "
+                                 "(see mpi_ddt_pack_threads)",
+                                 MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_LOCAL, &opal_ddt_pack_threads_min_size);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = mca_base_var_register ("opal", "mpi", NULL, "ddt_checkpoint_interval",
+                                 "Distance in bytes between two saved positions of the convertors on large "
+                                 "non-contiguous datatypes, used to move the convertors to any position without "
+                                 "walking the whole datatype. 0 disables the checkpoints (default: 65536)",
+                                 MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_LOCAL, &opal_ddt_checkpoint_interval);
+    if (0 > ret) {
+        return ret;
+    }
+
+#if OPAL_ENABLE_DEBUG
     ret = mca_base_var_register ("opal", "mpi", NULL, "ddt_unpack_debug",
                                  "Whether to output debugging information in the ddt unpack functions (nonzero = enabled)",
                                  MCA_BASE_VAR_TYPE_BOOL, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_3,
@@ -238,6 +300,12 @@ static void opal_datatype_finalize (void)
     /* clear all master convertors */
     opal_convertor_destroy_masters();
 
+    /* and stop the pack/unpack helper threads */
+    opal_convertor_parallel_fini();
+
+    /* the interned datatypes still in use are released with their last user */
+    opal_datatype_intern_fini();
+
     opal_output_close (opal_datatype_dfd);
     opal_datatype_dfd = -1;
 }
@@ -273,6 +341,11 @@ int32_t opal_datatype_init( void )
         datatype->desc.desc[1].end_loop.size            = datatype->size;
     }
 
+    opal_datatype_bswap_init();
+
+    /* a previous finalize stopped the pack/unpack helper threads */
+    opal_convertor_parallel_init();
+
     /* Enable a private output stream for datatype */
     if( opal_ddt_verbose > 0 ) {
         opal_datatype_dfd = opal_output_open(NULL);
@@ -24,12 +24,54 @@
 #include "opal_config.h"
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "opal/datatype/opal_datatype.h"
 #include "opal/datatype/opal_convertor.h"
 #include "opal/datatype/opal_datatype_internal.h"
 
+/**
+ * A loop around a single element is a regular repetition of that element when
+ * the element is repeated only once per iteration, or when the loop extent
+ * continues the element stride. In both cases the loop can be replaced by a
+ * single element with a larger count, i.e. one more strided dimension folded
+ * into the element. Return 1 and the resulting element in result if that's
+ * the case, 0 otherwise.
+ */
+static int
+opal_datatype_optimize_collapse_loop( const ddt_loop_desc_t* loop,
+                                      const ddt_elem_desc_t* elem,
+                                      ddt_elem_desc_t* result )
+{
+    ptrdiff_t size = opal_datatype_basicDatatypes[elem->common.type]->size;
+
+    *result = *elem;
+    if( result->extent == (ptrdiff_t)result->blocklen * size ) {
+        result->blocklen *= result->count;
+        result->extent   *= result->count;
+        result->count     = 1;
+    }
+    if( 1 == loop->loops ) return 1;
+    if( ((uint64_t)loop->loops * (uint64_t)result->count) > UINT32_MAX ) return 0;
+
+    if( 1 == result->count ) {
+        result->count  = loop->loops;
+        result->extent = loop->extent;
+    } else if( loop->extent == (ptrdiff_t)result->count * result->extent ) {
+        result->count *= loop->loops;
+    } else {
+        return 0;
+    }
+    if( result->extent == (ptrdiff_t)result->blocklen * size ) {
+        /* the new dimension is contiguous with the blocks */
+        result->blocklen *= result->count;
+        result->extent   *= result->count;
+        result->count     = 1;
+    }
+    return 1;
+}
+
 static int32_t
 opal_datatype_optimize_short( opal_datatype_t* pData,
                               size_t count,
@@ -62,6 +104,27 @@ opal_datatype_optimize_short( opal_datatype_t* pData,
                 pElemDesc++; nbElems++;
                 last.count= 0;
             }
+            /* A loop that ended up around a single element can often be folded
+             * into that element, which is then a candidate for merging with
+             * its neighbors like any other element. */
+            if( (stack_pos > 0) && (1 == (nbElems - pStack->index)) &&
+                opal_datatype_optimize_collapse_loop( &(pTypeDesc->desc[pStack->index - 1].loop),
+                                                      &(pTypeDesc->desc[pStack->index].elem),
+                                                      &compress ) ) {
+                pElemDesc -= 2; nbElems -= 2;
+                stack_pos--;
+                pStack--;
+                pos_desc++;
+                total_disp = pStack->disp;
+                /* resume the merging with the element generated before the loop */
+                if( (nbElems > 0) && (nbElems > pStack->index) &&
+                    (pElemDesc[-1].elem.common.flags & OPAL_DATATYPE_FLAG_DATA) ) {
+                    pElemDesc--; nbElems--;
+                    last = pElemDesc->elem;
+                }
+                current = &compress;
+                goto fuse_loops;
+            }
             CREATE_LOOP_END( pElemDesc, nbElems - pStack->index + 1,  /* # of elems in this loop */
                              end_loop->first_elem_disp, end_loop->size, end_loop->common.flags );
             if( --stack_pos >= 0 ) {  /* still something to do ? */
@@ -298,6 +361,11 @@ int32_t opal_datatype_commit( opal_datatype_t * pData )
     /* If the data is contiguous is useless to generate an optimized version. */
     /*if( pData->size == (pData->true_ub - pData->true_lb) ) return OPAL_SUCCESS; */
 
+    /* Share the optimized description of an identical datatype if we have one */
+    if( opal_ddt_intern && opal_datatype_intern_lookup( pData ) ) {
+        return OPAL_SUCCESS;
+    }
+
     (void)opal_datatype_optimize_short( pData, 1, &(pData->opt_desc) );
     if( 0 != pData->opt_desc.used ) {
         /* let's add a fake element at the end just to avoid useless comparaisons
@@ -310,5 +378,9 @@ int32_t opal_datatype_commit( opal_datatype_t * pData )
         pLast->first_elem_disp = first_elem_disp;
         pLast->size            = pData->size;
     }
+    pData->kernel = opal_datatype_kernel_create( pData );
+    if( opal_ddt_intern ) {
+        opal_datatype_intern_insert( pData );
+    }
     return OPAL_SUCCESS;
 }
@@ -205,16 +205,17 @@ int opal_convertor_generic_simple_position( opal_convertor_t* pConvertor,
     if( 0 != pConvertor->partial_length ) {
         size_t element_length = opal_datatype_basicDatatypes[pElem->elem.common.type]->size;
         size_t missing_length = element_length - pConvertor->partial_length;
-        if( missing_length >= iov_len_local ) {
-            pConvertor->partial_length = (pConvertor->partial_length + iov_len_local) % element_length;
-            pConvertor->bConverted    += iov_len_local;
-            assert(pConvertor->partial_length < element_length);
+        if( missing_length > iov_len_local ) {
+            /* still in the middle of the same element, leave it on the stack */
+            pConvertor->partial_length += iov_len_local;
+            pConvertor->bConverted     += iov_len_local;
+            pConvertor->stack_pos++;
             return 0;
         }
+        /* the stack points to the beginning of the partial element, restart from there */
+        pConvertor->bConverted    -= pConvertor->partial_length;
+        iov_len_local             += pConvertor->partial_length;
         pConvertor->partial_length = 0;
-        pConvertor->bConverted += missing_length;
-        iov_len_local -= missing_length;
-        count_desc--;
     }
     while( 1 ) {
         if( OPAL_DATATYPE_END_LOOP == pElem->elem.common.type ) { /* end of the the entire datatype */
@@ -238,6 +239,14 @@ int opal_convertor_generic_simple_position( opal_convertor_t* pConvertor,
                     pStack->disp += description[pStack->index].loop.extent;
                     pos_desc = pStack->index;  /* go back to the loop start itself to give a chance 
                                                 * to move forward by entire loops */
+                    /* The loop start pushes the loop again, with the remaining iterations
+                     * and the displacement of the next one. */
+                    base_pointer = pConvertor->pBaseBuf + pStack->disp;
+                    count_desc   = pStack->count;
+                    pElem        = &(description[pos_desc]);
+                    pConvertor->stack_pos--;
+                    pStack--;
+                    continue;
                 }
             }
             base_pointer = pConvertor->pBaseBuf + pStack->disp;
@@ -247,7 +256,6 @@ int opal_convertor_generic_simple_position( opal_convertor_t* pConvertor,
                                    pStack->disp, (unsigned long)iov_len_local ); );
         }
         if( OPAL_DATATYPE_LOOP == pElem->elem.common.type ) {
-            ptrdiff_t local_disp = (ptrdiff_t)base_pointer;
             ddt_endloop_desc_t* end_loop = (ddt_endloop_desc_t*)(pElem + pElem->loop.items);
             size_t full_loops = iov_len_local / end_loop->size;
             full_loops = count_desc <= full_loops ? count_desc : full_loops;
@@ -262,9 +270,8 @@ int opal_convertor_generic_simple_position( opal_convertor_t* pConvertor,
                 }
                 /* Save the stack with the correct last_count value. */
             }
-            local_disp = (ptrdiff_t)base_pointer - local_disp;
             PUSH_STACK( pStack, pConvertor->stack_pos, pos_desc, OPAL_DATATYPE_LOOP, count_desc,
-                        pStack->disp + local_disp );
+                        base_pointer - pConvertor->pBaseBuf );
             pos_desc++;
         update_loop_description:  /* update the current state */
             base_pointer = pConvertor->pBaseBuf + pStack->disp;
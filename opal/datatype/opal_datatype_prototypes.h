@@ -83,6 +83,14 @@ int32_t
 opal_generic_simple_unpack_checksum( opal_convertor_t* pConvertor,
                                      struct iovec* iov, uint32_t* out_size,
                                      size_t* max_data );
+int32_t
+opal_pack_kernel( opal_convertor_t* pConvertor,
+                  struct iovec* iov, uint32_t* out_size,
+                  size_t* max_data );
+int32_t
+opal_unpack_kernel( opal_convertor_t* pConvertor,
+                    struct iovec* iov, uint32_t* out_size,
+                    size_t* max_data );
 
 END_C_DECLS
 
@@ -441,6 +441,7 @@ opal_unpack_general_function( opal_convertor_t* pConvertor,
     const opal_datatype_t *pData = pConvertor->pDesc;
     unsigned char *conv_ptr, *iov_ptr;
     uint32_t iov_count;
+    bool folded = false;
     size_t iov_len_local;
 
     const opal_convertor_master_t* master = pConvertor->master;
@@ -464,6 +465,19 @@ opal_unpack_general_function( opal_convertor_t* pConvertor,
     pConvertor->stack_pos--;
     pElem = &(description[pos_desc]);
 
+    /* The instances of a datatype made of a single predefined element, such as
+     * the predefined datatypes themselves, are equally spaced: convert all the
+     * remaining instances with a single call to the conversion function. */
+    if( (-1 == pStack->index) && (pStack->count > 1) && (1 == count_desc) &&
+        (pElem->elem.common.flags & OPAL_DATATYPE_FLAG_DATA) &&
+        (OPAL_DATATYPE_END_LOOP == description[pos_desc + 1].elem.common.type) &&
+        (1 == (pElem->elem.count * pElem->elem.blocklen)) &&
+        (pElem->elem.extent == (pData->ub - pData->lb)) ) {
+        count_desc    = pStack->count;
+        pStack->count = 1;
+        folded        = true;
+    }
+
     DO_DEBUG( opal_output( 0, "unpack start pos_desc %d count_desc %" PRIsize_t " disp %ld\n"
                            "stack_pos %d pos_desc %d count_desc %" PRIsize_t " disp %ld\n",
                            pos_desc, count_desc, (long)(conv_ptr - pConvertor->pBaseBuf),
@@ -568,6 +582,12 @@ opal_unpack_general_function( opal_convertor_t* pConvertor,
         pConvertor->flags |= CONVERTOR_COMPLETED;
         return 1;
     }
+    if( folded && (OPAL_DATATYPE_END_LOOP != pElem->elem.common.type) ) {
+        /* back to one instance at a time */
+        pStack->count = count_desc;
+        pStack->disp  = conv_ptr - pConvertor->pBaseBuf;
+        count_desc    = 1;
+    }
     /* Save the global position for the next round */
     PUSH_STACK( pStack, pConvertor->stack_pos, pos_desc, pElem->elem.common.type, count_desc,
                 conv_ptr - pConvertor->pBaseBuf );
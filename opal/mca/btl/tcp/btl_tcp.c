@@ -327,6 +327,7 @@ int mca_btl_tcp_send( struct mca_btl_base_module_t* btl,
     frag->iov_idx = 0;
     frag->iov_cnt = 1;
     frag->iov_ptr = frag->iov;
+    frag->zc_used = false;
     frag->iov[0].iov_base = (IOVBASE_TYPE*)&frag->hdr;
     frag->iov[0].iov_len = sizeof(frag->hdr);
     frag->hdr.size = 0;
@@ -400,6 +401,7 @@ int mca_btl_tcp_put (mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t
     frag->hdr.size = 0;
     frag->iov_cnt = 2;
     frag->iov_ptr = frag->iov;
+    frag->zc_used = false;
     frag->iov[0].iov_base = (IOVBASE_TYPE*)&frag->hdr;
     frag->iov[0].iov_len = sizeof(frag->hdr);
     frag->iov[1].iov_base = (IOVBASE_TYPE*) (frag->segments + 1);
@@ -467,6 +469,7 @@ int mca_btl_tcp_get (mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t
     frag->hdr.size = 0;
     frag->iov_cnt = 2;
     frag->iov_ptr = frag->iov;
+    frag->zc_used = false;
     frag->iov[0].iov_base = (IOVBASE_TYPE*)&frag->hdr;
     frag->iov[0].iov_len = sizeof(frag->hdr);
     frag->iov[1].iov_base = (IOVBASE_TYPE*) &frag->segments[1];
@@ -51,8 +51,16 @@
 #include "opal/mca/mpool/mpool.h"
 #include "opal/class/opal_hash_table.h"
 #include "opal/util/fd.h"
+#include "opal/threads/threads.h"
 
 #define MCA_BTL_TCP_STATISTICS 0
+
+/* Linux MSG_ZEROCOPY support for large sends */
+#if defined(HAVE_LINUX_ERRQUEUE_H) && HAVE_DECL_MSG_ZEROCOPY && HAVE_DECL_SO_ZEROCOPY
+#define MCA_BTL_TCP_ZEROCOPY 1
+#else
+#define MCA_BTL_TCP_ZEROCOPY 0
+#endif
 BEGIN_C_DECLS
 
 extern opal_event_base_t* mca_btl_tcp_event_base;
@@ -77,9 +85,24 @@ extern opal_event_base_t* mca_btl_tcp_event_base;
         }                                                               \
     } while (0)
 
-extern opal_list_t mca_btl_tcp_ready_frag_pending_queue;
-extern opal_mutex_t mca_btl_tcp_ready_frag_mutex;
-extern int mca_btl_tcp_pipe_to_progress[2];
+/**
+ * A progress engine: an event base and, when progress threads are
+ * enabled, the thread driving it. Endpoints are distributed across the
+ * engines so that several threads can poll the sockets concurrently.
+ * The first engine also handles the listen sockets and the connection
+ * handshakes.
+ */
+struct mca_btl_tcp_progress_engine_t {
+    opal_event_base_t* event_base;          /**< event base polled by this engine */
+    opal_thread_t thread;                   /**< thread progressing the event base */
+    volatile int trigger;                   /**< -1: no thread, 1: running, 0: shutting down */
+    int pipe_to_progress[2];                /**< pipe used to hand events over to the thread */
+    opal_event_t async_event;               /**< event on the reading end of the pipe */
+};
+typedef struct mca_btl_tcp_progress_engine_t mca_btl_tcp_progress_engine_t;
+
+extern mca_btl_tcp_progress_engine_t* mca_btl_tcp_progress_engines;
+extern int mca_btl_tcp_num_progress_engines;
 extern int mca_btl_tcp_progress_thread_trigger;
 
 #define MCA_BTL_TCP_CRITICAL_SECTION_ENTER(name) \
@@ -87,11 +110,11 @@ extern int mca_btl_tcp_progress_thread_trigger;
 #define MCA_BTL_TCP_CRITICAL_SECTION_LEAVE(name) \
     opal_mutex_atomic_unlock((name))
 
-#define MCA_BTL_TCP_ACTIVATE_EVENT(event, value)                        \
+#define MCA_BTL_TCP_ACTIVATE_EVENT(engine, event, value)                \
     do {                                                                \
-        if(0 < mca_btl_tcp_progress_thread_trigger) {                   \
+        if(0 < (engine)->trigger) {                                     \
             opal_event_t* _event = (opal_event_t*)(event);                  \
-            (void) opal_fd_write( mca_btl_tcp_pipe_to_progress[1], sizeof(opal_event_t*), \
+            (void) opal_fd_write( (engine)->pipe_to_progress[1], sizeof(opal_event_t*), \
                            &_event);                                        \
         }                                                                   \
         else {                                                          \
@@ -143,15 +166,17 @@ struct mca_btl_tcp_component_t {
     opal_free_list_t tcp_frag_max;
     opal_free_list_t tcp_frag_user;
 
-    int tcp_enable_progress_thread;         /** Support for tcp progress thread flag */
+    int tcp_enable_progress_thread;         /** Number of tcp progress threads (0 disables them) */
 
-    opal_event_t tcp_recv_thread_async_event;
     opal_mutex_t tcp_frag_eager_mutex;
     opal_mutex_t tcp_frag_max_mutex;
     opal_mutex_t tcp_frag_user_mutex;
     /* Do we want to use TCP_NODELAY? */
     int    tcp_not_use_nodelay;
 
+    int    tcp_send_batch;                  /**< maximum number of queued fragments written by a single writev */
+    size_t tcp_zerocopy_threshold;          /**< send fragments larger than this with MSG_ZEROCOPY (0 disables) */
+
     /* do we want to warn on all excluded interfaces
      * that are not found?
      */
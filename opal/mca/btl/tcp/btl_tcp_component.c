@@ -103,13 +103,12 @@
 static int mca_btl_tcp_component_register(void);
 static int mca_btl_tcp_component_open(void);
 static int mca_btl_tcp_component_close(void);
+static void mca_btl_tcp_progress_engine_stop(mca_btl_tcp_progress_engine_t* engine);
 
 opal_event_base_t* mca_btl_tcp_event_base = NULL;
 int mca_btl_tcp_progress_thread_trigger = -1;
-int mca_btl_tcp_pipe_to_progress[2] = { -1, -1 };
-static opal_thread_t mca_btl_tcp_progress_thread = { { 0 } };
-opal_list_t mca_btl_tcp_ready_frag_pending_queue = { { 0 } };
-opal_mutex_t mca_btl_tcp_ready_frag_mutex = OPAL_MUTEX_STATIC_INIT;
+mca_btl_tcp_progress_engine_t* mca_btl_tcp_progress_engines = NULL;
+int mca_btl_tcp_num_progress_engines = 0;
 
 mca_btl_tcp_component_t mca_btl_tcp_component = {
     .super = {
@@ -279,6 +278,21 @@ static int mca_btl_tcp_component_register(void)
                                     " endpoint_cache", 30*1024, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_endpoint_cache);
     mca_btl_tcp_param_register_int ("use_nagle", "Whether to use Nagle's algorithm or not (using Nagle's algorithm may increase short message latency)",
                                     0, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_not_use_nodelay);
+    mca_btl_tcp_param_register_int ("send_batch",
+                                    "Maximum number of fragments queued on a connection that are written to the"
+                                    " socket with a single system call (1 disables batching)",
+                                    8, OPAL_INFO_LVL_5, &mca_btl_tcp_component.tcp_send_batch);
+    mca_btl_tcp_component.tcp_zerocopy_threshold = 0;
+#if MCA_BTL_TCP_ZEROCOPY
+    (void) mca_base_component_var_register(&mca_btl_tcp_component.super.btl_version,
+                                           "zerocopy_threshold",
+                                           "Send fragments with at least this many bytes using MSG_ZEROCOPY, which"
+                                           " avoids the copy into the kernel at the cost of a completion notification"
+                                           " (0 disables zero-copy sends)",
+                                           MCA_BASE_VAR_TYPE_SIZE_T,
+                                           NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_READONLY, &mca_btl_tcp_component.tcp_zerocopy_threshold);
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
     mca_btl_tcp_param_register_int( "port_min_v4",
                                     "The minimum port where the TCP BTL will try to bind (default 1024)",
                                     1024, OPAL_INFO_LVL_2, &mca_btl_tcp_component.tcp_port_min);
@@ -308,8 +322,11 @@ static int mca_btl_tcp_component_register(void)
 #endif
 
     /* Check if we should support async progress */
-    mca_btl_tcp_param_register_int ("progress_thread", NULL, 0, OPAL_INFO_LVL_1,
-                                     &mca_btl_tcp_component.tcp_enable_progress_thread);
+    mca_btl_tcp_param_register_int ("progress_thread",
+                                    "Number of threads progressing the TCP connections (0 disables the"
+                                    " progress threads). The connections are spread across the threads.",
+                                    0, OPAL_INFO_LVL_1,
+                                    &mca_btl_tcp_component.tcp_enable_progress_thread);
     mca_btl_tcp_component.report_all_unfound_interfaces = false;
     (void) mca_base_component_var_register(&mca_btl_tcp_component.super.btl_version,
                                            "warn_all_unfound_interfaces",
@@ -383,8 +400,6 @@ static int mca_btl_tcp_component_open(void)
     OBJ_CONSTRUCT(&mca_btl_tcp_component.tcp_frag_eager_mutex, opal_mutex_t);
     OBJ_CONSTRUCT(&mca_btl_tcp_component.tcp_frag_max_mutex, opal_mutex_t);
     OBJ_CONSTRUCT(&mca_btl_tcp_component.tcp_frag_user_mutex, opal_mutex_t);
-    OBJ_CONSTRUCT(&mca_btl_tcp_ready_frag_mutex, opal_mutex_t);
-    OBJ_CONSTRUCT(&mca_btl_tcp_ready_frag_pending_queue, opal_list_t);
 
     /* if_include and if_exclude need to be mutually exclusive */
     if (OPAL_SUCCESS !=
@@ -413,42 +428,23 @@ static int mca_btl_tcp_component_close(void)
     mca_btl_tcp_event_t *event, *next;
 
     /**
-     * If we have a progress thread we should shut it down before
+     * If we have progress threads we should shut them down before
      * moving forward with the TCP tearing down process.
      */
-    if( (NULL != mca_btl_tcp_event_base) &&
-        (mca_btl_tcp_event_base != opal_sync_event_base) ) {
-        /* Turn of the progress thread before moving forward */
-        if( -1 != mca_btl_tcp_progress_thread_trigger ) {
-            void* ret = NULL;  /* not currently used */
-
-            mca_btl_tcp_progress_thread_trigger = 0;
-            /* Let the progress thread know that we're going away */
-            if( -1 != mca_btl_tcp_pipe_to_progress[1] ) {
-                close(mca_btl_tcp_pipe_to_progress[1]);
-                mca_btl_tcp_pipe_to_progress[1] = -1;
-            }
-            /* wait until the TCP progress thread completes */
-            opal_thread_join(&mca_btl_tcp_progress_thread, &ret);
-            assert( -1 == mca_btl_tcp_progress_thread_trigger );
-        }
-        opal_event_del(&mca_btl_tcp_component.tcp_recv_thread_async_event);
-        opal_event_base_free(mca_btl_tcp_event_base);
-        mca_btl_tcp_event_base = NULL;
-
-        /* Close the remaining pipes */
-        if( -1 != mca_btl_tcp_pipe_to_progress[0] ) {
-            close(mca_btl_tcp_pipe_to_progress[0]);
-            mca_btl_tcp_pipe_to_progress[0] = -1;
+    if( NULL != mca_btl_tcp_progress_engines ) {
+        for( int i = 0; i < mca_btl_tcp_num_progress_engines; i++ ) {
+            mca_btl_tcp_progress_engine_stop(&mca_btl_tcp_progress_engines[i]);
         }
+        free(mca_btl_tcp_progress_engines);
+        mca_btl_tcp_progress_engines = NULL;
+        mca_btl_tcp_num_progress_engines = 0;
+        mca_btl_tcp_progress_thread_trigger = -1;
     }
+    mca_btl_tcp_event_base = NULL;
 
     OBJ_DESTRUCT(&mca_btl_tcp_component.tcp_frag_eager_mutex);
     OBJ_DESTRUCT(&mca_btl_tcp_component.tcp_frag_max_mutex);
 
-    OBJ_DESTRUCT(&mca_btl_tcp_ready_frag_mutex);
-    OBJ_DESTRUCT(&mca_btl_tcp_ready_frag_pending_queue);
-
     if (NULL != mca_btl_tcp_component.tcp_btls) {
         free(mca_btl_tcp_component.tcp_btls);
     }
@@ -883,30 +879,183 @@ static int mca_btl_tcp_component_create_instances(void)
 static void* mca_btl_tcp_progress_thread_engine(opal_object_t *obj)
 {
     opal_thread_t* current_thread = (opal_thread_t*)obj;
+    mca_btl_tcp_progress_engine_t* engine = (mca_btl_tcp_progress_engine_t*)current_thread->t_arg;
 
-    while( 1 == (*((int*)current_thread->t_arg)) ) {
-        opal_event_loop(mca_btl_tcp_event_base, OPAL_EVLOOP_ONCE);
+    while( 1 == engine->trigger ) {
+        opal_event_loop(engine->event_base, OPAL_EVLOOP_ONCE);
     }
-    (*((int*)current_thread->t_arg)) = -1;
+    engine->trigger = -1;
     return NULL;
 }
 
 static void mca_btl_tcp_component_event_async_handler(int fd, short unused, void *context)
 {
+    mca_btl_tcp_progress_engine_t* engine = (mca_btl_tcp_progress_engine_t*)context;
     opal_event_t* event;
     int rc;
 
     rc = read(fd, (void*)&event, sizeof(opal_event_t*));
-    assert( fd == mca_btl_tcp_pipe_to_progress[0] );
+    assert( fd == engine->pipe_to_progress[0] );
     if( 0 == rc ) {
         /* The main thread closed the pipe to trigger the shutdown procedure */
-        opal_thread_t* current_thread = (opal_thread_t*)context;
-        (*((int*)current_thread->t_arg)) = 0;
+        engine->trigger = 0;
     } else {
         opal_event_add(event, 0);
     }
 }
 
+/*
+ * Create the event base of a progress engine and start the thread
+ * progressing it.
+ */
+static int mca_btl_tcp_progress_engine_start(mca_btl_tcp_progress_engine_t* engine)
+{
+    int flags, rc;
+
+    engine->trigger = -1;
+    engine->pipe_to_progress[0] = engine->pipe_to_progress[1] = -1;
+    if( NULL == (engine->event_base = opal_event_base_create()) ) {
+        BTL_ERROR(("BTL TCP failed to create progress event base"));
+        return OPAL_ERROR;
+    }
+    opal_event_base_priority_init(engine->event_base, OPAL_EVENT_NUM_PRI);
+
+    /* construct the thread object */
+    OBJ_CONSTRUCT(&engine->thread, opal_thread_t);
+
+    /**
+     * Create a pipe to communicate between the main thread and the progress thread.
+     */
+    if (0 != pipe(engine->pipe_to_progress)) {
+        OBJ_DESTRUCT(&engine->thread);
+        opal_event_base_free(engine->event_base);
+        engine->event_base = NULL;
+        engine->pipe_to_progress[0] = engine->pipe_to_progress[1] = -1;
+        return OPAL_ERROR;
+    }
+    /* setup the receiving end of the pipe as non-blocking */
+    if((flags = fcntl(engine->pipe_to_progress[0], F_GETFL, 0)) < 0) {
+        BTL_ERROR(("fcntl(F_GETFL) failed: %s (%d)",
+                   strerror(opal_socket_errno), opal_socket_errno));
+    } else {
+        flags |= O_NONBLOCK;
+        if(fcntl(engine->pipe_to_progress[0], F_SETFL, flags) < 0)
+            BTL_ERROR(("fcntl(F_SETFL) failed: %s (%d)",
+                       strerror(opal_socket_errno), opal_socket_errno));
+    }
+    /* Progress thread event */
+    opal_event_set(engine->event_base, &engine->async_event,
+                   engine->pipe_to_progress[0],
+                   OPAL_EV_READ|OPAL_EV_PERSIST,
+                   mca_btl_tcp_component_event_async_handler,
+                   engine );
+    opal_event_add(&engine->async_event, 0);
+
+    /* fork off a thread to progress it */
+    engine->thread.t_run = mca_btl_tcp_progress_thread_engine;
+    engine->thread.t_arg = engine;
+    engine->trigger = 1;  /* thread up and running */
+    if( OPAL_SUCCESS != (rc = opal_thread_start(&engine->thread)) ) {
+        BTL_ERROR(("BTL TCP progress thread initialization failed (%d)", rc));
+        engine->trigger = -1;  /* thread not started */
+        mca_btl_tcp_progress_engine_stop(engine);
+        return rc;
+    }
+    return OPAL_SUCCESS;
+}
+
+/*
+ * Stop the thread progressing an engine (if any) and release its event
+ * base. The shared opal_sync_event_base is left untouched.
+ */
+static void mca_btl_tcp_progress_engine_stop(mca_btl_tcp_progress_engine_t* engine)
+{
+    if( (NULL == engine->event_base) || (opal_sync_event_base == engine->event_base) ) {
+        return;
+    }
+    /* Turn of the progress thread before moving forward */
+    if( -1 != engine->trigger ) {
+        void* ret = NULL;  /* not currently used */
+
+        engine->trigger = 0;
+        /* Let the progress thread know that we're going away */
+        if( -1 != engine->pipe_to_progress[1] ) {
+            close(engine->pipe_to_progress[1]);
+            engine->pipe_to_progress[1] = -1;
+        }
+        /* wait until the TCP progress thread completes */
+        opal_thread_join(&engine->thread, &ret);
+        assert( -1 == engine->trigger );
+    }
+    opal_event_del(&engine->async_event);
+    opal_event_base_free(engine->event_base);
+    engine->event_base = NULL;
+
+    /* Close the remaining pipes */
+    if( -1 != engine->pipe_to_progress[0] ) {
+        close(engine->pipe_to_progress[0]);
+        engine->pipe_to_progress[0] = -1;
+    }
+    if( -1 != engine->pipe_to_progress[1] ) {
+        close(engine->pipe_to_progress[1]);
+        engine->pipe_to_progress[1] = -1;
+    }
+    OBJ_DESTRUCT(&engine->thread);
+}
+
+/*
+ * Setup the progress engines: either tcp_enable_progress_thread engines
+ * each one progressed by its own thread, or a single engine using the
+ * event base shared by the entire Open MPI framework.
+ */
+static int mca_btl_tcp_progress_engines_init(void)
+{
+    int i, num_engines = mca_btl_tcp_component.tcp_enable_progress_thread;
+
+    if( 0 < num_engines ) {
+        /* Declare our intent to use threads. */
+        opal_event_use_threads();
+
+        mca_btl_tcp_progress_engines = (mca_btl_tcp_progress_engine_t*)
+            calloc(num_engines, sizeof(mca_btl_tcp_progress_engine_t));
+        if( NULL != mca_btl_tcp_progress_engines ) {
+            for( i = 0; i < num_engines; i++ ) {
+                if( OPAL_SUCCESS != mca_btl_tcp_progress_engine_start(&mca_btl_tcp_progress_engines[i]) ) {
+                    break;
+                }
+            }
+            if( 0 == i ) {
+                free(mca_btl_tcp_progress_engines);
+                mca_btl_tcp_progress_engines = NULL;
+            } else {
+                mca_btl_tcp_num_progress_engines = i;
+                mca_btl_tcp_progress_thread_trigger = 1;
+                /* We have async progress, the rest of the library should now protect itself against races */
+                opal_set_using_threads(true);
+            }
+        }
+    }
+
+    if( NULL == mca_btl_tcp_progress_engines ) {
+        /* fall back to only one event base (the one shared by the entire Open MPI framework) */
+        mca_btl_tcp_progress_engines = (mca_btl_tcp_progress_engine_t*)
+            calloc(1, sizeof(mca_btl_tcp_progress_engine_t));
+        if( NULL == mca_btl_tcp_progress_engines ) {
+            return OPAL_ERR_OUT_OF_RESOURCE;
+        }
+        mca_btl_tcp_progress_engines[0].event_base = opal_sync_event_base;
+        mca_btl_tcp_progress_engines[0].trigger = -1;
+        mca_btl_tcp_progress_engines[0].pipe_to_progress[0] = -1;
+        mca_btl_tcp_progress_engines[0].pipe_to_progress[1] = -1;
+        mca_btl_tcp_num_progress_engines = 1;
+        mca_btl_tcp_progress_thread_trigger = -1;
+    }
+
+    /* the listen sockets and the handshakes are handled by the first engine */
+    mca_btl_tcp_event_base = mca_btl_tcp_progress_engines[0].event_base;
+    return OPAL_SUCCESS;
+}
+
 /*
  * Create a listen socket and bind to all interfaces
  */
@@ -1095,69 +1244,13 @@ static int mca_btl_tcp_component_create_listen(uint16_t af_family)
         }
     }
 
-    if(mca_btl_tcp_component.tcp_enable_progress_thread){
-        /* Declare our intent to use threads. */
-        opal_event_use_threads();
-        if( NULL == mca_btl_tcp_event_base ) {
-            /* fall back to only one event base (the one shared by the entire Open MPI framework) */
-
-            if( NULL == (mca_btl_tcp_event_base = opal_event_base_create()) ) {
-                BTL_ERROR(("BTL TCP failed to create progress event base"));
-                goto move_forward_with_no_thread;
-            }
-            opal_event_base_priority_init(mca_btl_tcp_event_base, OPAL_EVENT_NUM_PRI);
-
-            /* construct the thread object */
-            OBJ_CONSTRUCT(&mca_btl_tcp_progress_thread, opal_thread_t);
-
-            /**
-             * Create a pipe to communicate between the main thread and the progress thread.
-             */
-            if (0 != pipe(mca_btl_tcp_pipe_to_progress)) {
-                opal_event_base_free(mca_btl_tcp_event_base);
-                /* fall back to only one event base (the one shared by the entire Open MPI framework */
-                mca_btl_tcp_event_base = opal_sync_event_base;
-                mca_btl_tcp_progress_thread_trigger = -1;  /* thread not started */
-                goto move_forward_with_no_thread;
-            }
-            /* setup the receiving end of the pipe as non-blocking */
-            if((flags = fcntl(mca_btl_tcp_pipe_to_progress[0], F_GETFL, 0)) < 0) {
-                BTL_ERROR(("fcntl(F_GETFL) failed: %s (%d)",
-                           strerror(opal_socket_errno), opal_socket_errno));
-            } else {
-                flags |= O_NONBLOCK;
-                if(fcntl(mca_btl_tcp_pipe_to_progress[0], F_SETFL, flags) < 0)
-                    BTL_ERROR(("fcntl(F_SETFL) failed: %s (%d)",
-                               strerror(opal_socket_errno), opal_socket_errno));
-            }
-            /* Progress thread event */
-            opal_event_set(mca_btl_tcp_event_base, &mca_btl_tcp_component.tcp_recv_thread_async_event,
-                           mca_btl_tcp_pipe_to_progress[0],
-                           OPAL_EV_READ|OPAL_EV_PERSIST,
-                           mca_btl_tcp_component_event_async_handler,
-                           &mca_btl_tcp_progress_thread );
-            opal_event_add(&mca_btl_tcp_component.tcp_recv_thread_async_event, 0);
-
-            /* fork off a thread to progress it */
-            mca_btl_tcp_progress_thread.t_run = mca_btl_tcp_progress_thread_engine;
-            mca_btl_tcp_progress_thread.t_arg = &mca_btl_tcp_progress_thread_trigger;
-            mca_btl_tcp_progress_thread_trigger = 1;  /* thread up and running */
-            if( OPAL_SUCCESS != (rc = opal_thread_start(&mca_btl_tcp_progress_thread)) ) {
-                BTL_ERROR(("BTL TCP progress thread initialization failed (%d)", rc));
-                opal_event_base_free(mca_btl_tcp_event_base);
-                /* fall back to only one event base (the one shared by the entire Open MPI framework */
-                mca_btl_tcp_event_base = opal_sync_event_base;
-                mca_btl_tcp_progress_thread_trigger = -1;  /* thread not started */
-                goto move_forward_with_no_thread;
-            }
-            /* We have async progress, the rest of the library should now protect itself against races */
-            opal_set_using_threads(true);
+    if( NULL == mca_btl_tcp_progress_engines ) {
+        /* the listen socket is closed by the component close */
+        rc = mca_btl_tcp_progress_engines_init();
+        if( OPAL_SUCCESS != rc ) {
+            return rc;
         }
     }
-    else {
-        move_forward_with_no_thread:
-            mca_btl_tcp_event_base = opal_sync_event_base;
-    }
 
     if (AF_INET == af_family) {
         opal_event_set(mca_btl_tcp_event_base, &mca_btl_tcp_component.tcp_recv_event,
@@ -1165,7 +1258,7 @@ static int mca_btl_tcp_component_create_listen(uint16_t af_family)
                        OPAL_EV_READ|OPAL_EV_PERSIST,
                        mca_btl_tcp_component_accept_handler,
                        0 );
-        MCA_BTL_TCP_ACTIVATE_EVENT(&mca_btl_tcp_component.tcp_recv_event, 0);
+        MCA_BTL_TCP_ACTIVATE_EVENT(&mca_btl_tcp_progress_engines[0], &mca_btl_tcp_component.tcp_recv_event, 0);
     }
 #if OPAL_ENABLE_IPV6
     if (AF_INET6 == af_family) {
@@ -1174,7 +1267,7 @@ static int mca_btl_tcp_component_create_listen(uint16_t af_family)
                        OPAL_EV_READ|OPAL_EV_PERSIST,
                        mca_btl_tcp_component_accept_handler,
                        0 );
-        MCA_BTL_TCP_ACTIVATE_EVENT(&mca_btl_tcp_component.tcp6_recv_event, 0);
+        MCA_BTL_TCP_ACTIVATE_EVENT(&mca_btl_tcp_progress_engines[0], &mca_btl_tcp_component.tcp6_recv_event, 0);
     }
 #endif
     return OPAL_SUCCESS;
@@ -65,6 +65,10 @@
 #include "btl_tcp_frag.h"
 #include "btl_tcp_addr.h"
 
+#if MCA_BTL_TCP_ZEROCOPY
+#include <linux/errqueue.h>
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+
 /*
  * Magic ID string send during connect/accept handshake
  */
@@ -87,12 +91,19 @@ static void mca_btl_tcp_endpoint_construct(mca_btl_tcp_endpoint_t* endpoint)
     endpoint->endpoint_state = MCA_BTL_TCP_CLOSED;
     endpoint->endpoint_retries = 0;
     endpoint->endpoint_nbo = false;
+    endpoint->endpoint_engine = NULL;
 #if MCA_BTL_TCP_ENDPOINT_CACHE
     endpoint->endpoint_cache        = NULL;
     endpoint->endpoint_cache_pos    = NULL;
     endpoint->endpoint_cache_length = 0;
 #endif  /* MCA_BTL_TCP_ENDPOINT_CACHE */
     OBJ_CONSTRUCT(&endpoint->endpoint_frags, opal_list_t);
+#if MCA_BTL_TCP_ZEROCOPY
+    endpoint->endpoint_zerocopy = false;
+    endpoint->endpoint_zc_next = 0;
+    endpoint->endpoint_zc_done = 0;
+    OBJ_CONSTRUCT(&endpoint->endpoint_zc_frags, opal_list_t);
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
     OBJ_CONSTRUCT(&endpoint->endpoint_send_lock, opal_mutex_t);
     OBJ_CONSTRUCT(&endpoint->endpoint_recv_lock, opal_mutex_t);
 }
@@ -106,6 +117,9 @@ static void mca_btl_tcp_endpoint_destruct(mca_btl_tcp_endpoint_t* endpoint)
     mca_btl_tcp_endpoint_close(endpoint);
     mca_btl_tcp_proc_remove(endpoint->endpoint_proc, endpoint);
     OBJ_DESTRUCT(&endpoint->endpoint_frags);
+#if MCA_BTL_TCP_ZEROCOPY
+    OBJ_DESTRUCT(&endpoint->endpoint_zc_frags);
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
     OBJ_DESTRUCT(&endpoint->endpoint_send_lock);
     OBJ_DESTRUCT(&endpoint->endpoint_recv_lock);
 }
@@ -305,7 +319,17 @@ static inline void mca_btl_tcp_endpoint_event_init(mca_btl_base_endpoint_t* btl_
     btl_endpoint->endpoint_cache_pos = btl_endpoint->endpoint_cache;
 #endif  /* MCA_BTL_TCP_ENDPOINT_CACHE */
 
-    opal_event_set(mca_btl_tcp_event_base, &btl_endpoint->endpoint_recv_event,
+    /* Spread the endpoints across the progress engines. Once selected the
+     * engine never changes, so all the events of an endpoint are always
+     * handled by the same thread. */
+    if( NULL == btl_endpoint->endpoint_engine ) {
+        static opal_atomic_int32_t engine_index = 0;
+        int32_t index = OPAL_THREAD_FETCH_ADD32(&engine_index, 1);
+        btl_endpoint->endpoint_engine =
+            &mca_btl_tcp_progress_engines[(uint32_t)index % (uint32_t)mca_btl_tcp_num_progress_engines];
+    }
+
+    opal_event_set(btl_endpoint->endpoint_engine->event_base, &btl_endpoint->endpoint_recv_event,
                     btl_endpoint->endpoint_sd,
                     OPAL_EV_READ | OPAL_EV_PERSIST,
                     mca_btl_tcp_endpoint_recv_handler,
@@ -315,7 +339,7 @@ static inline void mca_btl_tcp_endpoint_event_init(mca_btl_base_endpoint_t* btl_
      * to avoid missing the connection notification in send_handler due to
      * a local handling of the peer process (which holds the lock).
      */
-    opal_event_set(mca_btl_tcp_event_base, &btl_endpoint->endpoint_send_event,
+    opal_event_set(btl_endpoint->endpoint_engine->event_base, &btl_endpoint->endpoint_send_event,
                     btl_endpoint->endpoint_sd,
                     OPAL_EV_WRITE | OPAL_EV_PERSIST,
                     mca_btl_tcp_endpoint_send_handler,
@@ -351,6 +375,15 @@ int mca_btl_tcp_endpoint_send(mca_btl_base_endpoint_t* btl_endpoint, mca_btl_tcp
                mca_btl_tcp_frag_send(frag, btl_endpoint->endpoint_sd)) {
                 int btl_ownership = (frag->base.des_flags & MCA_BTL_DES_FLAGS_BTL_OWNERSHIP);
 
+#if MCA_BTL_TCP_ZEROCOPY
+                if( frag->zc_used ) {
+                    /* the kernel still references the data, complete later */
+                    frag->base.des_flags |= MCA_BTL_DES_SEND_ALWAYS_CALLBACK;
+                    opal_list_append(&btl_endpoint->endpoint_zc_frags, (opal_list_item_t*)frag);
+                    break;
+                }
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+
                 OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_send_lock);
                 if( frag->base.des_flags & MCA_BTL_DES_SEND_ALWAYS_CALLBACK ) {
                     frag->base.des_cbfunc(&frag->btl->super, frag->endpoint, &frag->base, frag->rc);
@@ -364,7 +397,7 @@ int mca_btl_tcp_endpoint_send(mca_btl_base_endpoint_t* btl_endpoint, mca_btl_tcp
                 btl_endpoint->endpoint_send_frag = frag;
                 MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true, "event_add(send) [endpoint_send]");
                 frag->base.des_flags |= MCA_BTL_DES_SEND_ALWAYS_CALLBACK;
-                MCA_BTL_TCP_ACTIVATE_EVENT(&btl_endpoint->endpoint_send_event, 0);
+                MCA_BTL_TCP_ACTIVATE_EVENT(btl_endpoint->endpoint_engine, &btl_endpoint->endpoint_send_event, 0);
             }
         } else {
             MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true, "send fragment enqueued [endpoint_send]");
@@ -550,6 +583,19 @@ void mca_btl_tcp_endpoint_close(mca_btl_base_endpoint_t* btl_endpoint)
 
     CLOSE_THE_SOCKET(btl_endpoint->endpoint_sd);
     btl_endpoint->endpoint_sd = -1;
+#if MCA_BTL_TCP_ZEROCOPY
+    /* No more zero-copy notifications will be delivered on this socket */
+    {
+        mca_btl_tcp_frag_t* frag;
+        while( NULL != (frag = (mca_btl_tcp_frag_t*)opal_list_remove_first(&btl_endpoint->endpoint_zc_frags)) ) {
+            if( MCA_BTL_TCP_FAILED == btl_endpoint->endpoint_state ) {
+                frag->rc = OPAL_ERR_UNREACH;
+            }
+            MCA_BTL_TCP_COMPLETE_FRAG_SEND(frag);
+        }
+        btl_endpoint->endpoint_zerocopy = false;
+    }
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
     /**
      * If we keep failing to connect to the peer let the caller know about
      * this situation by triggering the callback on all pending fragments and
@@ -592,6 +638,23 @@ static void mca_btl_tcp_endpoint_connected(mca_btl_base_endpoint_t* btl_endpoint
     btl_endpoint->endpoint_retries = 0;
     MCA_BTL_TCP_ENDPOINT_DUMP(1, btl_endpoint, true, "READY [endpoint_connected]");
 
+#if MCA_BTL_TCP_ZEROCOPY
+    btl_endpoint->endpoint_zc_next = 0;
+    btl_endpoint->endpoint_zc_done = 0;
+    btl_endpoint->endpoint_zerocopy = false;
+    if( 0 < mca_btl_tcp_component.tcp_zerocopy_threshold ) {
+        int flag = 1;
+        if( 0 == setsockopt(btl_endpoint->endpoint_sd, SOL_SOCKET, SO_ZEROCOPY,
+                            (char *)&flag, sizeof(flag)) ) {
+            btl_endpoint->endpoint_zerocopy = true;
+        } else {
+            OPAL_OUTPUT_VERBOSE((10, opal_btl_base_framework.framework_output,
+                                 "btl:tcp: setsockopt(SO_ZEROCOPY) failed: %s (%d)",
+                                 strerror(opal_socket_errno), opal_socket_errno));
+        }
+    }
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+
     if(opal_list_get_size(&btl_endpoint->endpoint_frags) > 0) {
         if(NULL == btl_endpoint->endpoint_send_frag)
             btl_endpoint->endpoint_send_frag = (mca_btl_tcp_frag_t*)
@@ -819,7 +882,7 @@ static int mca_btl_tcp_endpoint_start_connect(mca_btl_base_endpoint_t* btl_endpo
         if(opal_socket_errno == EINPROGRESS || opal_socket_errno == EWOULDBLOCK) {
             btl_endpoint->endpoint_state = MCA_BTL_TCP_CONNECTING;
             MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true, "event_add(send) [start_connect]");
-            MCA_BTL_TCP_ACTIVATE_EVENT(&btl_endpoint->endpoint_send_event, 0);
+            MCA_BTL_TCP_ACTIVATE_EVENT(btl_endpoint->endpoint_engine, &btl_endpoint->endpoint_send_event, 0);
             opal_output_verbose(30, opal_btl_base_framework.framework_output,
                                 "btl:tcp: would block, so allowing background progress");
             return OPAL_SUCCESS;
@@ -928,6 +991,12 @@ static void mca_btl_tcp_endpoint_recv_handler(int sd, short flags, void* user)
     if( sd != btl_endpoint->endpoint_sd )
         return;
 
+#if MCA_BTL_TCP_ZEROCOPY
+    /* zero-copy notifications raise an error condition on the socket,
+     * which is reported through the recv event */
+    mca_btl_tcp_endpoint_zerocopy_reap(btl_endpoint);
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+
     /**
      * There is an extremely rare race condition here, that can only be
      * triggered during the initialization. If the two processes start their
@@ -1054,6 +1123,70 @@ static void mca_btl_tcp_endpoint_recv_handler(int sd, short flags, void* user)
 }
 
 
+#if MCA_BTL_TCP_ZEROCOPY
+/*
+ * Drain the zero-copy completion notifications from the error queue of
+ * the socket, and release the fragments whose data is no longer
+ * referenced by the kernel. On TCP the notifications are delivered in
+ * order, each one covering the range of send ids [ee_info, ee_data].
+ */
+void mca_btl_tcp_endpoint_zerocopy_reap(mca_btl_base_endpoint_t* btl_endpoint)
+{
+    char control[128];
+    struct msghdr msg;
+    struct cmsghdr *cm;
+    struct sock_extended_err *serr;
+    mca_btl_tcp_frag_t *frag, *next;
+    opal_list_t completed;
+
+    /* Always drain the error queue, even without pending fragments: an
+     * unread notification keeps the socket reporting an error, and the
+     * event would fire again on every loop. */
+    OBJ_CONSTRUCT(&completed, opal_list_t);
+    OPAL_THREAD_LOCK(&btl_endpoint->endpoint_send_lock);
+    for( ;; ) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if( recvmsg(btl_endpoint->endpoint_sd, &msg, MSG_ERRQUEUE) < 0 ) {
+            break;  /* EAGAIN: nothing else pending */
+        }
+        for( cm = CMSG_FIRSTHDR(&msg); NULL != cm; cm = CMSG_NXTHDR(&msg, cm) ) {
+            if( !((SOL_IP == cm->cmsg_level && IP_RECVERR == cm->cmsg_type) ||
+                  (SOL_IPV6 == cm->cmsg_level && IPV6_RECVERR == cm->cmsg_type)) ) {
+                continue;
+            }
+            serr = (struct sock_extended_err*)CMSG_DATA(cm);
+            if( SO_EE_ORIGIN_ZEROCOPY != serr->ee_origin || 0 != serr->ee_errno ) {
+                continue;
+            }
+            if( (int32_t)(serr->ee_data + 1 - btl_endpoint->endpoint_zc_done) > 0 ) {
+                btl_endpoint->endpoint_zc_done = serr->ee_data + 1;
+            }
+            if( serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED ) {
+                /* The kernel had to copy the data anyway (e.g. loopback or
+                 * a device without scatter-gather support): stop paying for
+                 * the notifications on this connection. */
+                btl_endpoint->endpoint_zerocopy = false;
+            }
+        }
+    }
+    OPAL_LIST_FOREACH_SAFE(frag, next, &btl_endpoint->endpoint_zc_frags, mca_btl_tcp_frag_t) {
+        if( (int32_t)(frag->zc_last - btl_endpoint->endpoint_zc_done) >= 0 ) {
+            break;  /* the fragments are ordered by send id */
+        }
+        opal_list_remove_item(&btl_endpoint->endpoint_zc_frags, (opal_list_item_t*)frag);
+        opal_list_append(&completed, (opal_list_item_t*)frag);
+    }
+    OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_send_lock);
+
+    while( NULL != (frag = (mca_btl_tcp_frag_t*)opal_list_remove_first(&completed)) ) {
+        MCA_BTL_TCP_COMPLETE_FRAG_SEND(frag);
+    }
+    OBJ_DESTRUCT(&completed);
+}
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+
 /*
  * A file descriptor is available/ready for send. Check the state
  * of the socket and take the appropriate action.
@@ -1072,18 +1205,27 @@ static void mca_btl_tcp_endpoint_send_handler(int sd, short flags, void* user)
         mca_btl_tcp_endpoint_complete_connect(btl_endpoint);
         break;
     case MCA_BTL_TCP_CONNECTED:
-        /* complete the current send */
+        /* complete the current send, together with the fragments that
+         * fit in the same batch */
         while (NULL != btl_endpoint->endpoint_send_frag) {
             mca_btl_tcp_frag_t* frag = btl_endpoint->endpoint_send_frag;
             int btl_ownership = (frag->base.des_flags & MCA_BTL_DES_FLAGS_BTL_OWNERSHIP);
 
-            if(mca_btl_tcp_frag_send(frag, btl_endpoint->endpoint_sd) == false) {
+            if(mca_btl_tcp_frag_send_batch(btl_endpoint, btl_endpoint->endpoint_sd) == false) {
                 break;
             }
             /* progress any pending sends */
             btl_endpoint->endpoint_send_frag = (mca_btl_tcp_frag_t*)
                 opal_list_remove_first(&btl_endpoint->endpoint_frags);
 
+#if MCA_BTL_TCP_ZEROCOPY
+            if( frag->zc_used ) {
+                /* the kernel still references the data, complete later */
+                opal_list_append(&btl_endpoint->endpoint_zc_frags, (opal_list_item_t*)frag);
+                continue;
+            }
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+
             /* if required - update request status and release fragment */
             OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_send_lock);
             assert( frag->base.des_flags & MCA_BTL_DES_SEND_ALWAYS_CALLBACK );
@@ -69,6 +69,13 @@ struct mca_btl_base_endpoint_t {
     opal_event_t                    endpoint_send_event;   /**< event for async processing of send frags */
     opal_event_t                    endpoint_recv_event;   /**< event for async processing of recv frags */
     bool                            endpoint_nbo;          /**< convert headers to network byte order? */
+    struct mca_btl_tcp_progress_engine_t* endpoint_engine; /**< progress engine handling the endpoint events */
+#if MCA_BTL_TCP_ZEROCOPY
+    bool                            endpoint_zerocopy;     /**< is MSG_ZEROCOPY enabled on the socket? */
+    uint32_t                        endpoint_zc_next;      /**< id of the next MSG_ZEROCOPY send */
+    uint32_t                        endpoint_zc_done;      /**< all MSG_ZEROCOPY sends before this id completed */
+    opal_list_t                     endpoint_zc_frags;     /**< sent frags waiting for the zero-copy notification */
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
 };
 
 typedef struct mca_btl_base_endpoint_t mca_btl_base_endpoint_t;
@@ -88,6 +95,9 @@ void mca_btl_tcp_endpoint_close(mca_btl_base_endpoint_t*);
 int  mca_btl_tcp_endpoint_send(mca_btl_base_endpoint_t*, struct mca_btl_tcp_frag_t*);
 void mca_btl_tcp_endpoint_accept(mca_btl_base_endpoint_t*, struct sockaddr*, int);
 void mca_btl_tcp_endpoint_shutdown(mca_btl_base_endpoint_t*);
+#if MCA_BTL_TCP_ZEROCOPY
+void mca_btl_tcp_endpoint_zerocopy_reap(mca_btl_base_endpoint_t*);
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
 
 /*
  * Diagnostics: change this to "1" to enable the function
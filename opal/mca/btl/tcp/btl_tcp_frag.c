@@ -110,55 +110,204 @@ size_t mca_btl_tcp_frag_dump(mca_btl_tcp_frag_t* frag, char* msg, char* buf, siz
     return used;
 }
 
+/*
+ * Consume cnt bytes written on the socket from the iovec state of the
+ * fragment. Returns the number of bytes that belong to the following
+ * fragments.
+ */
+static inline ssize_t mca_btl_tcp_frag_advance(mca_btl_tcp_frag_t* frag, ssize_t cnt)
+{
+    size_t i, num_vecs = frag->iov_cnt;
+
+    for( i = 0; i < num_vecs; i++) {
+        if(cnt >= (ssize_t)frag->iov_ptr->iov_len) {
+            cnt -= frag->iov_ptr->iov_len;
+            frag->iov_ptr++;
+            frag->iov_idx++;
+            frag->iov_cnt--;
+        } else {
+            frag->iov_ptr->iov_base = (opal_iov_base_ptr_t)
+                (((unsigned char*)frag->iov_ptr->iov_base) + cnt);
+            frag->iov_ptr->iov_len -= cnt;
+            return 0;
+        }
+    }
+    return cnt;
+}
+
+/*
+ * Report a failed write and close the endpoint. Returns true if the
+ * write should be retried.
+ */
+static bool mca_btl_tcp_frag_send_error(mca_btl_tcp_frag_t* frag)
+{
+    switch(opal_socket_errno) {
+    case EINTR:
+        return true;
+    case EWOULDBLOCK:
+        return false;
+    case EFAULT:
+        BTL_ERROR(("mca_btl_tcp_frag_send: writev error (%p, %lu)\n\t%s(%lu)\n",
+                   frag->iov_ptr[0].iov_base, (unsigned long) frag->iov_ptr[0].iov_len,
+                   strerror(opal_socket_errno), (unsigned long) frag->iov_cnt));
+        frag->endpoint->endpoint_state = MCA_BTL_TCP_FAILED;
+        mca_btl_tcp_endpoint_close(frag->endpoint);
+        return false;
+    default:
+        BTL_ERROR(("mca_btl_tcp_frag_send: writev failed: %s (%d)",
+                   strerror(opal_socket_errno),
+                   opal_socket_errno));
+        frag->endpoint->endpoint_state = MCA_BTL_TCP_FAILED;
+        mca_btl_tcp_endpoint_close(frag->endpoint);
+        return false;
+    }
+}
+
+#if MCA_BTL_TCP_ZEROCOPY
+/*
+ * Use MSG_ZEROCOPY when the remaining part of the fragment is large
+ * enough for the page pinning and the completion notification to be
+ * cheaper than the copy into the socket buffer.
+ */
+static inline bool mca_btl_tcp_frag_use_zerocopy(mca_btl_tcp_frag_t* frag)
+{
+    size_t i, length = 0;
+
+    if( !frag->endpoint->endpoint_zerocopy ) {
+        return false;
+    }
+    for( i = 0; i < frag->iov_cnt; i++ ) {
+        length += frag->iov_ptr[i].iov_len;
+    }
+    return (length >= mca_btl_tcp_component.tcp_zerocopy_threshold);
+}
+
+/*
+ * Returns -2 if the fragment should be sent with a regular writev. This
+ * is also the case on ENOBUFS, which means the kernel ran out of
+ * resources for the zero-copy notifications.
+ */
+static inline ssize_t mca_btl_tcp_frag_sendmsg_zerocopy(mca_btl_tcp_frag_t* frag, int sd)
+{
+    struct msghdr msg;
+    ssize_t cnt;
+
+    if( !mca_btl_tcp_frag_use_zerocopy(frag) ) {
+        return -2;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = frag->iov_ptr;
+    msg.msg_iovlen = frag->iov_cnt;
+    cnt = sendmsg(sd, &msg, MSG_ZEROCOPY);
+    if( cnt >= 0 ) {
+        /* every successful zero-copy send consumes one notification id */
+        frag->zc_used = true;
+        frag->zc_last = frag->endpoint->endpoint_zc_next++;
+    } else if( ENOBUFS == opal_socket_errno ) {
+        return -2;
+    }
+    return cnt;
+}
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+
 bool mca_btl_tcp_frag_send(mca_btl_tcp_frag_t* frag, int sd)
 {
     ssize_t cnt;
-    size_t i, num_vecs;
 
     /* non-blocking write, but continue if interrupted */
     do {
-        cnt = writev(sd, frag->iov_ptr, frag->iov_cnt);
+#if MCA_BTL_TCP_ZEROCOPY
+        cnt = mca_btl_tcp_frag_sendmsg_zerocopy(frag, sd);
+        if( -2 == cnt )
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+            cnt = writev(sd, frag->iov_ptr, frag->iov_cnt);
         if(cnt < 0) {
-            switch(opal_socket_errno) {
-            case EINTR:
-                continue;
-            case EWOULDBLOCK:
-                return false;
-            case EFAULT:
-                BTL_ERROR(("mca_btl_tcp_frag_send: writev error (%p, %lu)\n\t%s(%lu)\n",
-                    frag->iov_ptr[0].iov_base, (unsigned long) frag->iov_ptr[0].iov_len,
-                    strerror(opal_socket_errno), (unsigned long) frag->iov_cnt));
-                frag->endpoint->endpoint_state = MCA_BTL_TCP_FAILED;
-                mca_btl_tcp_endpoint_close(frag->endpoint);
-                return false;
-            default:
-                BTL_ERROR(("mca_btl_tcp_frag_send: writev failed: %s (%d)",
-                           strerror(opal_socket_errno),
-                           opal_socket_errno));
-                frag->endpoint->endpoint_state = MCA_BTL_TCP_FAILED;
-                mca_btl_tcp_endpoint_close(frag->endpoint);
+            if( !mca_btl_tcp_frag_send_error(frag) ) {
                 return false;
             }
         }
     } while(cnt < 0);
 
     /* if the write didn't complete - update the iovec state */
-    num_vecs = frag->iov_cnt;
-    for( i = 0; i < num_vecs; i++) {
-        if(cnt >= (ssize_t)frag->iov_ptr->iov_len) {
-            cnt -= frag->iov_ptr->iov_len;
-            frag->iov_ptr++;
-            frag->iov_idx++;
-            frag->iov_cnt--;
-        } else {
-            frag->iov_ptr->iov_base = (opal_iov_base_ptr_t)
-                (((unsigned char*)frag->iov_ptr->iov_base) + cnt);
-            frag->iov_ptr->iov_len -= cnt;
-            OPAL_OUTPUT_VERBOSE((100, opal_btl_base_framework.framework_output,
-                                 "%s:%d write %ld bytes on socket %d\n",
-                                 __FILE__, __LINE__, cnt, sd));
+    mca_btl_tcp_frag_advance(frag, cnt);
+    if( 0 != frag->iov_cnt ) {
+        OPAL_OUTPUT_VERBOSE((100, opal_btl_base_framework.framework_output,
+                             "%s:%d write %ld bytes on socket %d\n",
+                             __FILE__, __LINE__, cnt, sd));
+    }
+    return (frag->iov_cnt == 0);
+}
+
+/*
+ * Write the current send fragment of the endpoint together with the
+ * fragments queued behind it using a single writev, so that streams of
+ * small messages cost one system call per batch instead of one per
+ * fragment. The iovec state of every fragment included in the batch is
+ * updated, so the fragments queued behind the current one might already
+ * be (partially) sent when they become the current send fragment.
+ * Fragments eligible for zero-copy are always sent on their own.
+ * Returns true if the current send fragment is completely sent.
+ */
+bool mca_btl_tcp_frag_send_batch(mca_btl_base_endpoint_t* btl_endpoint, int sd)
+{
+    mca_btl_tcp_frag_t* frag = btl_endpoint->endpoint_send_frag;
+    mca_btl_tcp_frag_t* next;
+    struct iovec iov[MCA_BTL_TCP_BATCH_IOVEC_NUMBER];
+    int iov_cnt = 0, frag_cnt = 1;
+    ssize_t cnt;
+
+    if( 0 == frag->iov_cnt ) {
+        /* already sent as part of a previous batch */
+        return true;
+    }
+    if( mca_btl_tcp_component.tcp_send_batch <= 1 ||
+        0 == opal_list_get_size(&btl_endpoint->endpoint_frags) ) {
+        return mca_btl_tcp_frag_send(frag, sd);
+    }
+#if MCA_BTL_TCP_ZEROCOPY
+    if( mca_btl_tcp_frag_use_zerocopy(frag) ) {
+        return mca_btl_tcp_frag_send(frag, sd);
+    }
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+
+    memcpy(iov, frag->iov_ptr, frag->iov_cnt * sizeof(struct iovec));
+    iov_cnt = frag->iov_cnt;
+    OPAL_LIST_FOREACH(next, &btl_endpoint->endpoint_frags, mca_btl_tcp_frag_t) {
+        if( frag_cnt >= mca_btl_tcp_component.tcp_send_batch ||
+            iov_cnt + (int)next->iov_cnt > MCA_BTL_TCP_BATCH_IOVEC_NUMBER ) {
+            break;
+        }
+#if MCA_BTL_TCP_ZEROCOPY
+        if( mca_btl_tcp_frag_use_zerocopy(next) ) {
+            break;
+        }
+#endif  /* MCA_BTL_TCP_ZEROCOPY */
+        memcpy(iov + iov_cnt, next->iov_ptr, next->iov_cnt * sizeof(struct iovec));
+        iov_cnt += next->iov_cnt;
+        frag_cnt++;
+    }
+    if( 1 == frag_cnt ) {
+        return mca_btl_tcp_frag_send(frag, sd);
+    }
+
+    /* non-blocking write, but continue if interrupted */
+    do {
+        cnt = writev(sd, iov, iov_cnt);
+        if(cnt < 0) {
+            if( !mca_btl_tcp_frag_send_error(frag) ) {
+                return false;
+            }
+        }
+    } while(cnt < 0);
+
+    /* distribute the written bytes over the fragments of the batch */
+    cnt = mca_btl_tcp_frag_advance(frag, cnt);
+    OPAL_LIST_FOREACH(next, &btl_endpoint->endpoint_frags, mca_btl_tcp_frag_t) {
+        if( 0 == cnt ) {
             break;
         }
+        cnt = mca_btl_tcp_frag_advance(next, cnt);
     }
     return (frag->iov_cnt == 0);
 }
@@ -42,6 +42,10 @@ BEGIN_C_DECLS
 
 #define MCA_BTL_TCP_FRAG_IOVEC_NUMBER  4
 
+/* Maximum number of iovecs gathered from the queued fragments of an
+ * endpoint into a single writev */
+#define MCA_BTL_TCP_BATCH_IOVEC_NUMBER 64
+
 /**
  * TCP fragment derived type.
  */
@@ -59,6 +63,10 @@ struct mca_btl_tcp_frag_t {
     uint16_t next_step;
     int rc;
     opal_free_list_t* my_list;
+    /* MSG_ZEROCOPY: the fragment cannot be released until the kernel
+     * notifies the completion of zc_last */
+    bool zc_used;
+    uint32_t zc_last;
     /* fake rdma completion */
     struct {
         mca_btl_base_rdma_completion_fn_t func;
@@ -120,12 +128,14 @@ do {                                                                       \
     frag->iov_cnt = 1;                                                     \
     frag->iov_idx = 0;                                                     \
     frag->iov_ptr = frag->iov;                                             \
+    frag->zc_used = false;                                                 \
     frag->base.des_segments = frag->segments;                                 \
     frag->base.des_segment_count = 1;                                        \
 } while(0)
 
 
 bool mca_btl_tcp_frag_send(mca_btl_tcp_frag_t*, int sd);
+bool mca_btl_tcp_frag_send_batch(struct mca_btl_base_endpoint_t*, int sd);
 bool mca_btl_tcp_frag_recv(mca_btl_tcp_frag_t*, int sd);
 size_t mca_btl_tcp_frag_dump(mca_btl_tcp_frag_t* frag, char* msg, char* buf, size_t length);
 END_C_DECLS
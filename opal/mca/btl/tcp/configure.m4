@@ -36,5 +36,14 @@ AC_DEFUN([MCA_opal_btl_tcp_CONFIG],[
 #include <netinet/in.h>
 #endif
 		   ])
+    # zero-copy sends need the error queue notification definitions
+    AS_IF([test "$opal_btl_tcp_happy" = "yes"],
+          [AC_CHECK_HEADERS([linux/errqueue.h])
+           AC_CHECK_DECLS([MSG_ZEROCOPY, SO_ZEROCOPY], [], [],
+                          [AC_INCLUDES_DEFAULT
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+                          ])])
     OPAL_SUMMARY_ADD([[Transports]],[[TCP]],[[btl_tcp]],[$opal_btl_tcp_happy])
 ])dnl
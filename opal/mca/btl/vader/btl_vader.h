@@ -58,6 +58,7 @@
 #include "opal/mca/rcache/base/base.h"
 #include "opal/mca/btl/base/btl_base_error.h"
 #include "opal/mca/mpool/base/base.h"
+#include "opal/mca/memcpy/base/base.h"
 #include "opal/util/proc.h"
 #include "btl_vader_endpoint.h"
 
@@ -129,11 +130,14 @@ struct mca_btl_vader_component_t {
     opal_free_list_t vader_frags_eager;     /**< free list of vader send frags */
     opal_free_list_t vader_frags_max_send;  /**< free list of vader max send frags (large fragments) */
     opal_free_list_t vader_frags_user;      /**< free list of small inline frags */
-    opal_free_list_t vader_fboxes;          /**< free list of available fast-boxes */
+    opal_mutex_t fbox_lock;                 /**< lock protecting the fast box allocator */
 
     unsigned int fbox_threshold;            /**< number of sends required before we setup a send fast box for a peer */
-    unsigned int fbox_max;                  /**< maximum number of send fast boxes to allocate */
-    unsigned int fbox_size;                 /**< size of each peer fast box allocation */
+    unsigned int fbox_max;                  /**< number of default sized send fast boxes that fit in the fast box memory */
+    unsigned int fbox_size;                 /**< default size of a peer fast box allocation */
+    unsigned int fbox_min_size;             /**< smallest fast box allocation */
+    unsigned int fbox_max_size;             /**< largest fast box allocation */
+    unsigned int fbox_grow_threshold;       /**< number of fast box misses before growing a peer's fast box */
 
     int single_copy_mechanism;              /**< single copy mechanism to use */
 
@@ -144,6 +148,8 @@ struct mca_btl_vader_component_t {
     mca_btl_base_endpoint_t *endpoints;     /**< array of local endpoints (one for each local peer including myself) */
     mca_btl_base_endpoint_t **fbox_in_endpoints; /**< array of fast box in endpoints */
     unsigned int num_fbox_in_endpoints;     /**< number of fast boxes to poll */
+    mca_btl_base_endpoint_t **fbox_out_endpoints; /**< array of endpoints with a send fast box */
+    unsigned int num_fbox_out_endpoints;    /**< number of send fast boxes */
     struct vader_fifo_t *my_fifo;           /**< pointer to the local fifo */
 
     opal_list_t pending_endpoints;          /**< list of endpoints with pending fragments */
@@ -188,7 +194,7 @@ OPAL_MODULE_DECLSPEC extern mca_btl_vader_t mca_btl_vader;
 static inline void vader_memmove (void *dst, void *src, size_t size)
 {
     if (size >= (size_t) mca_btl_vader_component.memcpy_limit) {
-        memcpy (dst, src, size);
+        opal_memcpy (dst, src, size);
     } else {
         memmove (dst, src, size);
     }
@@ -303,8 +309,34 @@ int mca_btl_vader_emu_acswap (struct mca_btl_base_module_t *btl, struct mca_btl_
                               mca_btl_base_registration_handle_t *remote_handle, uint64_t compare, uint64_t value, int flags,
                               int order, mca_btl_base_rdma_completion_fn_t cbfunc, void *cbcontext, void *cbdata);
 
+#if OPAL_BTL_VADER_HAVE_XPMEM && OPAL_HAVE_ATOMIC_MATH_64
+int mca_btl_vader_xpmem_aop (struct mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t *endpoint,
+                             uint64_t remote_address, mca_btl_base_registration_handle_t *remote_handle,
+                             mca_btl_base_atomic_op_t op, uint64_t operand, int flags, int order,
+                             mca_btl_base_rdma_completion_fn_t cbfunc, void *cbcontext, void *cbdata);
+
+int mca_btl_vader_xpmem_afop (struct mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t *endpoint,
+                              void *local_address, uint64_t remote_address, mca_btl_base_registration_handle_t *local_handle,
+                              mca_btl_base_registration_handle_t *remote_handle, mca_btl_base_atomic_op_t op,
+                              uint64_t operand, int flags, int order, mca_btl_base_rdma_completion_fn_t cbfunc,
+                              void *cbcontext, void *cbdata);
+
+int mca_btl_vader_xpmem_acswap (struct mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t *endpoint,
+                                void *local_address, uint64_t remote_address, mca_btl_base_registration_handle_t *local_handle,
+                                mca_btl_base_registration_handle_t *remote_handle, uint64_t compare, uint64_t value, int flags,
+                                int order, mca_btl_base_rdma_completion_fn_t cbfunc, void *cbcontext, void *cbdata);
+#endif
+
 void mca_btl_vader_sc_emu_init (void);
 
+#if OPAL_HAVE_ATOMIC_MATH_64
+void mca_btl_vader_sc_emu_atomic_64 (int64_t *operand, opal_atomic_int64_t *addr, mca_btl_base_atomic_op_t op);
+#endif
+
+#if OPAL_HAVE_ATOMIC_MATH_32
+void mca_btl_vader_sc_emu_atomic_32 (int32_t *operand, opal_atomic_int32_t *addr, mca_btl_base_atomic_op_t op);
+#endif
+
 /**
  * Allocate a segment.
  *
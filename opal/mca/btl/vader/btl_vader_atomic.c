@@ -47,3 +47,114 @@ int mca_btl_vader_emu_acswap (struct mca_btl_base_module_t *btl, struct mca_btl_
     return mca_btl_vader_rdma_frag_start (btl, endpoint, MCA_BTL_VADER_OP_CSWAP, compare, value, 0, order,
                                           flags, size, local_address, remote_address, cbfunc, cbcontext, cbdata);
 }
+
+#if OPAL_BTL_VADER_HAVE_XPMEM && OPAL_HAVE_ATOMIC_MATH_64
+/* with xpmem the remote memory can be attached to this process so atomic operations
+ * are done directly with cpu atomics. unlike the emulated operations above these
+ * complete immediately and do not require the target to make progress. */
+static int mca_btl_vader_xpmem_atomic (struct mca_btl_base_endpoint_t *endpoint, uint64_t remote_address,
+                                       mca_btl_base_atomic_op_t op, int flags, int64_t *operand)
+{
+    size_t size = (flags & MCA_BTL_ATOMIC_FLAG_32BIT) ? 4 : 8;
+    mca_rcache_base_registration_t *reg;
+    void *rem_ptr;
+
+    reg = vader_get_registation (endpoint, (void *)(intptr_t) remote_address, size, 0, &rem_ptr);
+    if (OPAL_UNLIKELY(NULL == reg)) {
+        return OPAL_ERROR;
+    }
+
+    if (8 == size) {
+        mca_btl_vader_sc_emu_atomic_64 (operand, (opal_atomic_int64_t *) rem_ptr, op);
+#if OPAL_HAVE_ATOMIC_MATH_32
+    } else {
+        int32_t tmp = (int32_t) *operand;
+        mca_btl_vader_sc_emu_atomic_32 (&tmp, (opal_atomic_int32_t *) rem_ptr, op);
+        *operand = tmp;
+#endif /* OPAL_HAVE_ATOMIC_MATH_32 */
+    }
+
+    vader_return_registration (reg, endpoint);
+
+    return OPAL_SUCCESS;
+}
+
+int mca_btl_vader_xpmem_aop (struct mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t *endpoint,
+                             uint64_t remote_address, mca_btl_base_registration_handle_t *remote_handle,
+                             mca_btl_base_atomic_op_t op, uint64_t operand, int flags, int order,
+                             mca_btl_base_rdma_completion_fn_t cbfunc, void *cbcontext, void *cbdata)
+{
+    int64_t result = (int64_t) operand;
+    int ret;
+
+    ret = mca_btl_vader_xpmem_atomic (endpoint, remote_address, op, flags, &result);
+    if (OPAL_UNLIKELY(OPAL_SUCCESS != ret)) {
+        return ret;
+    }
+
+    /* always call the callback function */
+    cbfunc (btl, endpoint, NULL, NULL, cbcontext, cbdata, OPAL_SUCCESS);
+
+    return OPAL_SUCCESS;
+}
+
+int mca_btl_vader_xpmem_afop (struct mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t *endpoint,
+                              void *local_address, uint64_t remote_address, mca_btl_base_registration_handle_t *local_handle,
+                              mca_btl_base_registration_handle_t *remote_handle, mca_btl_base_atomic_op_t op,
+                              uint64_t operand, int flags, int order, mca_btl_base_rdma_completion_fn_t cbfunc,
+                              void *cbcontext, void *cbdata)
+{
+    int64_t result = (int64_t) operand;
+    int ret;
+
+    ret = mca_btl_vader_xpmem_atomic (endpoint, remote_address, op, flags, &result);
+    if (OPAL_UNLIKELY(OPAL_SUCCESS != ret)) {
+        return ret;
+    }
+
+    if (flags & MCA_BTL_ATOMIC_FLAG_32BIT) {
+        *((int32_t *) local_address) = (int32_t) result;
+    } else {
+        *((int64_t *) local_address) = result;
+    }
+
+    /* always call the callback function */
+    cbfunc (btl, endpoint, local_address, local_handle, cbcontext, cbdata, OPAL_SUCCESS);
+
+    return OPAL_SUCCESS;
+}
+
+int mca_btl_vader_xpmem_acswap (struct mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t *endpoint,
+                                void *local_address, uint64_t remote_address, mca_btl_base_registration_handle_t *local_handle,
+                                mca_btl_base_registration_handle_t *remote_handle, uint64_t compare, uint64_t value, int flags,
+                                int order, mca_btl_base_rdma_completion_fn_t cbfunc, void *cbcontext, void *cbdata)
+{
+    size_t size = (flags & MCA_BTL_ATOMIC_FLAG_32BIT) ? 4 : 8;
+    mca_rcache_base_registration_t *reg;
+    void *rem_ptr;
+
+    reg = vader_get_registation (endpoint, (void *)(intptr_t) remote_address, size, 0, &rem_ptr);
+    if (OPAL_UNLIKELY(NULL == reg)) {
+        return OPAL_ERROR;
+    }
+
+    if (8 == size) {
+        int64_t old = (int64_t) compare;
+        opal_atomic_compare_exchange_strong_64 ((opal_atomic_int64_t *) rem_ptr, &old, (int64_t) value);
+        *((int64_t *) local_address) = old;
+#if OPAL_HAVE_ATOMIC_MATH_32
+    } else {
+        int32_t old = (int32_t) compare;
+        opal_atomic_compare_exchange_strong_32 ((opal_atomic_int32_t *) rem_ptr, &old, (int32_t) value);
+        *((int32_t *) local_address) = old;
+#endif /* OPAL_HAVE_ATOMIC_MATH_32 */
+    }
+
+    vader_return_registration (reg, endpoint);
+
+    /* always call the callback function */
+    cbfunc (btl, endpoint, local_address, local_handle, cbcontext, cbdata, OPAL_SUCCESS);
+
+    return OPAL_SUCCESS;
+}
+#endif /* OPAL_BTL_VADER_HAVE_XPMEM && OPAL_HAVE_ATOMIC_MATH_64 */
@@ -33,6 +33,7 @@
 #include "opal/util/output.h"
 #include "opal/util/show_help.h"
 #include "opal/util/printf.h"
+#include "opal/util/bit_ops.h"
 #include "opal/threads/mutex.h"
 #include "opal/mca/btl/base/btl_base_error.h"
 
@@ -193,16 +194,43 @@ static int mca_btl_vader_component_register (void)
     mca_btl_vader_component.fbox_max = 32;
     (void) mca_base_component_var_register(&mca_btl_vader_component.super.btl_version,
                                            "fbox_max", "Maximum number of eager send buffers "
-                                           "to allocate (default: 32)", MCA_BASE_VAR_TYPE_UNSIGNED_INT,
+                                           "to allocate. The memory reserved for eager send buffers "
+                                           "is fbox_max * fbox_size bytes and is shared by buffers of "
+                                           "all sizes (default: 32)", MCA_BASE_VAR_TYPE_UNSIGNED_INT,
                                            NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
                                            MCA_BASE_VAR_SCOPE_LOCAL, &mca_btl_vader_component.fbox_max);
 
     mca_btl_vader_component.fbox_size = 4096;
     (void) mca_base_component_var_register(&mca_btl_vader_component.super.btl_version,
-                                           "fbox_size", "Size of per-peer fast transfer buffers (default: 4k)",
+                                           "fbox_size", "Size of per-peer fast transfer buffers. Together with fbox_max "
+                                           "it sets the memory reserved for fast transfer buffers (default: 4k)",
                                            MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL, &mca_btl_vader_component.fbox_size);
 
+    mca_btl_vader_component.fbox_min_size = 1024;
+    (void) mca_base_component_var_register(&mca_btl_vader_component.super.btl_version,
+                                           "fbox_min_size", "Smallest per-peer fast transfer buffer. Buffers "
+                                           "are sized from the traffic to each peer and rounded to a power of "
+                                           "two (default: 1k)", MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0,
+                                           MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_btl_vader_component.fbox_min_size);
+
+    mca_btl_vader_component.fbox_max_size = 16384;
+    (void) mca_base_component_var_register(&mca_btl_vader_component.super.btl_version,
+                                           "fbox_max_size", "Largest per-peer fast transfer buffer (default: 16k)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_btl_vader_component.fbox_max_size);
+
+    mca_btl_vader_component.fbox_grow_threshold = 32;
+    (void) mca_base_component_var_register(&mca_btl_vader_component.super.btl_version,
+                                           "fbox_grow_threshold", "Number of fragments that do not fit in a "
+                                           "peer's fast transfer buffer (within 1024 sends) before the buffer "
+                                           "is replaced by a larger one (default: 32)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_btl_vader_component.fbox_grow_threshold);
+
     (void) mca_base_var_enum_create ("btl_vader_single_copy_mechanisms", single_copy_mechanisms, &new_enum);
 
     /* Default to the best available mechanism (see the enumerator for ordering) */
@@ -310,7 +338,7 @@ static int mca_btl_vader_component_open(void)
     OBJ_CONSTRUCT(&mca_btl_vader_component.vader_frags_eager, opal_free_list_t);
     OBJ_CONSTRUCT(&mca_btl_vader_component.vader_frags_user, opal_free_list_t);
     OBJ_CONSTRUCT(&mca_btl_vader_component.vader_frags_max_send, opal_free_list_t);
-    OBJ_CONSTRUCT(&mca_btl_vader_component.vader_fboxes, opal_free_list_t);
+    OBJ_CONSTRUCT(&mca_btl_vader_component.fbox_lock, opal_mutex_t);
     OBJ_CONSTRUCT(&mca_btl_vader_component.lock, opal_mutex_t);
     OBJ_CONSTRUCT(&mca_btl_vader_component.pending_endpoints, opal_list_t);
     OBJ_CONSTRUCT(&mca_btl_vader_component.pending_fragments, opal_list_t);
@@ -331,7 +359,7 @@ static int mca_btl_vader_component_close(void)
     OBJ_DESTRUCT(&mca_btl_vader_component.vader_frags_eager);
     OBJ_DESTRUCT(&mca_btl_vader_component.vader_frags_user);
     OBJ_DESTRUCT(&mca_btl_vader_component.vader_frags_max_send);
-    OBJ_DESTRUCT(&mca_btl_vader_component.vader_fboxes);
+    OBJ_DESTRUCT(&mca_btl_vader_component.fbox_lock);
     OBJ_DESTRUCT(&mca_btl_vader_component.lock);
     OBJ_DESTRUCT(&mca_btl_vader_component.pending_endpoints);
     OBJ_DESTRUCT(&mca_btl_vader_component.pending_fragments);
@@ -427,7 +455,7 @@ static void mca_btl_vader_check_single_copy (void)
     int initial_mechanism = mca_btl_vader_component.single_copy_mechanism;
 #endif
 
-    /* single-copy emulation is always used to support AMO's right now */
+    /* single-copy emulation is used to support AMOs unless xpmem is available */
     mca_btl_vader_sc_emu_init ();
 
 #if OPAL_BTL_VADER_HAVE_XPMEM
@@ -553,6 +581,19 @@ static mca_btl_base_module_t **mca_btl_vader_component_init (int *num_btls,
 
     component->fbox_size = (component->fbox_size + MCA_BTL_VADER_FBOX_ALIGNMENT_MASK) & ~MCA_BTL_VADER_FBOX_ALIGNMENT_MASK;
 
+    /* fast boxes are power of two sized and must fit in the fast box memory */
+    component->fbox_min_size = opal_next_poweroftwo_inclusive (component->fbox_min_size);
+    if (component->fbox_min_size < 8 * MCA_BTL_VADER_FBOX_ALIGNMENT) {
+        component->fbox_min_size = 8 * MCA_BTL_VADER_FBOX_ALIGNMENT;
+    }
+    component->fbox_max_size = opal_next_poweroftwo_inclusive (component->fbox_max_size);
+    while (component->fbox_max_size > 1 && (size_t) component->fbox_max_size > (size_t) component->fbox_max * component->fbox_size) {
+        component->fbox_max_size >>= 1;
+    }
+    if (component->fbox_max_size < component->fbox_min_size) {
+        component->fbox_max_size = component->fbox_min_size;
+    }
+
     if (component->segment_size > (1ul << MCA_BTL_VADER_OFFSET_BITS)) {
         component->segment_size = 2ul << MCA_BTL_VADER_OFFSET_BITS;
     }
@@ -52,6 +52,7 @@ typedef struct mca_btl_base_endpoint_t {
         unsigned char *buffer; /**< starting address of peer's fast box out */
         uint32_t *startp;
         unsigned int start;
+        unsigned int size;     /**< size of the peer's fast box */
         uint16_t seq;
     } fbox_in;
 
@@ -59,13 +60,19 @@ typedef struct mca_btl_base_endpoint_t {
         unsigned char *buffer; /**< starting address of peer's fast box in */
         uint32_t *startp;      /**< pointer to location storing start offset */
         unsigned int start, end;
+        unsigned int size;     /**< size of the fast box */
         uint16_t seq;
-        opal_free_list_item_t *fbox; /**< fast-box free list item */
+        bool retiring;         /**< fast box is being handed back (no more writes allowed) */
+        bool grow;             /**< setup a larger fast box once this one is retired */
+        unsigned int sends;    /**< number of fragments written to the fast box */
+        unsigned int misses;   /**< number of fragments that did not fit since the last reset */
+        unsigned int idle_mark; /**< value of sends at the last reclaim sweep */
     } fbox_out;
 
     int32_t peer_smp_rank;  /**< my peer's SMP process rank.  Used for accessing
                              *   SMP specfic data structures. */
     opal_atomic_size_t send_count;    /**< number of fragments sent to this peer */
+    size_t send_bytes;      /**< bytes sent to this peer through the fifo (used to size the fast box) */
     char *segment_base;     /**< start of the peer's segment (in the address space
                              *   of this process) */
 
@@ -99,22 +106,29 @@ OBJ_CLASS_DECLARATION(mca_btl_vader_endpoint_t);
 static inline void mca_btl_vader_endpoint_setup_fbox_recv (struct mca_btl_base_endpoint_t *endpoint, void *base)
 {
     endpoint->fbox_in.startp = (uint32_t *) base;
+    /* the sender stores the size of the fast box right after the start offset */
+    endpoint->fbox_in.size = ((uint32_t *) base)[1];
     endpoint->fbox_in.start = MCA_BTL_VADER_FBOX_ALIGNMENT;
     endpoint->fbox_in.seq = 0;
     opal_atomic_wmb ();
     endpoint->fbox_in.buffer = base;
 }
 
-static inline void mca_btl_vader_endpoint_setup_fbox_send (struct mca_btl_base_endpoint_t *endpoint, opal_free_list_item_t *fbox)
+static inline void mca_btl_vader_endpoint_setup_fbox_send (struct mca_btl_base_endpoint_t *endpoint, unsigned char *base,
+                                                           unsigned int size)
 {
-    void *base = fbox->ptr;
-
     endpoint->fbox_out.start = MCA_BTL_VADER_FBOX_ALIGNMENT;
     endpoint->fbox_out.end = MCA_BTL_VADER_FBOX_ALIGNMENT;
     endpoint->fbox_out.startp = (uint32_t *) base;
     endpoint->fbox_out.startp[0] = MCA_BTL_VADER_FBOX_ALIGNMENT;
+    endpoint->fbox_out.startp[1] = size;
+    endpoint->fbox_out.size = size;
     endpoint->fbox_out.seq = 0;
-    endpoint->fbox_out.fbox = fbox;
+    endpoint->fbox_out.retiring = false;
+    endpoint->fbox_out.grow = false;
+    endpoint->fbox_out.sends = 0;
+    endpoint->fbox_out.misses = 0;
+    endpoint->fbox_out.idle_mark = 0;
 
     /* zero out the first header in the fast box */
     memset ((char *) base + MCA_BTL_VADER_FBOX_ALIGNMENT, 0, MCA_BTL_VADER_FBOX_ALIGNMENT);
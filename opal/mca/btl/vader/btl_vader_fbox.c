@@ -0,0 +1,286 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "btl_vader.h"
+#include "btl_vader_endpoint.h"
+#include "btl_vader_fifo.h"
+#include "btl_vader_fbox.h"
+
+/*
+ * Fast box memory management.
+ *
+ * All send fast boxes are carved out of a single arena of fbox_max * fbox_size
+ * bytes so the amount of shared memory used by fast boxes does not depend on
+ * how the fast boxes are sized. The arena is managed by a buddy allocator with
+ * power of two blocks between fbox_min_size and fbox_max_size. Peers sending
+ * small messages get small fast boxes, which allows more peers to have a fast
+ * box, and peers that keep filling up their fast box get a larger one.
+ *
+ * When the arena is exhausted the fast boxes that have not been used since the
+ * previous sweep are retired. Retiring is a handshake with the receiver: a
+ * retire marker is written to the fast box and the sender stops writing to it.
+ * When the receiver reaches the marker it stops polling the fast box and
+ * clears the start offset, at which point the memory can be reused.
+ *
+ * The allocator state and the list of send fast boxes are protected by the
+ * fbox_lock. The lock order is fbox_lock then endpoint lock.
+ */
+
+#define MCA_BTL_VADER_FBOX_MAX_ORDERS 16
+
+/** number of average sized fragments a new fast box should be able to hold */
+#define MCA_BTL_VADER_FBOX_MIN_FRAGS  16
+
+static unsigned char *mca_btl_vader_fbox_arena = NULL;
+static unsigned int mca_btl_vader_fbox_num_orders = 0;
+/* stacks of free block offsets (relative to the arena) for each order */
+static unsigned int *mca_btl_vader_fbox_free_blocks[MCA_BTL_VADER_FBOX_MAX_ORDERS];
+static unsigned int mca_btl_vader_fbox_num_free[MCA_BTL_VADER_FBOX_MAX_ORDERS];
+
+static inline unsigned int mca_btl_vader_fbox_order_size (unsigned int order)
+{
+    return mca_btl_vader_component.fbox_min_size << order;
+}
+
+static int mca_btl_vader_fbox_arena_init (void)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+    size_t budget = (size_t) component->fbox_max * component->fbox_size;
+    unsigned int num_orders = 1, num_blocks;
+
+    while (mca_btl_vader_fbox_order_size (num_orders - 1) < component->fbox_max_size &&
+           num_orders < MCA_BTL_VADER_FBOX_MAX_ORDERS) {
+        ++num_orders;
+    }
+
+    num_blocks = budget / mca_btl_vader_fbox_order_size (num_orders - 1);
+    if (0 == num_blocks) {
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    for (unsigned int i = 0 ; i < num_orders ; ++i) {
+        mca_btl_vader_fbox_free_blocks[i] = (unsigned int *) malloc (((size_t) num_blocks << (num_orders - 1 - i)) *
+                                                                     sizeof (unsigned int));
+        if (NULL == mca_btl_vader_fbox_free_blocks[i]) {
+            mca_btl_vader_fbox_fini ();
+            return OPAL_ERR_OUT_OF_RESOURCE;
+        }
+        mca_btl_vader_fbox_num_free[i] = 0;
+    }
+
+    mca_btl_vader_fbox_arena = component->mpool->mpool_alloc (component->mpool, (size_t) num_blocks *
+                                                              mca_btl_vader_fbox_order_size (num_orders - 1),
+                                                              opal_cache_line_size, 0);
+    if (NULL == mca_btl_vader_fbox_arena) {
+        mca_btl_vader_fbox_fini ();
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    mca_btl_vader_fbox_num_orders = num_orders;
+    for (unsigned int i = 0 ; i < num_blocks ; ++i) {
+        mca_btl_vader_fbox_free_blocks[num_orders - 1][i] = i * mca_btl_vader_fbox_order_size (num_orders - 1);
+    }
+    mca_btl_vader_fbox_num_free[num_orders - 1] = num_blocks;
+
+    return OPAL_SUCCESS;
+}
+
+static unsigned char *mca_btl_vader_fbox_block_alloc (unsigned int order)
+{
+    unsigned int offset, i;
+
+    for (i = order ; i < mca_btl_vader_fbox_num_orders && 0 == mca_btl_vader_fbox_num_free[i] ; ++i);
+
+    if (i == mca_btl_vader_fbox_num_orders) {
+        return NULL;
+    }
+
+    offset = mca_btl_vader_fbox_free_blocks[i][--mca_btl_vader_fbox_num_free[i]];
+
+    /* split the block and keep the upper halves */
+    while (i > order) {
+        --i;
+        mca_btl_vader_fbox_free_blocks[i][mca_btl_vader_fbox_num_free[i]++] = offset + mca_btl_vader_fbox_order_size (i);
+    }
+
+    return mca_btl_vader_fbox_arena + offset;
+}
+
+static void mca_btl_vader_fbox_block_free (unsigned char *block, unsigned int size)
+{
+    unsigned int offset = (unsigned int) (block - mca_btl_vader_fbox_arena);
+    unsigned int order = 0;
+
+    while (mca_btl_vader_fbox_order_size (order) < size) {
+        ++order;
+    }
+
+    /* merge with the buddy as long as it is free */
+    for ( ; order < mca_btl_vader_fbox_num_orders - 1 ; ++order) {
+        unsigned int buddy = offset ^ mca_btl_vader_fbox_order_size (order);
+        unsigned int i;
+
+        for (i = 0 ; i < mca_btl_vader_fbox_num_free[order] ; ++i) {
+            if (buddy == mca_btl_vader_fbox_free_blocks[order][i]) {
+                break;
+            }
+        }
+
+        if (i == mca_btl_vader_fbox_num_free[order]) {
+            break;
+        }
+
+        mca_btl_vader_fbox_free_blocks[order][i] =
+            mca_btl_vader_fbox_free_blocks[order][--mca_btl_vader_fbox_num_free[order]];
+        offset &= ~mca_btl_vader_fbox_order_size (order);
+    }
+
+    mca_btl_vader_fbox_free_blocks[order][mca_btl_vader_fbox_num_free[order]++] = offset;
+}
+
+/* give the memory of a send fast box back to the arena. must be called with both the
+ * fbox_lock and the endpoint lock held. */
+static void mca_btl_vader_fbox_out_free (mca_btl_base_endpoint_t *ep)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+
+    for (unsigned int i = 0 ; i < component->num_fbox_out_endpoints ; ++i) {
+        if (ep == component->fbox_out_endpoints[i]) {
+            component->fbox_out_endpoints[i] = component->fbox_out_endpoints[--component->num_fbox_out_endpoints];
+            break;
+        }
+    }
+
+    mca_btl_vader_fbox_block_free (ep->fbox_out.buffer, ep->fbox_out.size);
+    ep->fbox_out.buffer = NULL;
+    ep->fbox_out.retiring = false;
+}
+
+static bool mca_btl_vader_fbox_finish_retire (mca_btl_base_endpoint_t *ep)
+{
+    /* the receiver clears the start offset once it is done with the fast box */
+    if (0 != ((volatile uint32_t *) ep->fbox_out.startp)[0]) {
+        return false;
+    }
+
+    opal_atomic_rmb ();
+
+    BTL_VERBOSE(("fast box of size %u to peer %d retired", ep->fbox_out.size, ep->peer_smp_rank));
+    mca_btl_vader_fbox_out_free (ep);
+
+    return true;
+}
+
+/* retire the fast boxes that were not used since the last sweep and release the
+ * memory of the fast boxes the receivers are done with */
+static void mca_btl_vader_fbox_reclaim (void)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+
+    for (unsigned int i = 0 ; i < component->num_fbox_out_endpoints ; ++i) {
+        mca_btl_base_endpoint_t *ep = component->fbox_out_endpoints[i];
+
+        OPAL_THREAD_LOCK(&ep->lock);
+        if (ep->fbox_out.retiring) {
+            if (mca_btl_vader_fbox_finish_retire (ep)) {
+                /* the last endpoint was moved to this slot */
+                OPAL_THREAD_UNLOCK(&ep->lock);
+                --i;
+                continue;
+            }
+        } else if (ep->fbox_out.sends == ep->fbox_out.idle_mark) {
+            BTL_VERBOSE(("retiring idle fast box of size %u to peer %d", ep->fbox_out.size, ep->peer_smp_rank));
+            (void) mca_btl_vader_fbox_retire (ep);
+        }
+
+        ep->fbox_out.idle_mark = ep->fbox_out.sends;
+        OPAL_THREAD_UNLOCK(&ep->lock);
+    }
+}
+
+unsigned char *mca_btl_vader_fbox_alloc (mca_btl_base_endpoint_t *ep, unsigned int *size)
+{
+    unsigned int order = 0, want;
+    unsigned char *fbox;
+
+    if (OPAL_UNLIKELY(NULL == mca_btl_vader_fbox_arena) && OPAL_SUCCESS != mca_btl_vader_fbox_arena_init ()) {
+        return NULL;
+    }
+
+    if (ep->fbox_out.grow) {
+        /* the previous fast box was too small for this peer's traffic */
+        want = ep->fbox_out.size << 1;
+    } else {
+        /* make room for several average sized fragments */
+        size_t average = ep->send_count ? ep->send_bytes / ep->send_count : 0;
+        want = MCA_BTL_VADER_FBOX_MIN_FRAGS * ((average + sizeof (mca_btl_vader_fbox_hdr_t) + MCA_BTL_VADER_FBOX_ALIGNMENT_MASK) &
+                                               ~MCA_BTL_VADER_FBOX_ALIGNMENT_MASK);
+    }
+
+    while (order < mca_btl_vader_fbox_num_orders - 1 && mca_btl_vader_fbox_order_size (order) < want) {
+        ++order;
+    }
+
+    fbox = mca_btl_vader_fbox_block_alloc (order);
+    if (NULL == fbox) {
+        mca_btl_vader_fbox_reclaim ();
+        fbox = mca_btl_vader_fbox_block_alloc (order);
+    }
+
+    /* settle for a smaller fast box */
+    while (NULL == fbox && order > 0) {
+        fbox = mca_btl_vader_fbox_block_alloc (--order);
+    }
+
+    if (NULL != fbox) {
+        *size = mca_btl_vader_fbox_order_size (order);
+        BTL_VERBOSE(("allocated fast box of size %u for peer %d", *size, ep->peer_smp_rank));
+    }
+
+    return fbox;
+}
+
+bool mca_btl_vader_fbox_retire_complete (mca_btl_base_endpoint_t *ep)
+{
+    bool ret = true;
+
+    OPAL_THREAD_LOCK(&mca_btl_vader_component.fbox_lock);
+    OPAL_THREAD_LOCK(&ep->lock);
+    if (ep->fbox_out.retiring) {
+        ret = mca_btl_vader_fbox_finish_retire (ep);
+    }
+    OPAL_THREAD_UNLOCK(&ep->lock);
+    OPAL_THREAD_UNLOCK(&mca_btl_vader_component.fbox_lock);
+
+    return ret;
+}
+
+void mca_btl_vader_fbox_release (mca_btl_base_endpoint_t *ep)
+{
+    OPAL_THREAD_LOCK(&mca_btl_vader_component.fbox_lock);
+    OPAL_THREAD_LOCK(&ep->lock);
+    if (NULL != ep->fbox_out.buffer) {
+        mca_btl_vader_fbox_out_free (ep);
+    }
+    OPAL_THREAD_UNLOCK(&ep->lock);
+    OPAL_THREAD_UNLOCK(&mca_btl_vader_component.fbox_lock);
+}
+
+void mca_btl_vader_fbox_fini (void)
+{
+    for (unsigned int i = 0 ; i < MCA_BTL_VADER_FBOX_MAX_ORDERS ; ++i) {
+        free (mca_btl_vader_fbox_free_blocks[i]);
+        mca_btl_vader_fbox_free_blocks[i] = NULL;
+        mca_btl_vader_fbox_num_free[i] = 0;
+    }
+
+    /* the arena lives in the shared memory segment and goes away with it */
+    mca_btl_vader_fbox_arena = NULL;
+    mca_btl_vader_fbox_num_orders = 0;
+}
@@ -18,6 +18,15 @@
 
 #define MCA_BTL_VADER_POLL_COUNT 31
 
+/** fast box tags used internally by vader. tags at or above MCA_BTL_VADER_FBOX_TAG_RETIRE are
+ * never delivered to the upper layer */
+#define MCA_BTL_VADER_FBOX_TAG_RETIRE 0xfd /**< the sender is retiring the fast box */
+#define MCA_BTL_VADER_FBOX_TAG_FRAG   0xfe /**< fifo fragment pointer */
+#define MCA_BTL_VADER_FBOX_TAG_SKIP   0xff /**< skip to the beginning of the buffer */
+
+/** number of sends after which the fast box miss count is reset */
+#define MCA_BTL_VADER_FBOX_MISS_WINDOW 1024
+
 typedef union mca_btl_vader_fbox_hdr_t {
     struct {
         /* NTH: on 32-bit platforms loading/unloading the header may be completed
@@ -73,25 +82,23 @@ static inline mca_btl_vader_fbox_hdr_t mca_btl_vader_fbox_read_header (mca_btl_v
     return tmp;
 }
 
-/* attempt to reserve a contiguous segment from the remote ep */
-static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsigned char tag,
+unsigned char *mca_btl_vader_fbox_alloc (mca_btl_base_endpoint_t *ep, unsigned int *size);
+void mca_btl_vader_fbox_release (mca_btl_base_endpoint_t *ep);
+bool mca_btl_vader_fbox_retire_complete (mca_btl_base_endpoint_t *ep);
+void mca_btl_vader_fbox_fini (void);
+
+/* attempt to reserve a contiguous segment from the remote ep. must be called with the endpoint lock held */
+static inline bool mca_btl_vader_fbox_write (mca_btl_base_endpoint_t *ep, unsigned char tag,
                                              void * restrict header, const size_t header_size,
                                              void * restrict payload, const size_t payload_size)
 {
-    const unsigned int fbox_size = mca_btl_vader_component.fbox_size;
+    const unsigned int fbox_size = ep->fbox_out.size;
     size_t size = header_size + payload_size;
     unsigned int start, end, buffer_free;
     size_t data_size = size;
     unsigned char *dst, *data;
     bool hbs, hbm;
 
-    /* don't try to use the per-peer buffer for messages that will fill up more than 25% of the buffer */
-    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer || size > (fbox_size >> 2))) {
-        return false;
-    }
-
-    OPAL_THREAD_LOCK(&ep->lock);
-
     /* the high bit helps determine if the buffer is empty or full */
     hbs = MCA_BTL_VADER_FBOX_OFFSET_HBS(ep->fbox_out.end);
     hbm = MCA_BTL_VADER_FBOX_OFFSET_HBS(ep->fbox_out.start) == hbs;
@@ -126,7 +133,7 @@ static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsign
         if (OPAL_UNLIKELY(buffer_free > 0 && buffer_free < size && start <= end)) {
             BTL_VERBOSE(("message will not fit in remaining buffer space. skipping to beginning"));
 
-            mca_btl_vader_fbox_set_header (MCA_BTL_VADER_FBOX_HDR(dst), 0xff, ep->fbox_out.seq++,
+            mca_btl_vader_fbox_set_header (MCA_BTL_VADER_FBOX_HDR(dst), MCA_BTL_VADER_FBOX_TAG_SKIP, ep->fbox_out.seq++,
                                            buffer_free - sizeof (mca_btl_vader_fbox_hdr_t));
 
             end = MCA_BTL_VADER_FBOX_ALIGNMENT;
@@ -140,7 +147,6 @@ static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsign
         if (OPAL_UNLIKELY(buffer_free < size)) {
             ep->fbox_out.end = (hbs << 31) | end;
             opal_atomic_wmb ();
-            OPAL_THREAD_UNLOCK(&ep->lock);
             return false;
         }
     }
@@ -150,7 +156,9 @@ static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsign
 
     data = dst + sizeof (mca_btl_vader_fbox_hdr_t);
 
-    memcpy (data, header, header_size);
+    if (header_size) {
+        memcpy (data, header, header_size);
+    }
     if (payload) {
         /* inline sends are typically just pml headers (due to MCA_BTL_FLAGS_SEND_INPLACE) */
         memcpy (data + header_size, payload, payload_size);
@@ -173,19 +181,116 @@ static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsign
     /* align the buffer */
     ep->fbox_out.end = ((uint32_t) hbs << 31) | end;
     opal_atomic_wmb ();
-    OPAL_THREAD_UNLOCK(&ep->lock);
 
     return true;
 }
 
+/**
+ * Start handing the fast box back to the local allocator
+ *
+ * A retire marker is written to the fast box. The receiver stops polling the
+ * fast box when it reaches the marker and acknowledges by clearing the start
+ * offset. No fragment can be written to the fast box after the marker. Must be
+ * called with the endpoint lock held.
+ */
+static inline bool mca_btl_vader_fbox_retire (mca_btl_base_endpoint_t *ep)
+{
+    if (ep->fbox_out.retiring) {
+        return true;
+    }
+
+    if (!mca_btl_vader_fbox_write (ep, MCA_BTL_VADER_FBOX_TAG_RETIRE, NULL, 0, NULL, 0)) {
+        return false;
+    }
+
+    ep->fbox_out.retiring = true;
+    return true;
+}
+
+/* record a fragment that did not fit in the fast box. peers that keep missing
+ * get a larger fast box. must be called with the endpoint lock held. */
+static inline void mca_btl_vader_fbox_miss (mca_btl_base_endpoint_t *ep)
+{
+    if (++ep->fbox_out.misses >= mca_btl_vader_component.fbox_grow_threshold &&
+        ep->fbox_out.size < mca_btl_vader_component.fbox_max_size && !ep->fbox_out.retiring) {
+        if (mca_btl_vader_fbox_retire (ep)) {
+            BTL_VERBOSE(("growing fast box of size %u to peer %d", ep->fbox_out.size, ep->peer_smp_rank));
+            ep->fbox_out.grow = true;
+        }
+    }
+}
+
+static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsigned char tag,
+                                             void * restrict header, const size_t header_size,
+                                             void * restrict payload, const size_t payload_size)
+{
+    const size_t size = header_size + payload_size;
+    bool ret;
+
+    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer)) {
+        return false;
+    }
+
+    OPAL_THREAD_LOCK(&ep->lock);
+
+    /* the fast box may have been retired while waiting for the lock */
+    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer || ep->fbox_out.retiring)) {
+        OPAL_THREAD_UNLOCK(&ep->lock);
+        return false;
+    }
+
+    /* don't try to use the per-peer buffer for messages that will fill up more than 25% of the buffer */
+    if (OPAL_UNLIKELY(size > (ep->fbox_out.size >> 2))) {
+        if (size <= (mca_btl_vader_component.fbox_max_size >> 2)) {
+            /* a larger fast box would have been able to hold this fragment */
+            mca_btl_vader_fbox_miss (ep);
+        }
+        OPAL_THREAD_UNLOCK(&ep->lock);
+        return false;
+    }
+
+    ret = mca_btl_vader_fbox_write (ep, tag, header, header_size, payload, payload_size);
+    if (OPAL_LIKELY(ret)) {
+        if (0 == (++ep->fbox_out.sends % MCA_BTL_VADER_FBOX_MISS_WINDOW)) {
+            ep->fbox_out.misses = 0;
+        }
+    } else {
+        /* the receiver is not keeping up with this peer's message rate */
+        mca_btl_vader_fbox_miss (ep);
+    }
+
+    OPAL_THREAD_UNLOCK(&ep->lock);
+
+    return ret;
+}
+
+static inline void mca_btl_vader_fbox_retire_recv (unsigned int index)
+{
+    mca_btl_base_endpoint_t *ep = mca_btl_vader_component.fbox_in_endpoints[index];
+    uint32_t *startp = ep->fbox_in.startp;
+
+    BTL_VERBOSE(("peer %d retired its fast box", ep->peer_smp_rank));
+
+    /* stop polling the fast box */
+    mca_btl_vader_component.fbox_in_endpoints[index] =
+        mca_btl_vader_component.fbox_in_endpoints[--mca_btl_vader_component.num_fbox_in_endpoints];
+    ep->fbox_in.buffer = NULL;
+
+    /* let the sender know the fast box can be reused. a start offset of 0 is never valid */
+    opal_atomic_mb ();
+    startp[0] = 0;
+    (void) opal_atomic_add_fetch_32 (&mca_btl_vader_component.my_fifo->fbox_available, 1);
+}
+
 static inline bool mca_btl_vader_check_fboxes (void)
 {
-    const unsigned int fbox_size = mca_btl_vader_component.fbox_size;
     bool processed = false;
 
     for (unsigned int i = 0 ; i < mca_btl_vader_component.num_fbox_in_endpoints ; ++i) {
         mca_btl_base_endpoint_t *ep = mca_btl_vader_component.fbox_in_endpoints[i];
+        const unsigned int fbox_size = ep->fbox_in.size;
         unsigned int start = ep->fbox_in.start & MCA_BTL_VADER_FBOX_OFFSET_MASK;
+        bool retired = false;
 
         /* save the current high bit state */
         bool hbs = MCA_BTL_VADER_FBOX_OFFSET_HBS(ep->fbox_in.start);
@@ -208,7 +313,7 @@ static inline bool mca_btl_vader_check_fboxes (void)
                          ep->peer_smp_rank, hdr.data.tag, hdr.data.size, hdr.data.seq, start));
 
             /* the 0xff tag indicates we should skip the rest of the buffer */
-            if (OPAL_LIKELY((0xfe & hdr.data.tag) != 0xfe)) {
+            if (OPAL_LIKELY(hdr.data.tag < MCA_BTL_VADER_FBOX_TAG_RETIRE)) {
                 mca_btl_base_segment_t segment;
                 mca_btl_base_descriptor_t desc = {.des_segments = &segment, .des_segment_count = 1};
                 const mca_btl_active_message_callback_t *reg =
@@ -224,11 +329,15 @@ static inline bool mca_btl_vader_check_fboxes (void)
 
                 /* call the registered callback function */
                 reg->cbfunc(&mca_btl_vader.super, hdr.data.tag, &desc, reg->cbdata);
-            } else if (OPAL_LIKELY(0xfe == hdr.data.tag)) {
+            } else if (OPAL_LIKELY(MCA_BTL_VADER_FBOX_TAG_FRAG == hdr.data.tag)) {
                 /* process fragment header */
                 fifo_value_t *value = (fifo_value_t *)(ep->fbox_in.buffer + start + sizeof (hdr));
                 mca_btl_vader_hdr_t *hdr = relative2virtual(*value);
                 mca_btl_vader_poll_handle_frag (hdr, ep);
+            } else if (MCA_BTL_VADER_FBOX_TAG_RETIRE == hdr.data.tag) {
+                /* nothing follows the retire marker */
+                retired = true;
+                break;
             }
 
             start = (start + hdr.data.size + sizeof (hdr) + MCA_BTL_VADER_FBOX_ALIGNMENT_MASK) & ~MCA_BTL_VADER_FBOX_ALIGNMENT_MASK;
@@ -240,6 +349,12 @@ static inline bool mca_btl_vader_check_fboxes (void)
             }
         }
 
+        if (OPAL_UNLIKELY(retired)) {
+            mca_btl_vader_fbox_retire_recv (i--);
+            processed = true;
+            continue;
+        }
+
         if (poll_count) {
             BTL_VERBOSE(("left off at offset %u (hbs: %d)", start, hbs));
 
@@ -257,18 +372,34 @@ static inline bool mca_btl_vader_check_fboxes (void)
 
 static inline void mca_btl_vader_try_fbox_setup (mca_btl_base_endpoint_t *ep, mca_btl_vader_hdr_t *hdr)
 {
-    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer && mca_btl_vader_component.fbox_threshold == OPAL_THREAD_ADD_FETCH_SIZE_T (&ep->send_count, 1))) {
-        /* protect access to mca_btl_vader_component.segment_offset */
-        OPAL_THREAD_LOCK(&mca_btl_vader_component.lock);
+    const unsigned int fbox_threshold = mca_btl_vader_component.fbox_threshold;
+    size_t send_count = OPAL_THREAD_ADD_FETCH_SIZE_T (&ep->send_count, 1);
+
+    /* used to pick the size of the fast box. a lost update only makes the estimate less precise */
+    ep->send_bytes += hdr->len;
+
+    /* try to setup a fast box once the threshold is reached and retry every fbox_threshold sends
+     * if no fast box memory was available. a peer that outgrew its fast box gets a new one right
+     * away. */
+    if (OPAL_LIKELY(!ep->fbox_out.grow && (0 == fbox_threshold || send_count < fbox_threshold ||
+                                           0 != send_count % fbox_threshold))) {
+        return;
+    }
 
-        /* verify the remote side will accept another fbox */
+    /* protect access to the fast box allocator */
+    OPAL_THREAD_LOCK(&mca_btl_vader_component.fbox_lock);
+
+    /* verify the remote side will accept another fbox */
+    if (NULL == ep->fbox_out.buffer) {
         if (0 <= opal_atomic_add_fetch_32 (&ep->fifo->fbox_available, -1)) {
-            opal_free_list_item_t *fbox = opal_free_list_get (&mca_btl_vader_component.vader_fboxes);
+            unsigned int size;
+            unsigned char *fbox = mca_btl_vader_fbox_alloc (ep, &size);
 
             if (NULL != fbox) {
                 /* zero out the fast box */
-                memset (fbox->ptr, 0, mca_btl_vader_component.fbox_size);
-                mca_btl_vader_endpoint_setup_fbox_send (ep, fbox);
+                memset (fbox, 0, size);
+                mca_btl_vader_endpoint_setup_fbox_send (ep, fbox, size);
+                mca_btl_vader_component.fbox_out_endpoints[mca_btl_vader_component.num_fbox_out_endpoints++] = ep;
 
                 hdr->flags |= MCA_BTL_VADER_FLAG_SETUP_FBOX;
                 hdr->fbox_base = virtual2relative((char *) ep->fbox_out.buffer);
@@ -277,10 +408,14 @@ static inline void mca_btl_vader_try_fbox_setup (mca_btl_base_endpoint_t *ep, mc
             }
 
             opal_atomic_wmb ();
+        } else {
+            opal_atomic_add_fetch_32 (&ep->fifo->fbox_available, 1);
         }
-
-        OPAL_THREAD_UNLOCK(&mca_btl_vader_component.lock);
     }
+
+    ep->fbox_out.grow = false;
+
+    OPAL_THREAD_UNLOCK(&mca_btl_vader_component.fbox_lock);
 }
 
 #endif /* !defined(MCA_BTL_VADER_FBOX_H) */
@@ -159,7 +159,10 @@ static inline void vader_fifo_init (vader_fifo_t *fifo)
     /* fifo->fifo_head = fifo->fifo_tail = VADER_FIFO_FREE; */
     fifo->fifo_head = VADER_FIFO_FREE;
     fifo->fifo_tail = VADER_FIFO_FREE;
-    fifo->fbox_available = mca_btl_vader_component.fbox_max;
+    /* the number of fast boxes a peer can set up with us is bounded by the number of the smallest
+     * fast boxes that fit in the fast box memory */
+    fifo->fbox_available = (int32_t) (((size_t) mca_btl_vader_component.fbox_max * mca_btl_vader_component.fbox_size) /
+                                      mca_btl_vader_component.fbox_min_size);
     mca_btl_vader_component.my_fifo = fifo;
 }
 
@@ -201,7 +204,15 @@ static inline bool vader_fifo_write_ep (mca_btl_vader_hdr_t *hdr, struct mca_btl
         /* if there is a fast box for this peer then use the fast box to send the fragment header.
          * this is done to ensure fragment ordering */
         opal_atomic_wmb ();
-        return mca_btl_vader_fbox_sendi (ep, 0xfe, &rhdr, sizeof (rhdr), NULL, 0);
+        if (mca_btl_vader_fbox_sendi (ep, MCA_BTL_VADER_FBOX_TAG_FRAG, &rhdr, sizeof (rhdr), NULL, 0)) {
+            return true;
+        }
+
+        /* once the peer has consumed everything up to the retire marker the fifo can be used
+         * without reordering fragments */
+        if (!ep->fbox_out.retiring || !mca_btl_vader_fbox_retire_complete (ep)) {
+            return false;
+        }
     }
     mca_btl_vader_try_fbox_setup (ep, hdr);
     hdr->next = VADER_FIFO_FREE;
@@ -121,6 +121,14 @@ static int vader_btl_first_time_init(mca_btl_vader_t *vader_btl, int n)
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
+    component->fbox_out_endpoints = calloc (n + 1, sizeof (void *));
+    if (NULL == component->fbox_out_endpoints) {
+        free(component->fbox_in_endpoints);
+        free(component->endpoints);
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+    component->num_fbox_out_endpoints = 0;
+
     component->mpool = mca_mpool_basic_create ((void *) (component->my_segment + MCA_BTL_VADER_FIFO_SIZE),
                                                (unsigned long) (mca_btl_vader_component.segment_size - MCA_BTL_VADER_FIFO_SIZE), 64);
     if (NULL == component->mpool) {
@@ -128,13 +136,7 @@ static int vader_btl_first_time_init(mca_btl_vader_t *vader_btl, int n)
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
-    rc = opal_free_list_init (&component->vader_fboxes, sizeof (opal_free_list_item_t), 8,
-                              OBJ_CLASS(opal_free_list_item_t), mca_btl_vader_component.fbox_size,
-                              opal_cache_line_size, 0, mca_btl_vader_component.fbox_max, 4,
-                              component->mpool, 0, NULL, NULL, NULL);
-    if (OPAL_SUCCESS != rc) {
-        return rc;
-    }
+    /* the fast box memory is allocated from the mpool the first time a fast box is needed */
 
     /* initialize fragment descriptor free lists */
     /* initialize free list for small send and inline fragments */
@@ -438,6 +440,10 @@ static int vader_finalize(struct mca_btl_base_module_t *btl)
     free (component->fbox_in_endpoints);
     component->fbox_in_endpoints = NULL;
 
+    free (component->fbox_out_endpoints);
+    component->fbox_out_endpoints = NULL;
+    mca_btl_vader_fbox_fini ();
+
     if (MCA_BTL_VADER_XPMEM != mca_btl_vader_component.single_copy_mechanism) {
         opal_shmem_unlink (&mca_btl_vader_component.seg_ds);
         opal_shmem_segment_detach (&mca_btl_vader_component.seg_ds);
@@ -590,7 +596,7 @@ static struct mca_btl_base_descriptor_t *vader_prepare_src (struct mca_btl_base_
         } else {
 #endif
             /* NTH: the covertor adds some latency so we bypass it here */
-            memcpy ((void *)((uintptr_t)frag->segments[0].seg_addr.pval + reserve), data_ptr, *size);
+            opal_memcpy ((void *)((uintptr_t)frag->segments[0].seg_addr.pval + reserve), data_ptr, *size);
             frag->segments[0].seg_len = total_size;
 #if OPAL_BTL_VADER_HAVE_XPMEM
         }
@@ -618,7 +624,10 @@ static void mca_btl_vader_endpoint_constructor (mca_btl_vader_endpoint_t *ep)
     OBJ_CONSTRUCT(&ep->pending_frags, opal_list_t);
     OBJ_CONSTRUCT(&ep->pending_frags_lock, opal_mutex_t);
     ep->fifo = NULL;
-    ep->fbox_out.fbox = NULL;
+    ep->fbox_out.buffer = NULL;
+    ep->fbox_out.retiring = false;
+    ep->fbox_out.grow = false;
+    ep->send_bytes = 0;
 }
 
 #if OPAL_BTL_VADER_HAVE_XPMEM
@@ -647,12 +656,11 @@ static void mca_btl_vader_endpoint_destructor (mca_btl_vader_endpoint_t *ep)
         /* disconnect from the peer's segment */
         opal_shmem_segment_detach (&seg_ds);
     }
-    if (ep->fbox_out.fbox) {
-        opal_free_list_return (&mca_btl_vader_component.vader_fboxes, ep->fbox_out.fbox);
+    if (ep->fbox_out.buffer) {
+        mca_btl_vader_fbox_release (ep);
     }
 
     ep->fbox_in.buffer = ep->fbox_out.buffer = NULL;
-    ep->fbox_out.fbox = NULL;
     ep->segment_base = NULL;
     ep->fifo = NULL;
 }
@@ -70,6 +70,13 @@ int mca_btl_vader_xpmem_init (void)
     mca_btl_vader.super.btl_get = mca_btl_vader_get_xpmem;
     mca_btl_vader.super.btl_put = mca_btl_vader_put_xpmem;
 
+#if OPAL_HAVE_ATOMIC_MATH_64
+    /* the target memory is directly accessible so atomics do not need to be emulated */
+    mca_btl_vader.super.btl_atomic_op = mca_btl_vader_xpmem_aop;
+    mca_btl_vader.super.btl_atomic_fop = mca_btl_vader_xpmem_afop;
+    mca_btl_vader.super.btl_atomic_cswap = mca_btl_vader_xpmem_acswap;
+#endif
+
     return OPAL_SUCCESS;
 }
 
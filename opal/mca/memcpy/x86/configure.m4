@@ -0,0 +1,55 @@
+# -*- shell-script -*-
+#
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+AC_DEFUN([MCA_opal_memcpy_x86_PRIORITY], [30])
+
+AC_DEFUN([MCA_opal_memcpy_x86_COMPILE_MODE], [
+    AC_MSG_CHECKING([for MCA component $2:$3 compile mode])
+    $4="static"
+    AC_MSG_RESULT([$$4])
+])
+
+AC_DEFUN([MCA_opal_memcpy_x86_POST_CONFIG],[
+    AS_IF([test "$1" = "1"], [memcpy_base_include="x86/memcpy_x86.h"])
+])dnl
+
+# MCA_memcpy_x86_CONFIG(action-if-can-compile,
+#                       [action-if-cant-compile])
+# ------------------------------------------------
+AC_DEFUN([MCA_opal_memcpy_x86_CONFIG],[
+    AC_CONFIG_FILES([opal/mca/memcpy/x86/Makefile])
+
+    memcpy_x86_happy="no"
+
+    case "${host}" in
+    x86_64-*)
+        # the copy routines for each instruction set are compiled with the
+        # target attribute and selected at runtime based on the CPU features
+        AC_CACHE_CHECK([if the compiler supports runtime selected AVX2 and AVX-512 functions],
+                       [opal_cv_memcpy_x86_target],
+                       [AC_LINK_IFELSE([AC_LANG_PROGRAM([[#include <immintrin.h>
+__attribute__((target("avx2"))) static void copy_avx2 (void *d, const void *s) {
+    _mm256_stream_si256 ((__m256i *) d, _mm256_loadu_si256 ((const __m256i *) s));
+}
+__attribute__((target("avx512f"))) static void copy_avx512 (void *d, const void *s) {
+    _mm512_stream_si512 ((__m512i *) d, _mm512_loadu_si512 (s));
+}]],
+                                                        [[static char buffer[256] __attribute__((aligned(64)));
+    if (__builtin_cpu_supports ("avx512f")) copy_avx512 (buffer, buffer + 128);
+    if (__builtin_cpu_supports ("avx2")) copy_avx2 (buffer, buffer + 128);
+    _mm_sfence ();]])],
+                                        [opal_cv_memcpy_x86_target="yes"],
+                                        [opal_cv_memcpy_x86_target="no"])])
+        memcpy_x86_happy="$opal_cv_memcpy_x86_target"
+        ;;
+    esac
+
+    AS_IF([test "$memcpy_x86_happy" = "yes"],
+          [$1],
+          [$2])
+])
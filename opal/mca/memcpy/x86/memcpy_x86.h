@@ -0,0 +1,65 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H
+#define OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H
+
+#include "opal_config.h"
+
+#include <string.h>
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+
+#include "opal/prefetch.h"
+
+BEGIN_C_DECLS
+
+/**
+ * Copies smaller than this threshold are left to the C library. Larger
+ * copies bypass the cache with non-temporal stores, so a large copy does
+ * not evict the working set of the process (or of the peer reading a
+ * shared memory buffer).
+ */
+OPAL_DECLSPEC extern size_t opal_memcpy_x86_nt_threshold;
+
+/**
+ * Copy length bytes with non-temporal stores using the best instruction
+ * set supported by the CPU. The stores are fenced before returning.
+ */
+OPAL_DECLSPEC void *opal_memcpy_x86_stream (void *dst, const void *src, size_t length);
+
+/**
+ * Gather/scatter copies. The decision to bypass the cache is made on the
+ * total length and the stores are only fenced once for the whole batch.
+ */
+OPAL_DECLSPEC void opal_memcpy_x86_tov (const struct iovec *dst_iov, const void *src, int count);
+OPAL_DECLSPEC void opal_memcpy_x86_fromv (void *dst, const struct iovec *src_iov, int count);
+
+static inline void *opal_memcpy_x86 (void *dst, const void *src, size_t length)
+{
+    if (OPAL_LIKELY(length < opal_memcpy_x86_nt_threshold)) {
+        return memcpy (dst, src, length);
+    }
+
+    return opal_memcpy_x86_stream (dst, src, length);
+}
+
+END_C_DECLS
+
+#define opal_memcpy( dst, src, length ) \
+    opal_memcpy_x86( (dst), (src), (length) )
+
+#define opal_memcpy_tov( dst_iov, src, count ) \
+    opal_memcpy_x86_tov( (dst_iov), (src), (count) )
+
+#define opal_memcpy_fromv( dst, src_iov, count ) \
+    opal_memcpy_x86_fromv( (dst), (src_iov), (count) )
+
+#endif /* OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H */
@@ -0,0 +1,296 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <immintrin.h>
+
+#include "opal/constants.h"
+#include "opal/mca/base/mca_base_var.h"
+#include "opal/mca/memcpy/memcpy.h"
+#include "opal/mca/memcpy/base/base.h"
+#include "opal/util/output.h"
+
+/*
+ * Only the copies larger than the non-temporal threshold are handled here,
+ * the C library memcpy is already tuned for the cache resident sizes. The
+ * copy loops for each instruction set are compiled with the target attribute
+ * and the best one supported by the CPU is selected when the component is
+ * opened.
+ */
+
+/** pieces of a batch smaller than this are copied through the cache */
+#define OPAL_MEMCPY_X86_STREAM_MIN 256
+
+/** used when the size of the caches cannot be found */
+#define OPAL_MEMCPY_X86_DEFAULT_NT_THRESHOLD (1024 * 1024)
+
+enum {
+    OPAL_MEMCPY_X86_ISA_AUTO,
+    OPAL_MEMCPY_X86_ISA_SSE2,
+    OPAL_MEMCPY_X86_ISA_AVX2,
+    OPAL_MEMCPY_X86_ISA_AVX512,
+};
+
+static mca_base_var_enum_value_t opal_memcpy_x86_isa_values[] = {
+    {.value = OPAL_MEMCPY_X86_ISA_AUTO, .string = "auto"},
+    {.value = OPAL_MEMCPY_X86_ISA_SSE2, .string = "sse2"},
+    {.value = OPAL_MEMCPY_X86_ISA_AVX2, .string = "avx2"},
+    {.value = OPAL_MEMCPY_X86_ISA_AVX512, .string = "avx512"},
+    {.value = 0, .string = NULL}
+};
+
+typedef void (*opal_memcpy_x86_stream_fn_t) (unsigned char *dst, const unsigned char *src, size_t length);
+
+static int opal_memcpy_x86_register (void);
+static int opal_memcpy_x86_open (void);
+static void opal_memcpy_x86_stream_sse2 (unsigned char *dst, const unsigned char *src, size_t length);
+
+/* do not bypass the cache until the component is opened */
+size_t opal_memcpy_x86_nt_threshold = SIZE_MAX;
+
+static opal_memcpy_x86_stream_fn_t opal_memcpy_x86_stream_fn = opal_memcpy_x86_stream_sse2;
+static int opal_memcpy_x86_isa = OPAL_MEMCPY_X86_ISA_AUTO;
+static size_t opal_memcpy_x86_nt_threshold_param = 0;
+
+const opal_memcpy_base_component_2_0_0_t mca_memcpy_x86_component = {
+    /* First, the mca_component_t struct containing meta information
+       about the component itself */
+    .memcpyc_version = {
+        OPAL_MEMCPY_BASE_VERSION_2_0_0,
+
+        /* Component name and version */
+        .mca_component_name = "x86",
+        MCA_BASE_MAKE_VERSION(component, OPAL_MAJOR_VERSION, OPAL_MINOR_VERSION,
+                              OPAL_RELEASE_VERSION),
+
+        /* Component open and register functions */
+        .mca_open_component = opal_memcpy_x86_open,
+        .mca_register_component_params = opal_memcpy_x86_register,
+    },
+    .memcpyc_data = {
+        /* The component is checkpoint ready */
+        MCA_BASE_METADATA_PARAM_CHECKPOINT
+    },
+};
+
+/* copy up to the first aligned destination address through the cache */
+#define OPAL_MEMCPY_X86_ALIGN_DST(dst, src, length, alignment)          \
+    do {                                                                \
+        size_t _head = (-(uintptr_t) (dst)) & ((alignment) - 1);        \
+        if (_head > (length)) {                                         \
+            _head = (length);                                           \
+        }                                                               \
+        if (_head) {                                                    \
+            memcpy ((dst), (src), _head);                               \
+            (dst) += _head;                                             \
+            (src) += _head;                                             \
+            (length) -= _head;                                          \
+        }                                                               \
+    } while (0)
+
+static void opal_memcpy_x86_stream_sse2 (unsigned char *dst, const unsigned char *src, size_t length)
+{
+    OPAL_MEMCPY_X86_ALIGN_DST(dst, src, length, 16);
+
+    for ( ; length >= 64 ; length -= 64, dst += 64, src += 64) {
+        __m128i a = _mm_loadu_si128 ((const __m128i *) src);
+        __m128i b = _mm_loadu_si128 ((const __m128i *) (src + 16));
+        __m128i c = _mm_loadu_si128 ((const __m128i *) (src + 32));
+        __m128i d = _mm_loadu_si128 ((const __m128i *) (src + 48));
+        _mm_stream_si128 ((__m128i *) dst, a);
+        _mm_stream_si128 ((__m128i *) (dst + 16), b);
+        _mm_stream_si128 ((__m128i *) (dst + 32), c);
+        _mm_stream_si128 ((__m128i *) (dst + 48), d);
+    }
+
+    if (length) {
+        memcpy (dst, src, length);
+    }
+}
+
+__attribute__((target("avx2")))
+static void opal_memcpy_x86_stream_avx2 (unsigned char *dst, const unsigned char *src, size_t length)
+{
+    OPAL_MEMCPY_X86_ALIGN_DST(dst, src, length, 32);
+
+    for ( ; length >= 128 ; length -= 128, dst += 128, src += 128) {
+        __m256i a = _mm256_loadu_si256 ((const __m256i *) src);
+        __m256i b = _mm256_loadu_si256 ((const __m256i *) (src + 32));
+        __m256i c = _mm256_loadu_si256 ((const __m256i *) (src + 64));
+        __m256i d = _mm256_loadu_si256 ((const __m256i *) (src + 96));
+        _mm256_stream_si256 ((__m256i *) dst, a);
+        _mm256_stream_si256 ((__m256i *) (dst + 32), b);
+        _mm256_stream_si256 ((__m256i *) (dst + 64), c);
+        _mm256_stream_si256 ((__m256i *) (dst + 96), d);
+    }
+
+    if (length) {
+        memcpy (dst, src, length);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void opal_memcpy_x86_stream_avx512 (unsigned char *dst, const unsigned char *src, size_t length)
+{
+    OPAL_MEMCPY_X86_ALIGN_DST(dst, src, length, 64);
+
+    for ( ; length >= 256 ; length -= 256, dst += 256, src += 256) {
+        __m512i a = _mm512_loadu_si512 ((const void *) src);
+        __m512i b = _mm512_loadu_si512 ((const void *) (src + 64));
+        __m512i c = _mm512_loadu_si512 ((const void *) (src + 128));
+        __m512i d = _mm512_loadu_si512 ((const void *) (src + 192));
+        _mm512_stream_si512 ((__m512i *) dst, a);
+        _mm512_stream_si512 ((__m512i *) (dst + 64), b);
+        _mm512_stream_si512 ((__m512i *) (dst + 128), c);
+        _mm512_stream_si512 ((__m512i *) (dst + 192), d);
+    }
+
+    if (length) {
+        memcpy (dst, src, length);
+    }
+}
+
+void *opal_memcpy_x86_stream (void *dst, const void *src, size_t length)
+{
+    opal_memcpy_x86_stream_fn ((unsigned char *) dst, (const unsigned char *) src, length);
+    /* non-temporal stores are weakly ordered */
+    _mm_sfence ();
+
+    return dst;
+}
+
+static inline bool opal_memcpy_x86_batch_stream (const struct iovec *iov, int count)
+{
+    size_t total = 0;
+
+    for (int i = 0 ; i < count ; ++i) {
+        total += iov[i].iov_len;
+    }
+
+    return total >= opal_memcpy_x86_nt_threshold;
+}
+
+void opal_memcpy_x86_tov (const struct iovec *dst_iov, const void *src, int count)
+{
+    const unsigned char *source = (const unsigned char *) src;
+    bool stream = opal_memcpy_x86_batch_stream (dst_iov, count);
+
+    for (int i = 0 ; i < count ; ++i) {
+        if (stream && dst_iov[i].iov_len >= OPAL_MEMCPY_X86_STREAM_MIN) {
+            opal_memcpy_x86_stream_fn ((unsigned char *) dst_iov[i].iov_base, source, dst_iov[i].iov_len);
+        } else {
+            memcpy (dst_iov[i].iov_base, source, dst_iov[i].iov_len);
+        }
+        source += dst_iov[i].iov_len;
+    }
+
+    if (stream) {
+        _mm_sfence ();
+    }
+}
+
+void opal_memcpy_x86_fromv (void *dst, const struct iovec *src_iov, int count)
+{
+    unsigned char *destination = (unsigned char *) dst;
+    bool stream = opal_memcpy_x86_batch_stream (src_iov, count);
+
+    for (int i = 0 ; i < count ; ++i) {
+        if (stream && src_iov[i].iov_len >= OPAL_MEMCPY_X86_STREAM_MIN) {
+            opal_memcpy_x86_stream_fn (destination, (const unsigned char *) src_iov[i].iov_base, src_iov[i].iov_len);
+        } else {
+            memcpy (destination, src_iov[i].iov_base, src_iov[i].iov_len);
+        }
+        destination += src_iov[i].iov_len;
+    }
+
+    if (stream) {
+        _mm_sfence ();
+    }
+}
+
+static int opal_memcpy_x86_register (void)
+{
+    mca_base_var_enum_t *new_enum;
+
+    (void) mca_base_var_enum_create ("memcpy_x86_isa", opal_memcpy_x86_isa_values, &new_enum);
+    (void) mca_base_component_var_register (&mca_memcpy_x86_component.memcpyc_version, "isa",
+                                            "Instruction set used for the non-temporal copies. auto selects "
+                                            "the widest one supported by the processor",
+                                            MCA_BASE_VAR_TYPE_INT, new_enum, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_LOCAL, &opal_memcpy_x86_isa);
+    OBJ_RELEASE(new_enum);
+
+    (void) mca_base_component_var_register (&mca_memcpy_x86_component.memcpyc_version, "nt_threshold",
+                                            "Copies of at least this many bytes use non-temporal stores and "
+                                            "do not pollute the cache (0 = half of the last level cache)",
+                                            MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_LOCAL, &opal_memcpy_x86_nt_threshold_param);
+
+    return OPAL_SUCCESS;
+}
+
+static size_t opal_memcpy_x86_default_threshold (void)
+{
+    long cache_size = -1;
+
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    cache_size = sysconf (_SC_LEVEL3_CACHE_SIZE);
+#endif
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    if (cache_size <= 0) {
+        cache_size = sysconf (_SC_LEVEL2_CACHE_SIZE);
+    }
+#endif
+
+    return (cache_size > 0) ? (size_t) cache_size / 2 : OPAL_MEMCPY_X86_DEFAULT_NT_THRESHOLD;
+}
+
+static int opal_memcpy_x86_open (void)
+{
+    int isa = opal_memcpy_x86_isa;
+
+    __builtin_cpu_init ();
+
+    if (OPAL_MEMCPY_X86_ISA_AUTO == isa) {
+        isa = OPAL_MEMCPY_X86_ISA_AVX512;
+    }
+
+    if (OPAL_MEMCPY_X86_ISA_AVX512 == isa && !__builtin_cpu_supports ("avx512f")) {
+        isa = OPAL_MEMCPY_X86_ISA_AVX2;
+    }
+
+    if (OPAL_MEMCPY_X86_ISA_AVX2 == isa && !__builtin_cpu_supports ("avx2")) {
+        isa = OPAL_MEMCPY_X86_ISA_SSE2;
+    }
+
+    switch (isa) {
+    case OPAL_MEMCPY_X86_ISA_AVX512:
+        opal_memcpy_x86_stream_fn = opal_memcpy_x86_stream_avx512;
+        break;
+    case OPAL_MEMCPY_X86_ISA_AVX2:
+        opal_memcpy_x86_stream_fn = opal_memcpy_x86_stream_avx2;
+        break;
+    default:
+        opal_memcpy_x86_stream_fn = opal_memcpy_x86_stream_sse2;
+    }
+
+    opal_memcpy_x86_nt_threshold = opal_memcpy_x86_nt_threshold_param ? opal_memcpy_x86_nt_threshold_param :
+        opal_memcpy_x86_default_threshold ();
+
+    opal_output_verbose (5, opal_memcpy_base_framework.framework_output,
+                         "memcpy:x86: using %s non-temporal copies above %lu bytes",
+                         opal_memcpy_x86_isa_values[isa].string, (unsigned long) opal_memcpy_x86_nt_threshold);
+
+    return OPAL_SUCCESS;
+}
@@ -77,6 +77,8 @@ bool opal_abort_print_stack = false;
 int opal_abort_delay = 0;
 
 int opal_max_thread_in_progress = 1;
+int opal_wait_sync_spin_max = 1000;
+int opal_wait_sync_yield_count = 0;
 
 static bool opal_register_done = false;
 
@@ -375,6 +377,20 @@ int opal_register_params(void)
             MCA_BASE_VAR_TYPE_INT, NULL, 0, 0, OPAL_INFO_LVL_8,
             MCA_BASE_VAR_SCOPE_READONLY, &opal_max_thread_in_progress);
 
+    /* Blocking waits poll their synchronization object for a while before sleeping */
+    (void)mca_base_var_register ("opal", "opal", NULL, "wait_sync_spin_max",
+            "Maximum number of times a thread blocked in a wait polls for completion before "
+            "going to sleep while another thread is progressing. The actual number adapts to "
+            "the recently observed completion latency. 0 disables spinning. Default: 1000",
+            MCA_BASE_VAR_TYPE_INT, NULL, 0, 0, OPAL_INFO_LVL_8,
+            MCA_BASE_VAR_SCOPE_READONLY, &opal_wait_sync_spin_max);
+
+    (void)mca_base_var_register ("opal", "opal", NULL, "wait_sync_yield_count",
+            "Number of times a thread blocked in a wait yields the processor after spinning "
+            "and before going to sleep. Default: 0",
+            MCA_BASE_VAR_TYPE_INT, NULL, 0, 0, OPAL_INFO_LVL_8,
+            MCA_BASE_VAR_SCOPE_READONLY, &opal_wait_sync_yield_count);
+
     /* The ddt engine has a few parameters */
     ret = opal_datatype_register_params();
     if (OPAL_SUCCESS != ret) {
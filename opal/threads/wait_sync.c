@@ -14,11 +14,43 @@
  */
 #include "wait_sync.h"
 
+#include <sched.h>
+
 static opal_mutex_t wait_sync_lock = OPAL_MUTEX_STATIC_INIT;
 static ompi_wait_sync_t* wait_sync_list = NULL;
 
 static opal_atomic_int32_t num_thread_in_progress = 0;
 
+/* Smoothed number of polling iterations it took for a sync to complete
+ * while its owner was spinning. The spin budget is twice this value,
+ * bounded by opal_wait_sync_spin_max. It is only a heuristic, so it is
+ * updated without atomics. */
+#define WAIT_SYNC_SPIN_MIN 16
+static int32_t wait_sync_spin_latency = WAIT_SYNC_SPIN_MIN;
+
+#if OPAL_WAIT_SYNC_HAVE_FUTEX
+
+#define WAIT_SYNC_LOCK(who)
+#define WAIT_SYNC_UNLOCK(who)
+
+#define WAIT_SYNC_PASS_OWNERSHIP(who)   WAIT_SYNC_WAKEUP(who)
+
+/* Go to sleep unless a wakeup has been posted since the last time the
+ * wakeup word was cleared. */
+#define WAIT_SYNC_SLEEP(who)                                            \
+    do {                                                                \
+        int32_t _expected = 0;                                          \
+        if (opal_atomic_compare_exchange_strong_32(&(who)->wakeup, &_expected, 2)) { \
+            (void) syscall(SYS_futex, &(who)->wakeup, FUTEX_WAIT_PRIVATE, \
+                           2, NULL, NULL, 0);                           \
+        }                                                               \
+    } while (0)
+
+#else
+
+#define WAIT_SYNC_LOCK(who)     pthread_mutex_lock(&(who)->lock)
+#define WAIT_SYNC_UNLOCK(who)   pthread_mutex_unlock(&(who)->lock)
+
 #define WAIT_SYNC_PASS_OWNERSHIP(who)                  \
     do {                                               \
         pthread_mutex_lock( &(who)->lock);             \
@@ -26,6 +58,53 @@ static opal_atomic_int32_t num_thread_in_progress = 0;
         pthread_mutex_unlock( &(who)->lock);           \
     } while(0)
 
+#define WAIT_SYNC_SLEEP(who)    pthread_cond_wait(&(who)->condition, &(who)->lock)
+
+#endif  /* OPAL_WAIT_SYNC_HAVE_FUTEX */
+
+/**
+ * Poll the sync for a bounded amount of time before the caller goes to
+ * sleep. Returns true if the sync completed while polling. The budget
+ * tracks the recently observed completion latency: when completions
+ * come fast spinning avoids the sleep/wakeup cost, and when they come
+ * slowly (e.g. oversubscribed nodes) threads quickly stop burning cores.
+ */
+static bool wait_sync_spin(ompi_wait_sync_t *sync)
+{
+    int32_t budget = 2 * wait_sync_spin_latency, i;
+
+    if (budget > opal_wait_sync_spin_max) {
+        budget = opal_wait_sync_spin_max;
+    }
+
+    for (i = 0; i < budget; ++i) {
+        if (sync->count <= 0) {
+            wait_sync_spin_latency = (wait_sync_spin_latency + i) / 2;
+            if (wait_sync_spin_latency < WAIT_SYNC_SPIN_MIN) {
+                wait_sync_spin_latency = WAIT_SYNC_SPIN_MIN;
+            }
+            return true;
+        }
+        opal_atomic_rmb();
+    }
+
+    for (i = 0; i < opal_wait_sync_yield_count; ++i) {
+        if (sync->count <= 0) {
+            return true;
+        }
+        sched_yield();
+    }
+
+    /* the sync did not complete within the budget: remember that the
+     * completion latency is larger than what we spent polling */
+    wait_sync_spin_latency = (wait_sync_spin_latency + 2 * budget) / 2;
+    if (wait_sync_spin_latency > opal_wait_sync_spin_max) {
+        wait_sync_spin_latency = opal_wait_sync_spin_max;
+    }
+
+    return (sync->count <= 0);
+}
+
 int ompi_sync_wait_mt(ompi_wait_sync_t *sync)
 {
     /* Don't stop if the waiting synchronization is completed. We avoid the
@@ -35,14 +114,23 @@ int ompi_sync_wait_mt(ompi_wait_sync_t *sync)
     if(sync->count <= 0)
         return (0 == sync->status) ? OPAL_SUCCESS : OPAL_ERROR;
 
+    /* If another thread is already taking care of the progress, give the
+     * sync a chance to complete before paying for the sleep and wakeup.
+     */
+    if( opal_wait_sync_spin_max > 0 &&
+        num_thread_in_progress >= opal_max_thread_in_progress &&
+        wait_sync_spin(sync) ) {
+        return (0 == sync->status) ? OPAL_SUCCESS : OPAL_ERROR;
+    }
+
     /* lock so nobody can signal us during the list updating */
-    pthread_mutex_lock(&sync->lock);
+    WAIT_SYNC_LOCK(sync);
 
     /* Now that we hold the lock make sure another thread has not already
      * call cond_signal.
      */
     if(sync->count <= 0) {
-        pthread_mutex_unlock(&sync->lock);
+        WAIT_SYNC_UNLOCK(sync);
         return (0 == sync->status) ? OPAL_SUCCESS : OPAL_ERROR;
     }
 
@@ -65,8 +153,15 @@ int ompi_sync_wait_mt(ompi_wait_sync_t *sync)
      *  - our sync has been triggered.
      */
  check_status:
-    if( sync != wait_sync_list && num_thread_in_progress >= opal_max_thread_in_progress) {
-        pthread_cond_wait(&sync->condition, &sync->lock);
+#if OPAL_WAIT_SYNC_HAVE_FUTEX
+    /* Clear any stale wakeup before looking at the state. A completion or
+     * a promotion happening after this point will prevent the sleep. */
+    sync->wakeup = 0;
+    opal_atomic_mb();
+#endif
+    if( sync->count > 0 && sync != wait_sync_list &&
+        num_thread_in_progress >= opal_max_thread_in_progress) {
+        WAIT_SYNC_SLEEP(sync);
 
         /**
          * At this point either the sync was completed in which case
@@ -75,13 +170,13 @@ int ompi_sync_wait_mt(ompi_wait_sync_t *sync)
          */
 
         if( sync->count <= 0 ) {  /* Completed? */
-            pthread_mutex_unlock(&sync->lock);
+            WAIT_SYNC_UNLOCK(sync);
             goto i_am_done;
         }
         /* either promoted, or spurious wakeup ! */
         goto check_status;
     }
-    pthread_mutex_unlock(&sync->lock);
+    WAIT_SYNC_UNLOCK(sync);
 
     OPAL_THREAD_ADD_FETCH32(&num_thread_in_progress, 1);
     while(sync->count > 0) {  /* progress till completion */
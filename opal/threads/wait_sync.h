@@ -23,15 +23,38 @@
 #include "opal/threads/condition.h"
 #include <pthread.h>
 
+#if defined(HAVE_LINUX_FUTEX_H) && defined(HAVE_SYS_SYSCALL_H)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define OPAL_WAIT_SYNC_HAVE_FUTEX 1
+#else
+#define OPAL_WAIT_SYNC_HAVE_FUTEX 0
+#endif
+
 BEGIN_C_DECLS
 
 extern int opal_max_thread_in_progress;
 
+/* Upper bound on the number of times a thread that is not responsible
+ * for the progress polls its synchronization object before going to
+ * sleep. The actual spin budget adapts to the recently observed
+ * completion latency. */
+extern int opal_wait_sync_spin_max;
+/* Number of sched_yield() calls attempted after spinning and before
+ * going to sleep. */
+extern int opal_wait_sync_yield_count;
+
 typedef struct ompi_wait_sync_t {
     opal_atomic_int32_t count;
     int32_t status;
+#if OPAL_WAIT_SYNC_HAVE_FUTEX
+    /* 0: nothing pending, 1: woken up, 2: a thread sleeps on the futex */
+    opal_atomic_int32_t wakeup;
+#else
     pthread_cond_t condition;
     pthread_mutex_t lock;
+#endif
     struct ompi_wait_sync_t *next;
     struct ompi_wait_sync_t *prev;
     volatile bool signaling;
@@ -42,6 +65,38 @@ typedef struct ompi_wait_sync_t {
 
 #define SYNC_WAIT(sync)                 (opal_using_threads() ? ompi_sync_wait_mt (sync) : sync_wait_st (sync))
 
+#if OPAL_WAIT_SYNC_HAVE_FUTEX
+
+/* Wake up the thread sleeping on the sync (if any). The system call is
+ * only issued when the owner of the sync actually went to sleep, so the
+ * common case where the owner is progressing or spinning is a single
+ * atomic swap. */
+#define WAIT_SYNC_WAKEUP(sync)                                          \
+    do {                                                                \
+        if (2 == opal_atomic_swap_32(&(sync)->wakeup, 1)) {             \
+            (void) syscall(SYS_futex, &(sync)->wakeup, FUTEX_WAKE_PRIVATE, \
+                           1, NULL, NULL, 0);                           \
+        }                                                               \
+    } while (0)
+
+/* See the comment on the pthread version below. */
+#define WAIT_SYNC_RELEASE(sync)                       \
+    if (opal_using_threads()) {                       \
+        while ((sync)->signaling) {                   \
+            continue;                                 \
+        }                                             \
+    }
+
+#define WAIT_SYNC_RELEASE_NOWAIT(sync)
+
+#define WAIT_SYNC_SIGNAL(sync)                        \
+    if (opal_using_threads()) {                       \
+        WAIT_SYNC_WAKEUP(sync);                       \
+        sync->signaling = false;                      \
+    }
+
+#else
+
 /* The loop in release handles a race condition between the signaling
  * thread and the destruction of the condition variable. The signaling
  * member will be set to false after the final signaling thread has
@@ -74,6 +129,8 @@ typedef struct ompi_wait_sync_t {
         sync->signaling = false;                      \
     }
 
+#endif  /* OPAL_WAIT_SYNC_HAVE_FUTEX */
+
 #define WAIT_SYNC_SIGNALLED(sync){                    \
         (sync)->signaling = false;                    \
 }
@@ -89,6 +146,17 @@ static inline int sync_wait_st (ompi_wait_sync_t *sync)
 }
 
 
+#if OPAL_WAIT_SYNC_HAVE_FUTEX
+#define WAIT_SYNC_INIT(sync,c)                                  \
+    do {                                                        \
+        (sync)->count = (c);                                    \
+        (sync)->next = NULL;                                    \
+        (sync)->prev = NULL;                                    \
+        (sync)->status = 0;                                     \
+        (sync)->signaling = (0 != (c));                         \
+        (sync)->wakeup = 0;                                     \
+    } while(0)
+#else
 #define WAIT_SYNC_INIT(sync,c)                                  \
     do {                                                        \
         (sync)->count = (c);                                    \
@@ -101,6 +169,7 @@ static inline int sync_wait_st (ompi_wait_sync_t *sync)
             pthread_mutex_init (&(sync)->lock, NULL);           \
         }                                                       \
     } while(0)
+#endif  /* OPAL_WAIT_SYNC_HAVE_FUTEX */
 
 /**
  * Update the status of the synchronization primitive. If an error is
@@ -0,0 +1,403 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Throughput of the datatype engine.
+ *
+ * For a catalog of datatypes and a range of message sizes, measure in GB/s
+ * of packed data:
+ *  - pack:     a full pack into a contiguous buffer;
+ *  - unpack:   a full unpack from a contiguous buffer;
+ *  - position: a pack in 64KB fragments done in reverse order, each fragment
+ *              starting with opal_convertor_set_position;
+ *  - raw:      the iovec description of the buffer by opal_convertor_raw.
+ *
+ * The results are printed as CSV lines (datatype,bytes,operation,GB/s).
+ * Given the results of a previous run with -b, the program reports every
+ * measurement slower than the baseline by more than the tolerance (-t, in
+ * percent) and exits with an error if there is any.
+ *
+ * Usage: ddt_benchmark [-q] [-o results.csv] [-b baseline.csv] [-t tolerance]
+ */
+
+#include "ompi_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ompi/datatype/ompi_datatype.h"
+#include "opal/runtime/opal.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype_internal.h"
+
+#define FRAGMENT    (64 * 1024)
+#define MAX_IOVEC   128
+#define MAX_RESULTS 1024
+
+typedef struct {
+    char   name[32];
+    size_t bytes;
+    char   op[16];
+    double gbps;
+} result_t;
+
+static result_t results[MAX_RESULTS];
+static int nresults = 0;
+static double min_time = 0.2;  /* seconds spent on each measurement */
+
+static double wtime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+ * The datatypes of the catalog, built for about bytes of data in count
+ * instances.
+ */
+static ompi_datatype_t* create_contiguous(size_t bytes, int* count)
+{
+    ompi_datatype_t* ddt;
+    ompi_datatype_create_contiguous(256, &ompi_mpi_double.dt, &ddt);
+    *count = (int)(bytes / (256 * sizeof(double))) + 1;
+    return ddt;
+}
+
+static ompi_datatype_t* create_vector(size_t bytes, int* count)
+{
+    ompi_datatype_t* ddt;
+    /* blocks of 4 doubles every 8 doubles */
+    ompi_datatype_create_vector((int)(bytes / (4 * sizeof(double))) + 1, 4, 8, &ompi_mpi_double.dt, &ddt);
+    *count = 1;
+    return ddt;
+}
+
+static ompi_datatype_t* create_vector_small(size_t bytes, int* count)
+{
+    ompi_datatype_t* ddt;
+    /* every other double */
+    ompi_datatype_create_vector((int)(bytes / sizeof(double)) + 1, 1, 2, &ompi_mpi_double.dt, &ddt);
+    *count = 1;
+    return ddt;
+}
+
+static ompi_datatype_t* create_indexed(size_t bytes, int* count)
+{
+    int blen[32], disp[32], i, d = 0, size = 0;
+    ompi_datatype_t* ddt;
+
+    /* irregular blocks of 1 to 8 doubles with irregular gaps */
+    for( i = 0; i < 32; i++ ) {
+        blen[i] = 1 + (i * 5) % 8;
+        disp[i] = d;
+        d += blen[i] + 1 + (i * 3) % 4;
+        size += blen[i];
+    }
+    ompi_datatype_create_indexed(32, blen, disp, &ompi_mpi_double.dt, &ddt);
+    *count = (int)(bytes / (size * sizeof(double))) + 1;
+    return ddt;
+}
+
+static ompi_datatype_t* create_struct(size_t bytes, int* count)
+{
+    struct { int i; double d; char c[3]; } s;
+    ompi_datatype_t *types[3] = { &ompi_mpi_int.dt, &ompi_mpi_double.dt, &ompi_mpi_char.dt };
+    int blen[3] = { 1, 1, 3 };
+    ptrdiff_t disp[3] = { (char*)&s.i - (char*)&s, (char*)&s.d - (char*)&s, (char*)s.c - (char*)&s };
+    ompi_datatype_t *tmp, *ddt;
+
+    ompi_datatype_create_struct(3, blen, disp, types, &tmp);
+    ompi_datatype_create_resized(tmp, 0, sizeof(s), &ddt);
+    ompi_datatype_destroy(&tmp);
+    *count = (int)(bytes / (sizeof(int) + sizeof(double) + 3)) + 1;
+    return ddt;
+}
+
+static ompi_datatype_t* create_subarray(size_t bytes, int* count)
+{
+    int sizes[3], subsizes[3], starts[3] = { 1, 1, 1 }, n = 2;
+    ompi_datatype_t* ddt;
+
+    /* the interior of a cube, of about bytes */
+    while( (size_t)(n * n * n) * sizeof(double) < bytes ) n++;
+    sizes[0] = sizes[1] = sizes[2] = n + 2;
+    subsizes[0] = subsizes[1] = subsizes[2] = n;
+    ompi_datatype_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, &ompi_mpi_double.dt, &ddt);
+    *count = 1;
+    return ddt;
+}
+
+static ompi_datatype_t* create_darray(size_t bytes, int* count)
+{
+    int gsizes[2], distribs[2] = { MPI_DISTRIBUTE_CYCLIC, MPI_DISTRIBUTE_BLOCK };
+    int dargs[2] = { 4, MPI_DISTRIBUTE_DFLT_DARG }, psizes[2] = { 2, 2 }, n = 4;
+    ompi_datatype_t* ddt;
+
+    /* the part of rank 0 in a 2x2 block-cyclic distribution */
+    while( (size_t)(n * n / 4) * sizeof(double) < bytes ) n += 4;
+    gsizes[0] = gsizes[1] = n;
+    ompi_datatype_create_darray(4, 0, 2, gsizes, distribs, dargs, psizes, MPI_ORDER_C,
+                                &ompi_mpi_double.dt, &ddt);
+    *count = 1;
+    return ddt;
+}
+
+static ompi_datatype_t* create_resized_gaps(size_t bytes, int* count)
+{
+    ompi_datatype_t *tmp, *ddt;
+
+    /* 3 doubles out of 4 */
+    ompi_datatype_create_contiguous(3, &ompi_mpi_double.dt, &tmp);
+    ompi_datatype_create_resized(tmp, 0, 4 * sizeof(double), &ddt);
+    ompi_datatype_destroy(&tmp);
+    *count = (int)(bytes / (3 * sizeof(double))) + 1;
+    return ddt;
+}
+
+static const struct {
+    const char* name;
+    ompi_datatype_t* (*create)(size_t bytes, int* count);
+} catalog[] = {
+    { "contiguous",   create_contiguous },
+    { "vector",       create_vector },
+    { "vector_small", create_vector_small },
+    { "indexed",      create_indexed },
+    { "struct",       create_struct },
+    { "subarray",     create_subarray },
+    { "darray",       create_darray },
+    { "resized_gaps", create_resized_gaps },
+};
+
+/*
+ * The operations, each returning the number of packed bytes processed.
+ */
+static size_t do_pack(const opal_datatype_t* pData, int count, void* user, void* packed, size_t length)
+{
+    opal_convertor_t* pConv = opal_convertor_create(opal_local_arch, 0);
+    struct iovec iov = { .iov_base = packed, .iov_len = length };
+    uint32_t iov_count = 1;
+    size_t max_data = length;
+
+    opal_convertor_prepare_for_send(pConv, pData, count, user);
+    opal_convertor_pack(pConv, &iov, &iov_count, &max_data);
+    OBJ_RELEASE(pConv);
+    return max_data;
+}
+
+static size_t do_unpack(const opal_datatype_t* pData, int count, void* user, void* packed, size_t length)
+{
+    opal_convertor_t* pConv = opal_convertor_create(opal_local_arch, 0);
+    struct iovec iov = { .iov_base = packed, .iov_len = length };
+    uint32_t iov_count = 1;
+    size_t max_data = length;
+
+    opal_convertor_prepare_for_recv(pConv, pData, count, user);
+    opal_convertor_unpack(pConv, &iov, &iov_count, &max_data);
+    OBJ_RELEASE(pConv);
+    return max_data;
+}
+
+static size_t do_position(const opal_datatype_t* pData, int count, void* user, void* packed, size_t length)
+{
+    opal_convertor_t* pConv = opal_convertor_create(opal_local_arch, 0);
+    size_t start, end, max_data, done = 0;
+    uint32_t iov_count;
+    struct iovec iov;
+
+    opal_convertor_prepare_for_send(pConv, pData, count, user);
+    /* take the fragments in reverse order. the convertor may move a position back
+     * to an element boundary, so each fragment ends where the next one actually
+     * started to keep them adjacent. */
+    for( end = length; end > 0; end = start ) {
+        start = (end > FRAGMENT) ? end - FRAGMENT : 0;
+        opal_convertor_set_position(pConv, &start);
+        iov.iov_base = (char*)packed + start;
+        iov.iov_len = max_data = end - start;
+        iov_count = 1;
+        opal_convertor_pack(pConv, &iov, &iov_count, &max_data);
+        done += max_data;
+    }
+    OBJ_RELEASE(pConv);
+    return done;
+}
+
+static size_t do_raw(const opal_datatype_t* pData, int count, void* user, void* packed, size_t length)
+{
+    opal_convertor_t* pConv = opal_convertor_create(opal_local_arch, 0);
+    struct iovec iov[MAX_IOVEC];
+    uint32_t iov_count;
+    size_t max_data, done = 0;
+    int rc;
+
+    (void)packed; (void)length;
+    opal_convertor_prepare_for_send(pConv, pData, count, user);
+    do {
+        iov_count = MAX_IOVEC;
+        max_data = SIZE_MAX;
+        rc = opal_convertor_raw(pConv, iov, &iov_count, &max_data);
+        done += max_data;
+    } while( (0 == rc) && (0 != max_data) );
+    OBJ_RELEASE(pConv);
+    return done;
+}
+
+static const struct {
+    const char* name;
+    size_t (*run)(const opal_datatype_t*, int, void*, void*, size_t);
+} operations[] = {
+    { "pack",     do_pack },
+    { "unpack",   do_unpack },
+    { "position", do_position },
+    { "raw",      do_raw },
+};
+
+static int record(FILE* out, const char* name, size_t bytes, const char* op, double gbps)
+{
+    if( nresults < MAX_RESULTS ) {
+        result_t* r = &results[nresults++];
+        snprintf(r->name, sizeof(r->name), "%s", name);
+        snprintf(r->op, sizeof(r->op), "%s", op);
+        r->bytes = bytes;
+        r->gbps = gbps;
+    }
+    return fprintf(out, "%s,%lu,%s,%.3f\n", name, (unsigned long)bytes, op, gbps);
+}
+
+static int benchmark(FILE* out, const char* name, ompi_datatype_t* ddt, int count)
+{
+    ptrdiff_t lb, extent, true_lb, true_extent;
+    size_t length, span, processed;
+    char *buffer, *packed;
+    double t, best;
+    int errors = 0;
+
+    ompi_datatype_commit(&ddt);
+    ompi_datatype_get_extent(ddt, &lb, &extent);
+    ompi_datatype_get_true_extent(ddt, &true_lb, &true_extent);
+    length = ddt->super.size * count;
+    span = (size_t)(count - 1) * extent + true_extent;
+    buffer = (char*)malloc(span);
+    packed = (char*)malloc(length);
+    for( size_t i = 0; i < span; i++ ) buffer[i] = (char)i;
+
+    for( size_t o = 0; o < sizeof(operations) / sizeof(operations[0]); o++ ) {
+        double total = 0.0;
+        int iters = 0;
+
+        best = 0.0;
+        do {
+            t = wtime();
+            processed = operations[o].run(&ddt->super, count, buffer - true_lb, packed, length);
+            t = wtime() - t;
+            if( processed != length ) {
+                fprintf(stderr, "%s %s: processed %lu bytes out of %lu\n", name, operations[o].name,
+                        (unsigned long)processed, (unsigned long)length);
+                errors++;
+                break;
+            }
+            if( (t > 0.0) && ((length / t) > best) ) best = length / t;
+            total += t;
+            iters++;
+        } while( (total < min_time) || (iters < 3) );
+        record(out, name, length, operations[o].name, best * 1e-9);
+    }
+
+    free(buffer);
+    free(packed);
+    ompi_datatype_destroy(&ddt);
+    return errors;
+}
+
+/*
+ * Compare the results with a baseline, report the measurements slower than
+ * the baseline by more than tolerance percents.
+ */
+static int compare(const char* filename, double tolerance)
+{
+    FILE* f = fopen(filename, "r");
+    char line[256], name[32], op[16];
+    unsigned long bytes;
+    double gbps;
+    int regressions = 0;
+
+    if( NULL == f ) {
+        fprintf(stderr, "cannot open the baseline %s\n", filename);
+        return 1;
+    }
+    while( NULL != fgets(line, sizeof(line), f) ) {
+        char* c;
+        for( c = line; *c; c++ ) if( ',' == *c ) *c = ' ';
+        if( 4 != sscanf(line, "%31s %lu %15s %lf", name, &bytes, op, &gbps) ) {
+            continue;  /* header or garbage */
+        }
+        for( int i = 0; i < nresults; i++ ) {
+            if( strcmp(results[i].name, name) || strcmp(results[i].op, op) || (results[i].bytes != bytes) ) {
+                continue;
+            }
+            if( results[i].gbps < gbps * (1.0 - tolerance / 100.0) ) {
+                fprintf(stderr, "REGRESSION %s %lu %s: %.3f GB/s, baseline %.3f GB/s\n",
+                        name, bytes, op, results[i].gbps, gbps);
+                regressions++;
+            }
+        }
+    }
+    fclose(f);
+    return regressions;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t sizes[] = { 4 * 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+    const char *output = NULL, *baseline = NULL;
+    double tolerance = 10.0;
+    FILE* out = stdout;
+    int errors = 0, opt;
+
+    while( -1 != (opt = getopt(argc, argv, "qo:b:t:")) ) {
+        switch( opt ) {
+        case 'q': min_time = 0.01; break;
+        case 'o': output = optarg; break;
+        case 'b': baseline = optarg; break;
+        case 't': tolerance = atof(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-q] [-o results.csv] [-b baseline.csv] [-t tolerance]\n", argv[0]);
+            return 1;
+        }
+    }
+    if( (NULL != output) && (NULL == (out = fopen(output, "w"))) ) {
+        fprintf(stderr, "cannot open %s\n", output);
+        return 1;
+    }
+
+    opal_init_util(&argc, &argv);
+    ompi_datatype_init();
+
+    fprintf(out, "datatype,bytes,operation,GB/s\n");
+    for( size_t d = 0; d < sizeof(catalog) / sizeof(catalog[0]); d++ ) {
+        for( size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++ ) {
+            int count;
+            ompi_datatype_t* ddt = catalog[d].create(sizes[s], &count);
+            errors += benchmark(out, catalog[d].name, ddt, count);
+        }
+        fflush(out);
+    }
+    if( stdout != out ) fclose(out);
+
+    if( NULL != baseline ) {
+        errors += compare(baseline, tolerance);
+    }
+
+    ompi_datatype_finalize();
+    opal_finalize_util();
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Check the byte swapping done when packing and unpacking for a peer with a
+ * different endianness (as for external32), and report the throughput of the
+ * conversion for the predefined types of each size, for contiguous and
+ * strided layouts. Run in a loop with different instruction sets to compare.
+ */
+
+#include "opal_config.h"
+#include "opal/runtime/opal.h"
+#include "opal/datatype/opal_datatype.h"
+#include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/util/arch.h"
+#include <stdlib.h>
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+
+#define LENGTH (16 * 1024 * 1024)
+
+static double wtime(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec * 1e-6;
+}
+
+/* pack or unpack count elements, return the throughput in GB/s (or -1 on error) */
+static double convert(const opal_datatype_t* pData, size_t count, unsigned char* user,
+                      unsigned char* packed, int send)
+{
+    uint32_t remote_arch = opal_local_arch ^ OPAL_ARCH_ISBIGENDIAN;
+    size_t length = count * pData->size, max_data;
+    int iters = (int)((256 * 1024 * 1024) / length) + 1;
+    opal_convertor_t* pConv;
+    struct iovec iov;
+    uint32_t iov_count;
+    double t = 0.0;
+
+    for( int i = 0; i < iters; i++ ) {
+        pConv = opal_convertor_create( remote_arch, 0 );
+        /* convert on the sender side as well, like external32 */
+        pConv->flags |= CONVERTOR_SEND_CONVERSION;
+        if( send ) {
+            opal_convertor_prepare_for_send( pConv, pData, count, user );
+        } else {
+            opal_convertor_prepare_for_recv( pConv, pData, count, user );
+        }
+        iov.iov_base = packed;
+        iov.iov_len = max_data = length;
+        iov_count = 1;
+        t -= wtime();
+        if( send ) {
+            opal_convertor_pack( pConv, &iov, &iov_count, &max_data );
+        } else {
+            opal_convertor_unpack( pConv, &iov, &iov_count, &max_data );
+        }
+        t += wtime();
+        OBJ_RELEASE( pConv );
+        if( max_data != length ) {
+            return -1.0;
+        }
+    }
+    return ((double)length * iters) / (t * 1e9);
+}
+
+static int test_type(const char* name, const opal_datatype_t* type, size_t elem_size)
+{
+    unsigned char *user, *packed, *check;
+    opal_datatype_t* vector;
+    size_t count = LENGTH / elem_size, i, j;
+    double bw[4];
+    int errors = 0;
+
+    user = (unsigned char*)malloc(2 * LENGTH);
+    packed = (unsigned char*)malloc(LENGTH);
+    check = (unsigned char*)malloc(2 * LENGTH);
+    for( i = 0; i < 2 * LENGTH; i++ ) user[i] = (unsigned char)(i * 13 + 7);
+
+    /* every other element */
+    vector = opal_datatype_create( 4 );
+    opal_datatype_add( vector, type, count, 0, 2 * elem_size );
+    opal_datatype_commit( vector );
+
+    bw[0] = convert(type, count, user, packed, 1);
+    for( i = 0; i < count; i++ ) {
+        for( j = 0; j < elem_size; j++ ) {
+            if( packed[i * elem_size + j] != user[i * elem_size + elem_size - 1 - j] ) {
+                errors++;
+                i = count;
+                break;
+            }
+        }
+    }
+    bw[1] = convert(type, count, check, packed, 0);
+    if( memcmp(check, user, LENGTH) ) errors++;
+
+    bw[2] = convert(vector, 1, user, packed, 1);
+    memset(check, 0, 2 * LENGTH);
+    bw[3] = convert(vector, 1, check, packed, 0);
+    for( i = 0; i < count; i++ ) {
+        if( memcmp(check + 2 * i * elem_size, user + 2 * i * elem_size, elem_size) ) {
+            errors++;
+            break;
+        }
+    }
+
+    /* a conversion that did not move all the data */
+    for( i = 0; i < 4; i++ ) {
+        if( bw[i] < 0.0 ) errors++;
+    }
+
+    printf("%-12s %4lu %10.2f %10.2f %10.2f %10.2f%s\n", name, (unsigned long)elem_size,
+           bw[0], bw[1], bw[2], bw[3], errors ? "  FAILED" : "");
+
+    OBJ_RELEASE(vector);
+    free(user); free(packed); free(check);
+    return errors;
+}
+
+int main( int argc, char* argv[] )
+{
+    int errors = 0;
+
+    opal_init_util(&argc, &argv);
+
+    printf("%-12s %4s %10s %10s %10s %10s  (GB/s)\n", "type", "size", "pack", "unpack",
+           "pack vec", "unpack vec");
+    errors += test_type("int2", &opal_datatype_int2, 2);
+    errors += test_type("int4", &opal_datatype_int4, 4);
+    errors += test_type("int8", &opal_datatype_int8, 8);
+    errors += test_type("float8", &opal_datatype_float8, 8);
+    errors += test_type("float16", &opal_datatype_float16, 16);
+
+    opal_finalize_util();
+    return errors ? 1 : 0;
+}
@@ -490,6 +490,233 @@ static int local_copy_with_convertor( opal_datatype_t const * const pdt, int cou
     return (0 == errors ? OPAL_SUCCESS : errors);
 }
 
+/**
+ * Pack and unpack count times pdt in a single call, once sequentially and
+ * once split between nthreads helper threads, and check that both produce
+ * the same packed buffer and the same user buffer.
+ */
+static int local_copy_parallel( opal_datatype_t const * const pdt, int count, int nthreads )
+{
+    int saved_threads = opal_ddt_pack_threads;
+    size_t saved_min_size = opal_ddt_pack_threads_min_size;
+    char *osrc, *odst[2] = { NULL, NULL }, *packed[2] = { NULL, NULL };
+    size_t malloced_size, length, max_data;
+    opal_convertor_t *convertor;
+    ptrdiff_t lb, extent;
+    struct iovec iov;
+    uint32_t iov_count;
+    int errors = 0;
+
+    malloced_size = compute_memory_size(pdt, count);
+    opal_datatype_type_size( pdt, &length );
+    length *= count;
+    opal_datatype_get_extent( pdt, &lb, &extent );
+
+    osrc = (char*)malloc( malloced_size );
+    for( size_t i = 0; i < malloced_size; osrc[i] = i % 128 + 32, i++ );
+
+    for( int i = 0; i < 2; i++ ) {
+        opal_ddt_pack_threads = (0 == i) ? 0 : nthreads;
+        opal_ddt_pack_threads_min_size = 64 * 1024;
+
+        odst[i] = (char*)calloc( 1, malloced_size );
+        packed[i] = (char*)malloc( length );
+
+        convertor = opal_convertor_create( remote_arch, 0 );
+        opal_convertor_prepare_for_send( convertor, pdt, count, osrc - lb );
+        iov.iov_base = packed[i];
+        iov.iov_len = max_data = length;
+        iov_count = 1;
+        if( 1 != opal_convertor_pack( convertor, &iov, &iov_count, &max_data ) || length != max_data ) {
+            printf( "%s pack stopped after %lu bytes out of %lu\n", (0 == i) ? "sequential" : "parallel",
+                    (unsigned long)max_data, (unsigned long)length );
+            errors++;
+        }
+        OBJ_RELEASE( convertor ); assert( convertor == NULL );
+
+        convertor = opal_convertor_create( remote_arch, 0 );
+        opal_convertor_prepare_for_recv( convertor, pdt, count, odst[i] - lb );
+        iov.iov_base = packed[i];
+        iov.iov_len = max_data = length;
+        iov_count = 1;
+        if( 1 != opal_convertor_unpack( convertor, &iov, &iov_count, &max_data ) || length != max_data ) {
+            printf( "%s unpack stopped after %lu bytes out of %lu\n", (0 == i) ? "sequential" : "parallel",
+                    (unsigned long)max_data, (unsigned long)length );
+            errors++;
+        }
+        OBJ_RELEASE( convertor ); assert( convertor == NULL );
+    }
+    opal_ddt_pack_threads = saved_threads;
+    opal_ddt_pack_threads_min_size = saved_min_size;
+
+    if( 0 != memcmp( packed[0], packed[1], length ) ) {
+        printf( "the parallel pack differs from the sequential one\n" );
+        errors++;
+    }
+    if( 0 != memcmp( odst[0], odst[1], malloced_size ) ) {
+        printf( "the parallel unpack differs from the sequential one\n" );
+        errors++;
+    }
+    if( 0 == errors ) {
+        printf( "parallel pack and unpack with %d threads match the sequential ones\n", nthreads );
+    } else {
+        printf( "Found %d errors. Giving up!\n", errors );
+        exit(-1);
+    }
+
+    for( int i = 0; i < 2; i++ ) {
+        free( odst[i] );
+        free( packed[i] );
+    }
+    free( osrc );
+    return OPAL_SUCCESS;
+}
+
+/**
+ * Pack count times the datatype in chunk sized pieces, starting at position.
+ * Returns the position the convertor actually started from.
+ */
+static size_t pack_in_chunks( opal_datatype_t const * const pdt, int count, char* src,
+                              char* packed, size_t position, int chunk )
+{
+    opal_convertor_t *convertor;
+    struct iovec iov;
+    uint32_t iov_count;
+    size_t max_data, done;
+    int rc = 0;
+
+    convertor = opal_convertor_create( remote_arch, 0 );
+    opal_convertor_prepare_for_send( convertor, pdt, count, src );
+    opal_convertor_set_position( convertor, &position );
+    for( done = position; 1 != rc; done += max_data ) {
+        iov.iov_base = packed + done;
+        iov.iov_len = max_data = chunk;
+        iov_count = 1;
+        rc = opal_convertor_pack( convertor, &iov, &iov_count, &max_data );
+    }
+    OBJ_RELEASE( convertor ); assert( convertor == NULL );
+    return position;
+}
+
+static void unpack_in_chunks( opal_datatype_t const * const pdt, int count, char* dst,
+                              char* packed, int chunk )
+{
+    opal_convertor_t *convertor;
+    struct iovec iov;
+    uint32_t iov_count;
+    size_t max_data, done;
+    int rc = 0;
+
+    convertor = opal_convertor_create( remote_arch, 0 );
+    opal_convertor_prepare_for_recv( convertor, pdt, count, dst );
+    for( done = 0; 1 != rc; done += max_data ) {
+        iov.iov_base = packed + done;
+        iov.iov_len = max_data = chunk;
+        iov_count = 1;
+        rc = opal_convertor_unpack( convertor, &iov, &iov_count, &max_data );
+    }
+    OBJ_RELEASE( convertor ); assert( convertor == NULL );
+}
+
+/**
+ * Build the same datatype with and without the specialized pack/unpack
+ * kernels, and check that both pack (from the start and from the middle of
+ * the data) and unpack exactly the same bytes.
+ */
+static int local_copy_kernel( opal_datatype_t* (*create)(void), int32_t kernel_type,
+                              int count, int chunk )
+{
+    opal_datatype_t *pdt[2];
+    char *osrc, *odst[2], *packed[2], *tail;
+    size_t malloced_size, length, position;
+    ptrdiff_t lb, extent;
+    int errors = 0;
+
+    opal_ddt_kernels = true;
+    pdt[0] = create();
+    opal_ddt_kernels = false;
+    pdt[1] = create();
+    opal_ddt_kernels = true;
+    if( (NULL == pdt[0]->kernel) || (kernel_type != pdt[0]->kernel->type) || (NULL != pdt[1]->kernel) ) {
+        printf( "the datatype did not get the expected pack/unpack kernel\n" );
+        opal_datatype_dump( pdt[0] );
+        exit(-1);
+    }
+
+    malloced_size = compute_memory_size(pdt[0], count);
+    opal_datatype_type_size( pdt[0], &length );
+    length *= count;
+    opal_datatype_get_extent( pdt[0], &lb, &extent );
+
+    osrc = (char*)malloc( malloced_size );
+    for( size_t i = 0; i < malloced_size; osrc[i] = i % 128 + 32, i++ );
+    tail = (char*)malloc( length + chunk );
+
+    for( int i = 0; i < 2; i++ ) {
+        packed[i] = (char*)malloc( length + chunk );
+        odst[i] = (char*)calloc( 1, malloced_size );
+        pack_in_chunks( pdt[i], count, osrc - lb, packed[i], 0, chunk );
+        unpack_in_chunks( pdt[i], count, odst[i] - lb, packed[i], chunk );
+    }
+
+    if( 0 != memcmp( packed[0], packed[1], length ) ) {
+        printf( "the kernel pack differs from the generic one\n" );
+        errors++;
+    }
+    if( 0 != memcmp( odst[0], odst[1], malloced_size ) ) {
+        printf( "the kernel unpack differs from the generic one\n" );
+        errors++;
+    }
+    position = pack_in_chunks( pdt[0], count, osrc - lb, tail, length / 2 + 3, chunk );
+    if( 0 != memcmp( tail + position, packed[1] + position, length - position ) ) {
+        printf( "the kernel pack from position %lu differs from the generic one\n", (unsigned long)position );
+        errors++;
+    }
+    if( 0 == errors ) {
+        printf( "kernel pack and unpack in chunks of %d bytes match the generic engine\n", chunk );
+    } else {
+        printf( "Found %d errors. Giving up!\n", errors );
+        exit(-1);
+    }
+
+    for( int i = 0; i < 2; i++ ) {
+        free( odst[i] );
+        free( packed[i] );
+        OBJ_RELEASE( pdt[i] ); assert( pdt[i] == NULL );
+    }
+    free( tail );
+    free( osrc );
+    return OPAL_SUCCESS;
+}
+
+static opal_datatype_t* create_kernel_vector( void )
+{
+    return create_vector_type( &opal_datatype_float8, 100, 3, 7 );
+}
+
+static opal_datatype_t* create_kernel_subarray( void )
+{
+    opal_datatype_t *row, *pdt;
+
+    row = create_vector_type( &opal_datatype_float4, 8, 2, 5 );
+    pdt = create_vector_type( row, 6, 1, 2 );
+    OBJ_RELEASE( row ); assert( row == NULL );
+    return pdt;
+}
+
+static opal_datatype_t* create_kernel_indexed_block( void )
+{
+    static const ptrdiff_t disps[] = { 0, 20, 48, 100, 132, 180 };
+    opal_datatype_t *pdt;
+
+    pdt = opal_datatype_create( 6 );
+    for( int i = 0; i < 6; i++ ) {
+        opal_datatype_add( pdt, &opal_datatype_int4, 3, disps[i], -1 );
+    }
+    opal_datatype_commit( pdt );
+    return pdt;
+}
+
 /**
  * Main function. Call several tests and print-out the results. It try to stress the convertor
  * using difficult data-type constructions as well as strange segment sizes for the conversion.
@@ -652,6 +879,34 @@ int main( int argc, char* argv[] )
     printf( ">>--------------------------------------------<<\n" );
     OBJ_RELEASE( pdt ); assert( pdt == NULL );
 
+    printf( ">>--------------------------------------------<<\n" );
+    printf( "Vector of vectors of pairs of doubles (50 rows of 100 pairs)\n" );
+    /* the rows are regular and collapse into a single strided element, only
+     * the loop over the rows should remain in the optimized description */
+    pdt1 = opal_datatype_create( 2 );
+    opal_datatype_add( pdt1, &opal_datatype_float8, 1, 0, -1 );
+    opal_datatype_add( pdt1, &opal_datatype_float8, 1, 2 * sizeof(double), -1 );
+    opal_datatype_resize( pdt1, 0, 4 * sizeof(double) );
+    opal_datatype_commit( pdt1 );
+    pdt2 = create_vector_type( pdt1, 100, 1, 1 );
+    pdt = create_vector_type( pdt2, 50, 1, 2 );
+    opal_datatype_dump( pdt );
+    if( pdt->opt_desc.used > 3 ) {
+        printf( "the optimized description has %u elements instead of 3\n", pdt->opt_desc.used );
+        exit(-1);
+    }
+    if( outputFlags & CHECK_PACK_UNPACK ) {
+        local_copy_ddt_count(pdt, 1);
+        local_copy_with_convertor( pdt, 1, 12 );
+        local_copy_with_convertor_2datatypes( pdt, 1, pdt, 1, 12 );
+        local_copy_with_convertor( pdt, 1, 6000 );
+        local_copy_with_convertor_2datatypes( pdt, 1, pdt, 1, 6000 );
+    }
+    printf( ">>--------------------------------------------<<\n" );
+    OBJ_RELEASE( pdt ); assert( pdt == NULL );
+    OBJ_RELEASE( pdt2 ); assert( pdt2 == NULL );
+    OBJ_RELEASE( pdt1 ); assert( pdt1 == NULL );
+
     printf( ">>--------------------------------------------<<\n" );
     printf( "Struct data-type resized (double unused followed by 2 used doubles)\n" );
     pdt = create_struct_constant_gap_resized_ddt( &opal_datatype_float8 );
@@ -715,6 +970,44 @@ int main( int argc, char* argv[] )
     OBJ_RELEASE( pdt1 ); assert( pdt1 == NULL );
     OBJ_RELEASE( pdt2 ); assert( pdt2 == NULL );
 
+    printf( ">>--------------------------------------------<<\n" );
+    printf( "Interned datatypes (the same vector committed three times)\n" );
+    opal_ddt_intern = true;
+    pdt1 = create_vector_type( &opal_datatype_float8, 450, 10, 11 );
+    pdt2 = create_vector_type( &opal_datatype_float8, 450, 10, 11 );
+    pdt3 = create_vector_type( &opal_datatype_float8, 450, 10, 12 );
+    if( (pdt1->opt_desc.desc != pdt2->opt_desc.desc) || (pdt1->opt_desc.desc == pdt3->opt_desc.desc) ) {
+        printf( "the optimized descriptions are not shared as expected\n" );
+        exit(-1);
+    }
+    /* the description must outlive the first datatype */
+    OBJ_RELEASE( pdt1 ); assert( pdt1 == NULL );
+    if( outputFlags & CHECK_PACK_UNPACK ) {
+        local_copy_ddt_count(pdt2, 1);
+        local_copy_with_convertor( pdt2, 1, 6000 );
+        local_copy_with_convertor_2datatypes( pdt2, 1, pdt2, 1, 6000 );
+    }
+    opal_ddt_intern = false;
+    printf( ">>--------------------------------------------<<\n" );
+    OBJ_RELEASE( pdt2 ); assert( pdt2 == NULL );
+    OBJ_RELEASE( pdt3 ); assert( pdt3 == NULL );
+
+    printf( ">>--------------------------------------------<<\n" );
+    printf( "Pack/unpack kernels for strided and indexed block datatypes\n" );
+    local_copy_kernel( create_kernel_vector, OPAL_DATATYPE_KERNEL_STRIDED, 10, 100 );
+    local_copy_kernel( create_kernel_vector, OPAL_DATATYPE_KERNEL_STRIDED, 10, 4096 );
+    local_copy_kernel( create_kernel_subarray, OPAL_DATATYPE_KERNEL_STRIDED, 10, 77 );
+    local_copy_kernel( create_kernel_indexed_block, OPAL_DATATYPE_KERNEL_INDEXED_BLOCK, 50, 50 );
+    local_copy_kernel( create_kernel_indexed_block, OPAL_DATATYPE_KERNEL_INDEXED_BLOCK, 50, 1000 );
+    printf( ">>--------------------------------------------<<\n" );
+
+    printf( ">>--------------------------------------------<<\n" );
+    printf( "Parallel pack and unpack of a vector of doubles\n" );
+    pdt = create_vector_type( &opal_datatype_float8, 4096, 7, 11 );
+    local_copy_parallel( pdt, 4, 3 );
+    printf( ">>--------------------------------------------<<\n" );
+    OBJ_RELEASE( pdt ); assert( pdt == NULL );
+
     /* clean-ups all data allocations */
     opal_finalize_util ();
 
@@ -307,6 +307,79 @@ static int unpack_ooo(void)
     return rc;
 }
 
+/*
+ * Unpack a large message made of many instances of a nested datatype, with
+ * the fragments received in reverse order. Each fragment requires moving the
+ * convertor far away from its current position, either by walking the
+ * datatype from the beginning or using the checkpoints of the datatype.
+ */
+static double unpack_reverse(ompi_datatype_t* newtype, size_t count, char* packed,
+                             size_t length, char* buffer, size_t fragment)
+{
+    opal_convertor_t* pConv = opal_convertor_create( remote_arch, 0 );
+    clock_t start;
+    size_t offset;
+
+    opal_convertor_prepare_for_recv( pConv, &(newtype->super), count, buffer );
+    start = clock();
+    for( offset = ((length - 1) / fragment) * fragment; ; offset -= fragment ) {
+        struct iovec iov;
+        uint32_t iov_count = 1;
+        size_t max_data, position = offset;
+
+        iov.iov_base = packed + offset;
+        iov.iov_len = max_data = (length - offset) < fragment ? (length - offset) : fragment;
+        opal_convertor_set_position( pConv, &position );
+        opal_convertor_unpack( pConv, &iov, &iov_count, &max_data );
+        if( 0 == offset ) break;
+    }
+    OBJ_RELEASE( pConv );
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static int unpack_checkpoints(void)
+{
+    ompi_datatype_t *t1, *t2, *newtype;
+    size_t count = 64, length, interval = opal_ddt_checkpoint_interval;
+    ptrdiff_t lb, extent;
+    char *packed, *walk, *ckpt;
+    double twalk, tckpt;
+    int rc = 0;
+
+    ompi_datatype_create_vector(32, 3, 4, MPI_DOUBLE, &t1);
+    ompi_datatype_create_vector(16, 2, 3, t1, &t2);
+    ompi_datatype_create_vector(8, 1, 2, t2, &newtype);
+    ompi_datatype_commit(&newtype);
+    ompi_datatype_type_size(newtype, &length);
+    ompi_datatype_get_extent(newtype, &lb, &extent);
+    length *= count;
+
+    packed = (char*)malloc(length);
+    walk = (char*)calloc(count, extent);
+    ckpt = (char*)calloc(count, extent);
+    for( size_t i = 0; i < length; i++ ) packed[i] = (char)i;
+
+    /* the fragments are multiple of a double, no element is split */
+    opal_ddt_checkpoint_interval = 0;
+    twalk = unpack_reverse(newtype, count, packed, length, walk, 8192);
+    opal_ddt_checkpoint_interval = (0 == interval) ? 64 * 1024 : interval;
+    tckpt = unpack_reverse(newtype, count, packed, length, ckpt, 8192);
+    opal_ddt_checkpoint_interval = interval;
+
+    printf("reverse unpack of %lu bytes: %f s walking the datatype, %f s with checkpoints\n",
+           (unsigned long)length, twalk, tckpt);
+    if( 0 != memcmp(walk, ckpt, count * extent) ) {
+        printf("unpack with checkpoints differs from the unpack without\n");
+        rc = 1;
+    }
+
+    free(packed); free(walk); free(ckpt);
+    ompi_datatype_destroy(&t1);
+    ompi_datatype_destroy(&t2);
+    ompi_datatype_destroy(&newtype);
+    return rc;
+}
+
 int main( int argc, char* argv[] )
 {
     int rc;
@@ -320,6 +393,9 @@ int main( int argc, char* argv[] )
 
     printf( "\n\n#\n * TEST UNPACK OUT OF ORDER\n #\n\n" );
     rc = unpack_ooo();
+    if( rc == 0 ) {
+        rc = unpack_checkpoints();
+    }
     if( rc == 0 ) {
         printf( "unpack out of order [PASSED]\n" );
         return 0;
@@ -0,0 +1,152 @@
+/*
+ * Check the atomicity of concurrent accumulates to a single location.
+ *
+ * All the ranks increment the same 64 bit integer of rank 0, mixing in
+ * every iteration:
+ *
+ *   - MPI_Accumulate with MPI_SUM, from a predefined and from a derived
+ *     origin datatype,
+ *   - MPI_Fetch_and_op with MPI_SUM,
+ *   - MPI_Compare_and_swap, retried until it succeeds,
+ *
+ * and add 1.0 to a double of rank 0 with MPI_Accumulate and
+ * MPI_Fetch_and_op. Once all the ranks are done the integer must have been
+ * incremented four times and the double twice per iteration and rank. The
+ * values fetched by the integer MPI_Fetch_and_op and returned by successful
+ * compare and swaps must all be distinct.
+ *
+ * Run with and without the processor atomics of the sm component:
+ *
+ * Usage: mpirun -n 8 --mca osc sm --mca osc_sm_acc_use_amo 1 ./rma_atomics [iterations]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+static int compare (const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *) a, y = *(const int64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+int main (int argc, char *argv[])
+{
+    int iterations = 10000, rank, nprocs, errors = 0, total;
+    int64_t one = 1, old, value, compare_value, *fetched, *all_fetched = NULL;
+    double one_d = 1.0, dold;
+    MPI_Datatype contig;
+    MPI_Win win;
+    char *base;
+
+    MPI_Init (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+    if (1 < argc) {
+        iterations = atoi (argv[1]);
+    }
+
+    if (iterations < 1) {
+        if (0 == rank) {
+            fprintf (stderr, "usage: mpirun -n <nprocs> %s [iterations]\n", argv[0]);
+        }
+        MPI_Finalize ();
+        return 1;
+    }
+
+    fetched = (int64_t *) malloc (2 * iterations * sizeof (int64_t));
+    MPI_Type_contiguous (1, MPI_INT64_T, &contig);
+    MPI_Type_commit (&contig);
+
+    /* the integer at displacement 0, the double at displacement 8 */
+    MPI_Win_allocate (0 == rank ? 16 : 0, 1, MPI_INFO_NULL, MPI_COMM_WORLD, &base, &win);
+    if (0 == rank) {
+        *(int64_t *) base = 0;
+        *(double *) (base + 8) = 0.0;
+    }
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    MPI_Win_lock_all (0, win);
+    for (int i = 0 ; i < iterations ; ++i) {
+        if (i & 1) {
+            MPI_Accumulate (&one, 1, contig, 0, 0, 1, MPI_INT64_T, MPI_SUM, win);
+        } else {
+            MPI_Accumulate (&one, 1, MPI_INT64_T, 0, 0, 1, MPI_INT64_T, MPI_SUM, win);
+        }
+
+        MPI_Fetch_and_op (&one, fetched + 2 * i, MPI_INT64_T, 0, 0, MPI_SUM, win);
+
+        MPI_Fetch_and_op (NULL, &compare_value, MPI_INT64_T, 0, 0, MPI_NO_OP, win);
+        MPI_Win_flush (0, win);
+        do {
+            value = compare_value + 1;
+            MPI_Compare_and_swap (&value, &compare_value, &old, MPI_INT64_T, 0, 0, win);
+            MPI_Win_flush (0, win);
+            if (old == compare_value) {
+                break;
+            }
+            compare_value = old;
+        } while (1);
+        fetched[2 * i + 1] = old;
+
+        MPI_Accumulate (&one_d, 1, MPI_DOUBLE, 0, 8, 1, MPI_DOUBLE, MPI_SUM, win);
+        MPI_Fetch_and_op (&one_d, &dold, MPI_DOUBLE, 0, 8, MPI_SUM, win);
+        MPI_Win_flush (0, win);
+    }
+    MPI_Win_unlock_all (win);
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    if (0 == rank) {
+        int64_t expected = 4 * (int64_t) iterations * nprocs;
+        double dexpected = 2.0 * iterations * nprocs;
+
+        MPI_Win_lock (MPI_LOCK_SHARED, 0, 0, win);
+        if (*(int64_t *) base != expected) {
+            fprintf (stderr, "integer is %lld, expected %lld\n", (long long) *(int64_t *) base,
+                     (long long) expected);
+            ++errors;
+        }
+        if (*(double *) (base + 8) != dexpected) {
+            fprintf (stderr, "double is %f, expected %f\n", *(double *) (base + 8), dexpected);
+            ++errors;
+        }
+        MPI_Win_unlock (0, win);
+
+        all_fetched = (int64_t *) malloc ((size_t) nprocs * 2 * iterations * sizeof (int64_t));
+    }
+
+    /* no two increments may have seen the same value */
+    MPI_Gather (fetched, 2 * iterations, MPI_INT64_T, all_fetched, 2 * iterations, MPI_INT64_T, 0,
+                MPI_COMM_WORLD);
+    if (0 == rank) {
+        size_t n = (size_t) nprocs * 2 * iterations;
+
+        qsort (all_fetched, n, sizeof (int64_t), compare);
+        for (size_t i = 1 ; i < n ; ++i) {
+            if (all_fetched[i] == all_fetched[i - 1]) {
+                if (errors++ < 10) {
+                    fprintf (stderr, "value %lld was fetched twice\n", (long long) all_fetched[i]);
+                }
+            }
+        }
+        free (all_fetched);
+    }
+
+    MPI_Allreduce (&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf ("%s: %d iterations on %d ranks, %d errors\n", 0 == total ? "passed" : "FAILED",
+                iterations, nprocs, total);
+    }
+
+    MPI_Win_free (&win);
+    MPI_Type_free (&contig);
+    free (fetched);
+
+    MPI_Finalize ();
+
+    return 0 == total ? 0 : 1;
+}
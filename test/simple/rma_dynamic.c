@@ -0,0 +1,199 @@
+/*
+ * Check RMA to a dynamic window with thousands of attached regions.
+ *
+ * Every rank attaches count regions, one per page of a large buffer, in a
+ * shuffled order so most attachments are inserted in the middle of the
+ * region table. In each phase every rank puts a pattern to each attached
+ * region of its right neighbour, reads it back with a get, and after a
+ * barrier checks the pattern its left neighbour wrote to its own regions.
+ * Between the phases every other region is detached, again in a shuffled
+ * order, and then attached again.
+ *
+ * The default osc_rdma_max_attach is smaller than the default count:
+ *
+ * Usage: mpirun -n 2 --mca osc rdma --mca osc_rdma_max_attach 4096 ./rma_dynamic [count]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "mpi.h"
+
+#define INTS 64
+
+static int pattern (int src, int region, int i, int phase)
+{
+    return src * 1000003 + region * INTS + i + phase * 7;
+}
+
+static void shuffle (int *order, int count)
+{
+    for (int i = count - 1 ; i > 0 ; --i) {
+        int j = rand () % (i + 1), tmp = order[i];
+
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+}
+
+static int *region_ptr (char *buffer, long page_size, int region)
+{
+    return (int *) (buffer + (size_t) region * page_size);
+}
+
+static int run_phase (MPI_Win win, char *buffer, long page_size, MPI_Aint *remote, const char *attached,
+                      int count, int rank, int left, int right, int phase)
+{
+    int values[INTS], check[INTS], errors = 0;
+
+    MPI_Win_lock_all (0, win);
+    for (int region = 0 ; region < count ; ++region) {
+        if (!attached[region]) {
+            continue;
+        }
+        for (int i = 0 ; i < INTS ; ++i) {
+            values[i] = pattern (rank, region, i, phase);
+        }
+        MPI_Put (values, INTS, MPI_INT, right, remote[region], INTS, MPI_INT, win);
+        MPI_Win_flush (right, win);
+        MPI_Get (check, INTS, MPI_INT, right, remote[region], INTS, MPI_INT, win);
+        MPI_Win_flush (right, win);
+        for (int i = 0 ; i < INTS ; ++i) {
+            if (check[i] != values[i]) {
+                if (errors++ < 10) {
+                    fprintf (stderr, "%d: phase %d: get of region %d of %d returned %d at %d, expected %d\n",
+                             rank, phase, region, right, check[i], i, values[i]);
+                }
+                break;
+            }
+        }
+    }
+    MPI_Win_unlock_all (win);
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    /* the left and right neighbours attach and detach the same regions */
+    for (int region = 0 ; region < count ; ++region) {
+        int *local = region_ptr (buffer, page_size, region);
+
+        if (!attached[region]) {
+            continue;
+        }
+        for (int i = 0 ; i < INTS ; ++i) {
+            if (local[i] != pattern (left, region, i, phase)) {
+                if (errors++ < 10) {
+                    fprintf (stderr, "%d: phase %d: region %d holds %d at %d, expected %d\n", rank, phase,
+                             region, local[i], i, pattern (left, region, i, phase));
+                }
+                break;
+            }
+        }
+    }
+
+    return errors;
+}
+
+int main (int argc, char *argv[])
+{
+    int count = 2000, rank, nprocs, left, right, errors = 0, total, phase = 0;
+    long page_size = sysconf (_SC_PAGESIZE);
+    MPI_Aint *local_addresses, *remote;
+    char *memory, *buffer, *attached;
+    int *order;
+    MPI_Win win;
+
+    MPI_Init (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+    if (1 < argc) {
+        count = atoi (argv[1]);
+    }
+
+    if (count < 2 || page_size < (long) (INTS * sizeof (int))) {
+        if (0 == rank) {
+            fprintf (stderr, "usage: mpirun -n <nprocs> %s [count]\n", argv[0]);
+        }
+        MPI_Finalize ();
+        return 1;
+    }
+
+    left = (rank + nprocs - 1) % nprocs;
+    right = (rank + 1) % nprocs;
+
+    /* one region at the start of every page */
+    memory = (char *) malloc ((size_t) (count + 1) * page_size);
+    buffer = (char *) (((MPI_Aint) memory + page_size - 1) & ~((MPI_Aint) page_size - 1));
+    local_addresses = (MPI_Aint *) malloc (count * sizeof (MPI_Aint));
+    remote = (MPI_Aint *) malloc (count * sizeof (MPI_Aint));
+    attached = (char *) calloc (count, 1);
+    order = (int *) malloc (count * sizeof (int));
+
+    for (int region = 0 ; region < count ; ++region) {
+        MPI_Get_address (region_ptr (buffer, page_size, region), local_addresses + region);
+        order[region] = region;
+    }
+    /* the same order on every rank */
+    srand (count);
+
+    MPI_Win_create_dynamic (MPI_INFO_NULL, MPI_COMM_WORLD, &win);
+
+    shuffle (order, count);
+    for (int k = 0 ; k < count ; ++k) {
+        if (MPI_SUCCESS != MPI_Win_attach (win, region_ptr (buffer, page_size, order[k]), INTS * sizeof (int))) {
+            fprintf (stderr, "%d: could not attach region %d of %d\n", rank, k, count);
+            MPI_Abort (MPI_COMM_WORLD, 1);
+        }
+        attached[order[k]] = 1;
+    }
+
+    MPI_Sendrecv (local_addresses, count, MPI_AINT, left, 0, remote, count, MPI_AINT, right, 0,
+                  MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    errors += run_phase (win, buffer, page_size, remote, attached, count, rank, left, right, phase++);
+
+    /* detach every other region */
+    shuffle (order, count);
+    for (int k = 0 ; k < count ; ++k) {
+        if (order[k] & 1) {
+            MPI_Win_detach (win, region_ptr (buffer, page_size, order[k]));
+            attached[order[k]] = 0;
+        }
+    }
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    errors += run_phase (win, buffer, page_size, remote, attached, count, rank, left, right, phase++);
+
+    /* and attach them again */
+    shuffle (order, count);
+    for (int k = 0 ; k < count ; ++k) {
+        if (order[k] & 1) {
+            MPI_Win_attach (win, region_ptr (buffer, page_size, order[k]), INTS * sizeof (int));
+            attached[order[k]] = 1;
+        }
+    }
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    errors += run_phase (win, buffer, page_size, remote, attached, count, rank, left, right, phase++);
+
+    for (int region = 0 ; region < count ; ++region) {
+        MPI_Win_detach (win, region_ptr (buffer, page_size, region));
+    }
+
+    MPI_Allreduce (&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf ("%s: %d regions on %d ranks, %d errors\n", 0 == total ? "passed" : "FAILED",
+                count, nprocs, total);
+    }
+
+    MPI_Win_free (&win);
+    free (order);
+    free (attached);
+    free (remote);
+    free (local_addresses);
+    free (memory);
+
+    MPI_Finalize ();
+
+    return 0 == total ? 0 : 1;
+}
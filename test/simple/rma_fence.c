@@ -0,0 +1,93 @@
+/*
+ * Check that MPI_Win_fence separates the epochs of a long fence loop.
+ *
+ * Every window holds one int per rank. In each epoch every rank first
+ * checks that each peer's slot in its own window holds what that peer put
+ * there in the previous epoch, then puts a new value, depending on the
+ * epoch, into its slot of every other window. A fence that lets a process
+ * through early shows up as a stale or a future value.
+ *
+ * Run with more ranks than cores and a small spin count, so most waits in
+ * the fence end up sleeping in the kernel:
+ *
+ * Usage: mpirun -n 32 --oversubscribe --mca osc sm --mca osc_sm_sync_spin_count 10 \
+ *            ./rma_fence [epochs]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+static int pattern (int src, int epoch)
+{
+    return src * 65599 + epoch;
+}
+
+int main (int argc, char *argv[])
+{
+    int epochs = 1000, rank, nprocs, errors = 0, total, value;
+    int *base;
+    MPI_Win win;
+
+    MPI_Init (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+    if (1 < argc) {
+        epochs = atoi (argv[1]);
+    }
+
+    if (nprocs < 2 || epochs < 1) {
+        if (0 == rank) {
+            fprintf (stderr, "usage: mpirun -n <nprocs> %s [epochs]\n", argv[0]);
+        }
+        MPI_Finalize ();
+        return 1;
+    }
+
+    MPI_Win_allocate ((MPI_Aint) nprocs * sizeof (int), sizeof (int), MPI_INFO_NULL, MPI_COMM_WORLD,
+                      &base, &win);
+    for (int i = 0 ; i < nprocs ; ++i) {
+        base[i] = -1;
+    }
+
+    MPI_Win_fence (MPI_MODE_NOPRECEDE, win);
+    for (int epoch = 0 ; epoch < epochs ; ++epoch) {
+        if (0 < epoch) {
+            for (int src = 0 ; src < nprocs ; ++src) {
+                if (src != rank && base[src] != pattern (src, epoch - 1)) {
+                    if (errors++ < 10) {
+                        fprintf (stderr, "%d: epoch %d: slot of %d holds %d, expected %d\n", rank,
+                                 epoch, src, base[src], pattern (src, epoch - 1));
+                    }
+                }
+            }
+        }
+
+        /* the slots must not be overwritten before every rank checked them */
+        MPI_Win_fence (0, win);
+
+        value = pattern (rank, epoch);
+        for (int peer = 0 ; peer < nprocs ; ++peer) {
+            if (peer != rank) {
+                MPI_Put (&value, 1, MPI_INT, peer, rank, 1, MPI_INT, win);
+            }
+        }
+
+        MPI_Win_fence (0, win);
+    }
+    MPI_Win_fence (MPI_MODE_NOSUCCEED, win);
+
+    MPI_Allreduce (&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf ("%s: %d epochs on %d ranks, %d errors\n", 0 == total ? "passed" : "FAILED",
+                epochs, nprocs, total);
+    }
+
+    MPI_Win_free (&win);
+
+    MPI_Finalize ();
+
+    return 0 == total ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+/*
+ * Check mutual exclusion of passive target locks under contention.
+ *
+ * Every window holds a counter and a busy flag. In each iteration all the
+ * ranks target the same rank, each one with one of:
+ *
+ *   - an exclusive MPI_Win_lock, which sets the busy flag, increments the
+ *     counter with a separate get and put and clears the busy flag again,
+ *   - a shared MPI_Win_lock or an MPI_Win_lock_all, which read the busy
+ *     flag of the target and must never find it set.
+ *
+ * Any overlap between an exclusive epoch and another epoch loses an
+ * increment or shows a set busy flag. At the end every counter must equal
+ * the number of exclusive epochs at its rank.
+ *
+ * Run with several ranks per node, with the lock queue and the per-node
+ * aggregation of the global lock enabled:
+ *
+ * Usage: mpirun -n 8 --map-by ppr:4:node --mca osc rdma --mca osc_rdma_locking_mode two_level \
+ *            --mca osc_rdma_exclusive_lock_queue 1 --mca osc_rdma_aggregate_global_lock 1 \
+ *            ./rma_locks [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+#define COUNTER 0
+#define BUSY    1
+
+int main (int argc, char *argv[])
+{
+    int iterations = 2000, rank, nprocs, errors = 0, total, value, one = 1, zero = 0;
+    int *base, *increments, *expected;
+    MPI_Win win;
+
+    MPI_Init (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+    if (1 < argc) {
+        iterations = atoi (argv[1]);
+    }
+
+    if (nprocs < 2 || iterations < 1) {
+        if (0 == rank) {
+            fprintf (stderr, "usage: mpirun -n <nprocs> %s [iterations]\n", argv[0]);
+        }
+        MPI_Finalize ();
+        return 1;
+    }
+
+    increments = (int *) calloc (nprocs, sizeof (int));
+    expected = (int *) calloc (nprocs, sizeof (int));
+
+    MPI_Win_allocate (2 * sizeof (int), sizeof (int), MPI_INFO_NULL, MPI_COMM_WORLD, &base, &win);
+    MPI_Win_lock (MPI_LOCK_EXCLUSIVE, rank, 0, win);
+    base[COUNTER] = base[BUSY] = 0;
+    MPI_Win_unlock (rank, win);
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    for (int i = 0 ; i < iterations ; ++i) {
+        int target = i % nprocs;
+
+        switch ((i / nprocs + rank) % 4) {
+        case 0:
+        case 1:
+            MPI_Win_lock (MPI_LOCK_EXCLUSIVE, target, 0, win);
+            MPI_Put (&one, 1, MPI_INT, target, BUSY, 1, MPI_INT, win);
+            MPI_Get (&value, 1, MPI_INT, target, COUNTER, 1, MPI_INT, win);
+            MPI_Win_flush (target, win);
+            ++value;
+            MPI_Put (&value, 1, MPI_INT, target, COUNTER, 1, MPI_INT, win);
+            MPI_Win_flush (target, win);
+            MPI_Put (&zero, 1, MPI_INT, target, BUSY, 1, MPI_INT, win);
+            MPI_Win_unlock (target, win);
+            ++increments[target];
+            break;
+        case 2:
+            MPI_Win_lock (MPI_LOCK_SHARED, target, 0, win);
+            MPI_Get (&value, 1, MPI_INT, target, BUSY, 1, MPI_INT, win);
+            MPI_Win_unlock (target, win);
+            if (0 != value) {
+                if (errors++ < 10) {
+                    fprintf (stderr, "%d: iteration %d: shared lock of %d overlaps an exclusive lock\n",
+                             rank, i, target);
+                }
+            }
+            break;
+        default:
+            MPI_Win_lock_all (0, win);
+            MPI_Get (&value, 1, MPI_INT, target, BUSY, 1, MPI_INT, win);
+            MPI_Win_unlock_all (win);
+            if (0 != value) {
+                if (errors++ < 10) {
+                    fprintf (stderr, "%d: iteration %d: lock_all overlaps an exclusive lock of %d\n",
+                             rank, i, target);
+                }
+            }
+            break;
+        }
+    }
+
+    /* also waits for all the epochs to end */
+    MPI_Allreduce (increments, expected, nprocs, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+    MPI_Win_lock (MPI_LOCK_SHARED, rank, 0, win);
+    if (base[COUNTER] != expected[rank]) {
+        fprintf (stderr, "%d: counter is %d, expected %d\n", rank, base[COUNTER], expected[rank]);
+        ++errors;
+    }
+    MPI_Win_unlock (rank, win);
+
+    MPI_Allreduce (&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf ("%s: %d iterations on %d ranks, %d errors\n", 0 == total ? "passed" : "FAILED",
+                iterations, nprocs, total);
+    }
+
+    MPI_Win_free (&win);
+    free (expected);
+    free (increments);
+
+    MPI_Finalize ();
+
+    return 0 == total ? 0 : 1;
+}
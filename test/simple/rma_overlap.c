@@ -0,0 +1,178 @@
+/*
+ * Measure how well request-based RMA overlaps with computation.
+ *
+ * Every rank issues a number of MPI_Rget operations to its partner inside a
+ * passive target epoch and then either:
+ *
+ *   - waits for each request in turn (latency of the first and of all requests),
+ *   - computes for as long as the communication took and then waits.
+ *
+ * The overlap is the fraction of the communication time hidden behind the
+ * computation. A value close to 1 means the requests progressed while the
+ * origin was computing.
+ *
+ * Every window holds the rank of its owner in each byte, and the result of
+ * each phase is checked against the rank of the partner. A last phase frees
+ * half of the requests with MPI_Request_free while the gets are in flight
+ * and completes them with MPI_Win_flush.
+ *
+ * Usage: mpirun -n 2 ./rma_overlap [count] [size] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpi.h"
+
+static int check (const char *buffer, size_t length, int peer, int rank, const char *phase)
+{
+    for (size_t i = 0 ; i < length ; ++i) {
+        if ((char) peer != buffer[i]) {
+            fprintf (stderr, "%d: %s: byte %lu is %d, expected %d\n", rank, phase, (unsigned long) i,
+                     buffer[i], peer);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void compute (double seconds)
+{
+    double start = MPI_Wtime ();
+
+    while (MPI_Wtime () - start < seconds) {
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    int count = 128, size = 8, iterations = 100;
+    double t_first = 0.0, t_all = 0.0, t_flush = 0.0, t_overlap = 0.0, start;
+    int rank, nprocs, peer, errors = 0, total;
+    size_t length;
+    MPI_Request *reqs;
+    char *buffer, *base;
+    MPI_Win win;
+
+    MPI_Init (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+    if (1 < argc) {
+        count = atoi (argv[1]);
+    }
+    if (2 < argc) {
+        size = atoi (argv[2]);
+    }
+    if (3 < argc) {
+        iterations = atoi (argv[3]);
+    }
+
+    if (nprocs < 2 || count < 1 || size < 1 || iterations < 1) {
+        if (0 == rank) {
+            fprintf (stderr, "usage: mpirun -n <even number> %s [count] [size] [iterations]\n", argv[0]);
+        }
+        MPI_Finalize ();
+        return 1;
+    }
+
+    /* pair 0 <-> 1, 2 <-> 3, ... an odd last rank reads from itself */
+    peer = rank ^ 1;
+    if (peer >= nprocs) {
+        peer = rank;
+    }
+
+    length = (size_t) count * size;
+    reqs = (MPI_Request *) malloc (count * sizeof (reqs[0]));
+    buffer = (char *) malloc (length);
+
+    MPI_Win_allocate ((MPI_Aint) length, 1, MPI_INFO_NULL, MPI_COMM_WORLD, &base, &win);
+    memset (base, rank, length);
+
+    MPI_Win_lock_all (0, win);
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    for (int i = 0 ; i < iterations ; ++i) {
+        /* gets completed by a flush */
+        memset (buffer, ~peer, length);
+        start = MPI_Wtime ();
+        for (int j = 0 ; j < count ; ++j) {
+            MPI_Get (buffer + j * size, size, MPI_BYTE, peer, j * size, size, MPI_BYTE, win);
+        }
+        MPI_Win_flush_all (win);
+        t_flush += MPI_Wtime () - start;
+        errors += check (buffer, length, peer, rank, "get + flush_all");
+
+        /* request-based gets completed one at a time */
+        memset (buffer, ~peer, length);
+        start = MPI_Wtime ();
+        for (int j = 0 ; j < count ; ++j) {
+            MPI_Rget (buffer + j * size, size, MPI_BYTE, peer, j * size, size, MPI_BYTE, win, reqs + j);
+        }
+        MPI_Wait (reqs, MPI_STATUS_IGNORE);
+        t_first += MPI_Wtime () - start;
+        for (int j = 1 ; j < count ; ++j) {
+            MPI_Wait (reqs + j, MPI_STATUS_IGNORE);
+        }
+        t_all += MPI_Wtime () - start;
+        errors += check (buffer, length, peer, rank, "rget + wait");
+    }
+
+    /* computation for as long as the request-based gets took */
+    for (int i = 0 ; i < iterations ; ++i) {
+        memset (buffer, ~peer, length);
+        start = MPI_Wtime ();
+        for (int j = 0 ; j < count ; ++j) {
+            MPI_Rget (buffer + j * size, size, MPI_BYTE, peer, j * size, size, MPI_BYTE, win, reqs + j);
+        }
+        compute (t_all / iterations);
+        MPI_Waitall (count, reqs, MPI_STATUSES_IGNORE);
+        t_overlap += MPI_Wtime () - start;
+        errors += check (buffer, length, peer, rank, "rget + compute");
+    }
+
+    /* requests freed while in flight, the gets are completed by the flush */
+    for (int i = 0 ; i < iterations ; ++i) {
+        memset (buffer, ~peer, length);
+        for (int j = 0 ; j < count ; ++j) {
+            MPI_Rget (buffer + j * size, size, MPI_BYTE, peer, j * size, size, MPI_BYTE, win, reqs + j);
+            if (j & 1) {
+                MPI_Request_free (reqs + j);
+            }
+        }
+        MPI_Win_flush (peer, win);
+        for (int j = 0 ; j < count ; j += 2) {
+            MPI_Wait (reqs + j, MPI_STATUS_IGNORE);
+        }
+        errors += check (buffer, length, peer, rank, "rget + request_free + flush");
+    }
+
+    MPI_Win_unlock_all (win);
+    MPI_Allreduce (&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+    if (0 == rank) {
+        double overlap = (2.0 * t_all - t_overlap) / t_all;
+
+        if (overlap < 0.0) {
+            overlap = 0.0;
+        }
+
+        printf ("%d gets of %d bytes, %d iterations\n", count, size, iterations);
+        printf ("get + flush_all:       %10.2f us\n", 1e6 * t_flush / iterations);
+        printf ("rget, first request:   %10.2f us\n", 1e6 * t_first / iterations);
+        printf ("rget, all requests:    %10.2f us\n", 1e6 * t_all / iterations);
+        printf ("rget + compute:        %10.2f us\n", 1e6 * t_overlap / iterations);
+        printf ("overlap:               %10.2f\n", overlap);
+        printf ("%s: %d errors\n", 0 == total ? "passed" : "FAILED", total);
+    }
+
+    MPI_Win_free (&win);
+    free (buffer);
+    free (reqs);
+
+    MPI_Finalize ();
+
+    return 0 == total ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/*
+ * Check many small gets and accumulates issued in a single passive target
+ * epoch. With the pt2pt component, contiguous gets and accumulates of
+ * predefined types up to osc_pt2pt_aggregate_max_size bytes share one reply
+ * (gets) or one acquisition of the accumulate lock (accumulates).
+ *
+ * Every rank owns a window of count ints. In one epoch each rank:
+ *
+ *   - gets every element of its right neighbour with a separate MPI_Get,
+ *   - adds its rank + 1 to every element of every window with separate
+ *     MPI_Accumulate calls, alternating single elements and pairs.
+ *
+ * After a flush the same elements are read again to check the accumulates.
+ *
+ * Usage: mpirun -n <nprocs> --mca osc pt2pt ./rma_small_ops [count]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+static int initial (int rank, int i)
+{
+    return rank * 100000 + i;
+}
+
+int main (int argc, char *argv[])
+{
+    int count = 1000, rank, nprocs, right, errors = 0, total, sum = 0;
+    int *base, *values, *ones;
+    MPI_Win win;
+
+    MPI_Init (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+    if (1 < argc) {
+        count = atoi (argv[1]);
+    }
+
+    if (count < 2) {
+        if (0 == rank) {
+            fprintf (stderr, "usage: mpirun -n <nprocs> %s [count]\n", argv[0]);
+        }
+        MPI_Finalize ();
+        return 1;
+    }
+
+    right = (rank + 1) % nprocs;
+    for (int i = 0 ; i < nprocs ; ++i) {
+        sum += i + 1;
+    }
+
+    values = (int *) malloc (count * sizeof (int));
+    ones = (int *) malloc (2 * sizeof (int));
+    ones[0] = ones[1] = rank + 1;
+
+    MPI_Win_allocate ((MPI_Aint) count * sizeof (int), sizeof (int), MPI_INFO_NULL, MPI_COMM_WORLD,
+                      &base, &win);
+    MPI_Win_lock (MPI_LOCK_EXCLUSIVE, rank, 0, win);
+    for (int i = 0 ; i < count ; ++i) {
+        base[i] = initial (rank, i);
+    }
+    MPI_Win_unlock (rank, win);
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    /* the first gets complete before any accumulate is issued */
+    MPI_Win_lock_all (0, win);
+    for (int i = 0 ; i < count ; ++i) {
+        MPI_Get (values + i, 1, MPI_INT, right, i, 1, MPI_INT, win);
+    }
+    MPI_Win_flush_all (win);
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    for (int i = 0 ; i < count ; ++i) {
+        if (values[i] != initial (right, i)) {
+            if (errors++ < 10) {
+                fprintf (stderr, "%d: get of element %d from %d returned %d, expected %d\n", rank,
+                         i, right, values[i], initial (right, i));
+            }
+        }
+    }
+
+    for (int target = 0 ; target < nprocs ; ++target) {
+        for (int i = 0 ; i < count ; ) {
+            int n = (i % 3 == 1 && i + 1 < count) ? 2 : 1;
+
+            MPI_Accumulate (ones, n, MPI_INT, target, i, n, MPI_INT, MPI_SUM, win);
+            i += n;
+        }
+    }
+    MPI_Win_flush_all (win);
+    MPI_Barrier (MPI_COMM_WORLD);
+
+    for (int i = 0 ; i < count ; ++i) {
+        MPI_Get (values + i, 1, MPI_INT, right, i, 1, MPI_INT, win);
+    }
+    MPI_Win_unlock_all (win);
+
+    for (int i = 0 ; i < count ; ++i) {
+        if (values[i] != initial (right, i) + sum) {
+            if (errors++ < 10) {
+                fprintf (stderr, "%d: element %d of %d is %d after the accumulates, expected %d\n",
+                         rank, i, right, values[i], initial (right, i) + sum);
+            }
+        }
+    }
+
+    MPI_Allreduce (&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf ("%s: %d elements on %d ranks, %d errors\n", 0 == total ? "passed" : "FAILED",
+                count, nprocs, total);
+    }
+
+    MPI_Win_free (&win);
+    free (ones);
+    free (values);
+
+    MPI_Finalize ();
+
+    return 0 == total ? 0 : 1;
+}
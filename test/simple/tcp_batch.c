@@ -0,0 +1,132 @@
+/*
+ * Check the batched and zero-copy send paths of the TCP BTL.
+ *
+ * Rank 0 posts a burst of small messages without waiting for them, so that
+ * the fragments queue up on the connection and are written with a single
+ * writev, then sends large messages above the zero-copy threshold and
+ * overwrites each send buffer as soon as the send completed. Rank 1 checks
+ * the content of every message. Over loopback the kernel copies the
+ * zero-copy sends, which exercises the fallback path; on a real network
+ * the send requests only complete once the kernel released the buffers.
+ *
+ * Usage: mpirun -n 2 --mca btl tcp,self --mca btl_tcp_send_batch 16 \
+ *            --mca btl_tcp_zerocopy_threshold 4096 ./tcp_batch [count]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mpi.h"
+
+#define SMALL_MAX  256
+#define LARGE_SIZE (1 << 20)
+#define LARGE_COUNT 16
+
+static unsigned char pattern (int msg, int i)
+{
+    return (unsigned char) (msg * 31 + i * 7 + 1);
+}
+
+static int check (const unsigned char *buffer, int length, int msg)
+{
+    for (int i = 0 ; i < length ; ++i) {
+        if (pattern (msg, i) != buffer[i]) {
+            fprintf (stderr, "message %d: byte %d is 0x%02x, expected 0x%02x\n", msg, i,
+                     buffer[i], pattern (msg, i));
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main (int argc, char *argv[])
+{
+    int count = 8192, rank, nprocs, errors = 0, total;
+    unsigned char *small, *large;
+    MPI_Request *reqs;
+
+    MPI_Init (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+    if (1 < argc) {
+        count = atoi (argv[1]);
+    }
+
+    if (2 != nprocs || count < 1) {
+        if (0 == rank) {
+            fprintf (stderr, "usage: mpirun -n 2 %s [count]\n", argv[0]);
+        }
+        MPI_Finalize ();
+        return 1;
+    }
+
+    small = (unsigned char *) malloc ((size_t) count * SMALL_MAX);
+    large = (unsigned char *) malloc (LARGE_SIZE);
+    reqs = (MPI_Request *) malloc (count * sizeof (reqs[0]));
+
+    /* burst of small messages of varying length */
+    if (0 == rank) {
+        for (int msg = 0 ; msg < count ; ++msg) {
+            unsigned char *buffer = small + (size_t) msg * SMALL_MAX;
+            int length = 1 + msg % SMALL_MAX;
+
+            for (int i = 0 ; i < length ; ++i) {
+                buffer[i] = pattern (msg, i);
+            }
+            MPI_Isend (buffer, length, MPI_BYTE, 1, msg, MPI_COMM_WORLD, reqs + msg);
+        }
+        MPI_Waitall (count, reqs, MPI_STATUSES_IGNORE);
+    } else {
+        /* let the socket buffers fill up so the sender queues its fragments */
+        sleep (1);
+        for (int msg = 0 ; msg < count ; ++msg) {
+            MPI_Status status;
+            int length;
+
+            MPI_Recv (small, SMALL_MAX, MPI_BYTE, 0, msg, MPI_COMM_WORLD, &status);
+            MPI_Get_count (&status, MPI_BYTE, &length);
+            if (length != 1 + msg % SMALL_MAX) {
+                fprintf (stderr, "message %d: got %d bytes, expected %d\n", msg, length,
+                         1 + msg % SMALL_MAX);
+                ++errors;
+                continue;
+            }
+            errors += check (small, length, msg);
+        }
+    }
+
+    /* large messages, the send buffer is reused as soon as the send completed */
+    for (int msg = 0 ; msg < LARGE_COUNT ; ++msg) {
+        int length = LARGE_SIZE >> (msg % 4);
+
+        if (0 == rank) {
+            for (int i = 0 ; i < length ; ++i) {
+                large[i] = pattern (msg, i);
+            }
+            MPI_Send (large, length, MPI_BYTE, 1, count + msg, MPI_COMM_WORLD);
+            memset (large, 0xff, length);
+        } else {
+            memset (large, 0, length);
+            MPI_Recv (large, length, MPI_BYTE, 0, count + msg, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            errors += check (large, length, msg);
+        }
+    }
+
+    MPI_Allreduce (&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf ("%s: %d small and %d large messages, %d errors\n", 0 == total ? "passed" : "FAILED",
+                count, LARGE_COUNT, total);
+    }
+
+    free (reqs);
+    free (large);
+    free (small);
+
+    MPI_Finalize ();
+
+    return 0 == total ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+/*
+ * Check the TCP BTL with several progress threads, each one owning a share
+ * of the connections.
+ *
+ * Every round each rank exchanges one message with every other rank, all
+ * of them posted at once so the connections to different peers (and the
+ * different links to the same peer) are progressed concurrently by
+ * different threads. The message size changes every round, from a few
+ * bytes up to sizes using the rendezvous protocol, and every message
+ * carries a pattern depending on its source, destination and round.
+ *
+ * Usage: mpirun -n 4 --mca btl tcp,self --mca btl_tcp_progress_thread 3 \
+ *            --mca btl_tcp_links 2 ./tcp_threads [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+#define MAX_SIZE (1 << 18)
+
+static unsigned char pattern (int src, int dst, int round, int i)
+{
+    return (unsigned char) (src * 13 + dst * 7 + round * 3 + i);
+}
+
+int main (int argc, char *argv[])
+{
+    int rounds = 64, rank, nprocs, errors = 0, total;
+    unsigned char *send_buffer, *recv_buffer;
+    MPI_Request *reqs;
+
+    MPI_Init (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+    if (1 < argc) {
+        rounds = atoi (argv[1]);
+    }
+
+    if (nprocs < 2 || rounds < 1) {
+        if (0 == rank) {
+            fprintf (stderr, "usage: mpirun -n <nprocs> %s [rounds]\n", argv[0]);
+        }
+        MPI_Finalize ();
+        return 1;
+    }
+
+    send_buffer = (unsigned char *) malloc ((size_t) nprocs * MAX_SIZE);
+    recv_buffer = (unsigned char *) malloc ((size_t) nprocs * MAX_SIZE);
+    reqs = (MPI_Request *) malloc (2 * nprocs * sizeof (reqs[0]));
+
+    for (int round = 0 ; round < rounds ; ++round) {
+        /* 1 byte up to MAX_SIZE bytes */
+        int size = 1 << (round % 19);
+        int nreqs = 0;
+
+        for (int peer = 0 ; peer < nprocs ; ++peer) {
+            unsigned char *buffer = send_buffer + (size_t) peer * MAX_SIZE;
+
+            if (peer == rank) {
+                continue;
+            }
+            for (int i = 0 ; i < size ; ++i) {
+                buffer[i] = pattern (rank, peer, round, i);
+            }
+            MPI_Irecv (recv_buffer + (size_t) peer * MAX_SIZE, size, MPI_BYTE, peer, round,
+                       MPI_COMM_WORLD, reqs + nreqs++);
+            MPI_Isend (buffer, size, MPI_BYTE, peer, round, MPI_COMM_WORLD, reqs + nreqs++);
+        }
+        MPI_Waitall (nreqs, reqs, MPI_STATUSES_IGNORE);
+
+        for (int peer = 0 ; peer < nprocs ; ++peer) {
+            unsigned char *buffer = recv_buffer + (size_t) peer * MAX_SIZE;
+
+            if (peer == rank) {
+                continue;
+            }
+            for (int i = 0 ; i < size ; ++i) {
+                if (buffer[i] != pattern (peer, rank, round, i)) {
+                    if (errors++ < 10) {
+                        fprintf (stderr, "%d: round %d: message of %d bytes from %d differs at byte %d\n",
+                                 rank, round, size, peer, i);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    MPI_Allreduce (&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf ("%s: %d rounds on %d ranks, %d errors\n", 0 == total ? "passed" : "FAILED",
+                rounds, nprocs, total);
+    }
+
+    free (reqs);
+    free (recv_buffer);
+    free (send_buffer);
+
+    MPI_Finalize ();
+
+    return 0 == total ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/*
+ * Check message ordering and content across the resizing and the
+ * reclamation of the vader fast boxes.
+ *
+ * Every round each rank streams messages to one peer and receives from
+ * another one, with the distance between them changing every round so the
+ * boxes of the previous partners become idle. Within a round the message
+ * size grows from a few bytes to several kilobytes, so boxes sized for
+ * small messages see misses and get replaced by larger ones. Each message
+ * carries a sequence number per source, which must arrive in order.
+ *
+ * Running with a small fast box arena forces idle boxes to be retired:
+ *
+ * Usage: mpirun -n 8 --mca btl vader,self --mca btl_vader_fbox_max 4 \
+ *            --mca btl_vader_fbox_threshold 8 ./vader_fbox [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+#define MAX_INTS 2048
+#define MESSAGES 256
+
+static int expected (int src, int seq, int i)
+{
+    return src * 7919 + seq * 31 + i;
+}
+
+int main (int argc, char *argv[])
+{
+    int rounds = 32, rank, nprocs, errors = 0, total;
+    int *send_buffer, *recv_buffer, *next_seq, *sent_seq;
+    MPI_Request *reqs;
+
+    MPI_Init (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+    if (1 < argc) {
+        rounds = atoi (argv[1]);
+    }
+
+    if (nprocs < 2 || rounds < 1) {
+        if (0 == rank) {
+            fprintf (stderr, "usage: mpirun -n <nprocs> %s [rounds]\n", argv[0]);
+        }
+        MPI_Finalize ();
+        return 1;
+    }
+
+    send_buffer = (int *) malloc ((size_t) MESSAGES * MAX_INTS * sizeof (int));
+    recv_buffer = (int *) malloc (MAX_INTS * sizeof (int));
+    reqs = (MPI_Request *) malloc (MESSAGES * sizeof (reqs[0]));
+    next_seq = (int *) calloc (nprocs, sizeof (int));
+    sent_seq = (int *) calloc (nprocs, sizeof (int));
+
+    for (int round = 0 ; round < rounds ; ++round) {
+        int distance = 1 + round % (nprocs - 1);
+        int to = (rank + distance) % nprocs;
+        int from = (rank + nprocs - distance) % nprocs;
+
+        for (int msg = 0 ; msg < MESSAGES ; ++msg) {
+            int *buffer = send_buffer + (size_t) msg * MAX_INTS;
+            /* 2 ints up to MAX_INTS ints */
+            int n = 2 + (msg * (MAX_INTS - 2)) / (MESSAGES - 1);
+            int seq = sent_seq[to]++;
+
+            buffer[0] = seq;
+            buffer[1] = n;
+            for (int i = 2 ; i < n ; ++i) {
+                buffer[i] = expected (rank, seq, i);
+            }
+            MPI_Isend (buffer, n, MPI_INT, to, 0, MPI_COMM_WORLD, reqs + msg);
+        }
+
+        for (int msg = 0 ; msg < MESSAGES ; ++msg) {
+            int seq = next_seq[from]++, n, count;
+            MPI_Status status;
+
+            MPI_Recv (recv_buffer, MAX_INTS, MPI_INT, from, 0, MPI_COMM_WORLD, &status);
+            MPI_Get_count (&status, MPI_INT, &count);
+            n = recv_buffer[1];
+
+            if (recv_buffer[0] != seq || n != count) {
+                if (errors++ < 10) {
+                    fprintf (stderr, "%d: round %d: message from %d has sequence %d and %d of %d ints, "
+                             "expected sequence %d\n", rank, round, from, recv_buffer[0], count, n, seq);
+                }
+                continue;
+            }
+
+            for (int i = 2 ; i < n ; ++i) {
+                if (recv_buffer[i] != expected (from, seq, i)) {
+                    if (errors++ < 10) {
+                        fprintf (stderr, "%d: round %d: message %d from %d differs at int %d\n", rank,
+                                 round, seq, from, i);
+                    }
+                    break;
+                }
+            }
+        }
+
+        MPI_Waitall (MESSAGES, reqs, MPI_STATUSES_IGNORE);
+    }
+
+    MPI_Allreduce (&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf ("%s: %d rounds of %d messages on %d ranks, %d errors\n", 0 == total ? "passed" : "FAILED",
+                rounds, MESSAGES, nprocs, total);
+    }
+
+    free (sent_seq);
+    free (next_seq);
+    free (reqs);
+    free (recv_buffer);
+    free (send_buffer);
+
+    MPI_Finalize ();
+
+    return 0 == total ? 0 : 1;
+}
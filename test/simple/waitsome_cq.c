@@ -0,0 +1,170 @@
+/*
+ * Check MPI_Waitsome and MPI_Testsome on a large request array whose
+ * requests complete from another thread, as tracked by the request
+ * completion queues (see mpi_request_cq_min_count).
+ *
+ * Every rank keeps one receive posted per slot of an array of count
+ * requests. A helper thread sends rounds messages to every slot, in a
+ * different order for each round. The main thread alternates MPI_Waitsome
+ * and MPI_Testsome, checks each message and posts the next receive in the
+ * slot that completed, as an event loop would. Some slots start as
+ * MPI_REQUEST_NULL and are filled later, and some completions are picked
+ * up with MPI_Test on a single slot, so the array changes behind the back
+ * of the completion queue.
+ *
+ * Usage: mpirun -n 1 ./waitsome_cq [count] [rounds]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+static int count = 4096, rounds = 8;
+static MPI_Comm comm;
+
+static void *sender (void *arg)
+{
+    int *order = (int *) malloc (count * sizeof (int));
+
+    (void) arg;
+
+    for (int round = 0 ; round < rounds ; ++round) {
+        for (int i = 0 ; i < count ; ++i) {
+            order[i] = i;
+        }
+        /* shuffle, so completions are spread over the whole array */
+        for (int i = count - 1 ; i > 0 ; --i) {
+            int j = rand () % (i + 1), tmp = order[i];
+
+            order[i] = order[j];
+            order[j] = tmp;
+        }
+        for (int i = 0 ; i < count ; ++i) {
+            int value = round * count + order[i];
+
+            MPI_Send (&value, 1, MPI_INT, 0, order[i], comm);
+        }
+    }
+
+    free (order);
+
+    return NULL;
+}
+
+int main (int argc, char *argv[])
+{
+    int provided, errors = 0, done = 0, iteration = 0, outcount;
+    int *values, *received, *indices;
+    MPI_Request *reqs;
+    pthread_t thread;
+
+    MPI_Init_thread (&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    if (MPI_THREAD_MULTIPLE != provided) {
+        fprintf (stderr, "MPI_THREAD_MULTIPLE is not supported\n");
+        MPI_Finalize ();
+        return 77;
+    }
+
+    if (1 < argc) {
+        count = atoi (argv[1]);
+    }
+    if (2 < argc) {
+        rounds = atoi (argv[2]);
+    }
+
+    if (count < 8 || rounds < 1) {
+        fprintf (stderr, "usage: %s [count] [rounds]\n", argv[0]);
+        MPI_Finalize ();
+        return 1;
+    }
+
+    MPI_Comm_dup (MPI_COMM_SELF, &comm);
+
+    values = (int *) malloc (count * sizeof (int));
+    received = (int *) calloc (count, sizeof (int));
+    indices = (int *) malloc (count * sizeof (int));
+    reqs = (MPI_Request *) malloc (count * sizeof (reqs[0]));
+
+    for (int i = 0 ; i < count ; ++i) {
+        reqs[i] = MPI_REQUEST_NULL;
+        if (0 != i % 7) {
+            MPI_Irecv (values + i, 1, MPI_INT, 0, i, comm, reqs + i);
+        }
+    }
+
+    pthread_create (&thread, NULL, sender, NULL);
+
+    while (done < count * rounds) {
+        if (1 == iteration) {
+            /* fill the slots that were empty so far */
+            for (int i = 0 ; i < count ; i += 7) {
+                MPI_Irecv (values + i, 1, MPI_INT, 0, i, comm, reqs + i);
+            }
+        }
+
+        if (iteration & 1) {
+            MPI_Testsome (count, reqs, &outcount, indices, MPI_STATUSES_IGNORE);
+        } else {
+            MPI_Waitsome (count, reqs, &outcount, indices, MPI_STATUSES_IGNORE);
+        }
+
+        if (MPI_UNDEFINED == outcount) {
+            fprintf (stderr, "no active request left after %d of %d messages\n", done, count * rounds);
+            ++errors;
+            break;
+        }
+
+        if (0 == iteration % 16) {
+            /* complete one slot without the completion queue */
+            int slot = (iteration / 16) % count, flag;
+
+            if (MPI_REQUEST_NULL != reqs[slot]) {
+                MPI_Test (reqs + slot, &flag, MPI_STATUS_IGNORE);
+                if (flag) {
+                    indices[outcount++] = slot;
+                }
+            }
+        }
+
+        for (int k = 0 ; k < outcount ; ++k) {
+            int slot = indices[k];
+
+            if (values[slot] != received[slot] * count + slot) {
+                if (errors++ < 10) {
+                    fprintf (stderr, "slot %d: got %d, expected %d\n", slot, values[slot],
+                             received[slot] * count + slot);
+                }
+            }
+            ++done;
+            if (++received[slot] < rounds) {
+                MPI_Irecv (values + slot, 1, MPI_INT, 0, slot, comm, reqs + slot);
+            }
+        }
+        ++iteration;
+    }
+
+    pthread_join (thread, NULL);
+
+    for (int i = 0 ; i < count ; ++i) {
+        if (MPI_REQUEST_NULL != reqs[i] || rounds != received[i]) {
+            if (errors++ < 10) {
+                fprintf (stderr, "slot %d: received %d messages out of %d\n", i, received[i], rounds);
+            }
+        }
+    }
+
+    printf ("%s: %d messages over %d requests in %d calls, %d errors\n", 0 == errors ? "passed" : "FAILED",
+            done, count, iteration, errors);
+
+    free (reqs);
+    free (indices);
+    free (received);
+    free (values);
+    MPI_Comm_free (&comm);
+
+    MPI_Finalize ();
+
+    return 0 == errors ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Ping-pong between two threads through ompi_wait_sync_t objects. One
+ * thread ends up progressing while the other spins or sleeps, so the
+ * reported wall time per round trip measures the wakeup latency and the
+ * CPU time shows how much processor time the blocked thread burns. Run
+ * it with different values of opal_wait_sync_spin_max and
+ * opal_wait_sync_yield_count to compare the policies.
+ */
+
+#include "opal_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "support.h"
+#include "opal/runtime/opal.h"
+#include "opal/constants.h"
+#include "opal/threads/threads.h"
+#include "opal/threads/wait_sync.h"
+#include "opal/sys/atomic.h"
+
+#define TEST_COUNT 10000
+
+static ompi_wait_sync_t ping[TEST_COUNT];
+static ompi_wait_sync_t pong[TEST_COUNT];
+
+static volatile int thr_count = 0;
+
+static void* thr_run(opal_object_t* obj)
+{
+    int i;
+
+    for (i = 0; i < TEST_COUNT; i++) {
+        SYNC_WAIT(&ping[i]);
+        WAIT_SYNC_RELEASE(&ping[i]);
+        thr_count++;
+        wait_sync_update(&pong[i], 1, OPAL_SUCCESS);
+    }
+    return NULL;
+}
+
+static double wtime(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec * 1e6 + (double)tv.tv_usec;
+}
+
+int main(int argc, char** argv)
+{
+    int rc, i, errors = 0;
+    opal_thread_t thr;
+    double t1, t2;
+    clock_t c1, c2;
+
+    test_init("ompi_wait_sync_t");
+
+    rc = opal_init(&argc, &argv);
+    test_verify_int(OPAL_SUCCESS, rc);
+    if (OPAL_SUCCESS != rc) {
+        test_finalize();
+        exit(1);
+    }
+    opal_set_using_threads(true);
+
+    for (i = 0; i < TEST_COUNT; i++) {
+        WAIT_SYNC_INIT(&ping[i], 1);
+        WAIT_SYNC_INIT(&pong[i], 1);
+    }
+
+    OBJ_CONSTRUCT(&thr, opal_thread_t);
+    thr.t_run = thr_run;
+
+    t1 = wtime();
+    c1 = clock();
+
+    rc = opal_thread_start(&thr);
+    test_verify_int(OPAL_SUCCESS, rc);
+
+    for (i = 0; i < TEST_COUNT; i++) {
+        wait_sync_update(&ping[i], 1, OPAL_SUCCESS);
+        if (OPAL_SUCCESS != SYNC_WAIT(&pong[i])) {
+            errors++;
+        }
+        WAIT_SYNC_RELEASE(&pong[i]);
+    }
+
+    rc = opal_thread_join(&thr, NULL);
+    test_verify_int(OPAL_SUCCESS, rc);
+
+    c2 = clock();
+    t2 = wtime();
+
+    test_verify_int(0, errors);
+    test_verify_int(TEST_COUNT, thr_count);
+
+    fprintf(stderr, "wait_sync ping-pong: %.3f usec per round trip, %.3f usec of CPU time per round trip\n",
+            (t2 - t1) / TEST_COUNT,
+            ((double)(c2 - c1) * 1e6 / CLOCKS_PER_SEC) / TEST_COUNT);
+
+    OBJ_DESTRUCT(&thr);
+    opal_finalize();
+
+    return test_finalize();
+}
@@ -0,0 +1,145 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Check the copies of the memcpy framework for a range of sizes and
+ * alignments, then report the bandwidth of opal_memcpy and of the batched
+ * opal_memcpy_tov against the C library memcpy. Copies above the
+ * non-temporal threshold (memcpy_x86_nt_threshold) do not go through the
+ * cache, run with different thresholds and instruction sets to compare.
+ */
+
+#include "opal_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+
+#include "support.h"
+#include "opal/runtime/opal.h"
+#include "opal/constants.h"
+#include "opal/mca/memcpy/base/base.h"
+
+#define MAX_SIZE   (64 * 1024 * 1024)
+#define NUM_PIECES 64
+
+static double wtime(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec * 1e6 + (double)tv.tv_usec;
+}
+
+static int check_copies(unsigned char *src, unsigned char *dst)
+{
+    struct iovec iov[NUM_PIECES];
+    size_t length, offset;
+    int errors = 0;
+
+    for (length = 1; length <= 4 * 1024 * 1024; length = length * 3 + 1) {
+        for (int align = 0; align < 64; align += 7) {
+            memset(dst, 0, length + 2 * align + 1);
+            opal_memcpy(dst + align, src + 64 - align, length);
+            if (memcmp(dst + align, src + 64 - align, length) || 0 != dst[align + length]) {
+                errors++;
+            }
+        }
+
+        /* scatter the data in pieces of different sizes with gaps between them */
+        offset = 0;
+        for (int i = 0; i < NUM_PIECES; i++) {
+            iov[i].iov_base = dst + offset + i;
+            iov[i].iov_len = (length / NUM_PIECES) + (i & 1);
+            offset += iov[i].iov_len;
+        }
+        memset(dst, 0, length + 2 * NUM_PIECES);
+        opal_memcpy_tov(iov, src, NUM_PIECES);
+        opal_memcpy_fromv(dst + MAX_SIZE / 2, iov, NUM_PIECES);
+        offset = 0;
+        for (int i = 0; i < NUM_PIECES; i++) {
+            offset += iov[i].iov_len;
+        }
+        if (memcmp(dst + MAX_SIZE / 2, src, offset)) {
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+static double bandwidth(unsigned char *src, unsigned char *dst, size_t length, int which)
+{
+    struct iovec iov[NUM_PIECES];
+    int iters = (int)(((size_t)1 << 30) / length);
+    double t1, t2;
+
+    if (iters < 4) {
+        iters = 4;
+    }
+
+    for (int i = 0; i < NUM_PIECES; i++) {
+        iov[i].iov_base = dst + i * (length / NUM_PIECES);
+        iov[i].iov_len = length / NUM_PIECES;
+    }
+
+    t1 = wtime();
+    for (int i = 0; i < iters; i++) {
+        switch (which) {
+        case 0:
+            memcpy(dst, src, length);
+            break;
+        case 1:
+            opal_memcpy(dst, src, length);
+            break;
+        default:
+            opal_memcpy_tov(iov, src, NUM_PIECES);
+        }
+    }
+    t2 = wtime();
+
+    return ((double)length * iters) / ((t2 - t1) * 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned char *src, *dst;
+    int rc;
+
+    test_init("opal_memcpy");
+
+    rc = opal_init(&argc, &argv);
+    test_verify_int(OPAL_SUCCESS, rc);
+    if (OPAL_SUCCESS != rc) {
+        test_finalize();
+        exit(1);
+    }
+
+    src = (unsigned char *)malloc(MAX_SIZE + 128);
+    dst = (unsigned char *)malloc(MAX_SIZE + 128);
+    for (size_t i = 0; i < MAX_SIZE + 128; i++) {
+        src[i] = (unsigned char)(i * 7 + 13);
+    }
+
+    test_verify_int(0, check_copies(src, dst));
+
+    fprintf(stderr, "%12s %14s %14s %14s\n", "bytes", "memcpy GB/s", "opal GB/s", "opal_tov GB/s");
+    for (size_t length = 4096; length <= MAX_SIZE; length *= 4) {
+        fprintf(stderr, "%12lu %14.2f %14.2f %14.2f\n", (unsigned long)length,
+                bandwidth(src, dst, length, 0), bandwidth(src, dst, length, 1),
+                bandwidth(src, dst, length, 2));
+    }
+
+    free(src);
+    free(dst);
+    opal_finalize();
+
+    return test_finalize();
+}